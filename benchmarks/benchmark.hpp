@@ -0,0 +1,55 @@
+/** @file
+shared helpers for the benchmark programs
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+#pragma once
+
+#include <xtd/xtd.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace benchmark{
+
+  /// wall clock time in seconds spent invoking fn
+  template <typename _FnT>
+  double time_it(_FnT&& fn){
+    auto oStart = std::chrono::steady_clock::now();
+    fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - oStart).count();
+  }
+
+  /// runs fn(thread_index) on iThreads threads concurrently and returns the elapsed wall clock seconds
+  template <typename _FnT>
+  double time_threads(size_t iThreads, _FnT&& fn){
+    std::vector<std::thread> oThreads;
+    oThreads.reserve(iThreads);
+    return time_it([&](){
+      for (size_t i = 0; i < iThreads; ++i){
+        oThreads.emplace_back(fn, i);
+      }
+      for (auto & oThread : oThreads){
+        oThread.join();
+      }
+    });
+  }
+
+  /// prints a single result line as: name, operations, seconds, operations per second
+  inline void report(const std::string& sName, size_t iOperations, double dSeconds){
+    std::cout << std::left << std::setw(48) << sName << std::right
+      << std::setw(12) << iOperations << " ops "
+      << std::setw(10) << std::fixed << std::setprecision(3) << (dSeconds * 1000.0) << " ms "
+      << std::setw(14) << std::setprecision(0) << (dSeconds > 0 ? iOperations / dSeconds : 0.0) << " ops/s" << std::endl;
+  }
+
+  /// reads a size argument from the command line falling back to a default
+  inline size_t arg(int argc, char * argv[], int index, size_t iDefault){
+    return (argc > index ? static_cast<size_t>(std::strtoull(argv[index], nullptr, 10)) : iDefault);
+  }
+
+}
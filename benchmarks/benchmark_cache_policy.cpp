@@ -0,0 +1,105 @@
+/** @file
+replays key traces through lru_cache with each eviction policy and reports the hit ratio and throughput
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+usage: benchmark_cache_policy [trace file]
+
+A trace file holds one integer key per line. Without one, synthetic traces are replayed: power law point lookups,
+the same lookups interleaved with a sequential scan the way btree range queries hit the page cache, and a loop
+slightly larger than the cache.
+*/
+
+#include "benchmark.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include <xtd/lru_cache.hpp>
+
+namespace{
+  const size_t cache_capacity = 1000;
+
+  struct counting_loader{
+    size_t * _misses;
+    uint64_t operator()(const uint64_t& key){
+      ++*_misses;
+      return key;
+    }
+  };
+
+  std::vector<uint64_t> point_lookups(size_t iCount, uint64_t iSeed){
+    std::mt19937_64 oRandom(iSeed);
+    std::uniform_real_distribution<double> oUniform(0, 1);
+    std::vector<uint64_t> oRet(iCount);
+    for (auto & key : oRet){
+      key = static_cast<uint64_t>(std::pow(oUniform(oRandom), 3) * cache_capacity * 8);
+    }
+    return oRet;
+  }
+
+  std::vector<uint64_t> scan_with_point_lookups(size_t iCount){
+    auto oPoints = point_lookups(iCount / 2, 2);
+    std::vector<uint64_t> oRet;
+    oRet.reserve(iCount);
+    for (size_t i = 0; i < oPoints.size(); ++i){
+      oRet.push_back(oPoints[i]);
+      oRet.push_back(1000000 + i);
+    }
+    return oRet;
+  }
+
+  std::vector<uint64_t> loop(size_t iCount){
+    std::vector<uint64_t> oRet(iCount);
+    for (size_t i = 0; i < iCount; ++i){
+      oRet[i] = i % (cache_capacity + cache_capacity / 2);
+    }
+    return oRet;
+  }
+
+  std::vector<uint64_t> read_trace(const char * sPath){
+    std::ifstream oFile(sPath);
+    std::vector<uint64_t> oRet;
+    for (uint64_t key; oFile >> key;){
+      oRet.push_back(key);
+    }
+    return oRet;
+  }
+
+  template <typename _PolicyT>
+  void replay(const std::string& sPolicy, const std::string& sTrace, const std::vector<uint64_t>& oTrace){
+    size_t iMisses = 0;
+    xtd::lru_cache<uint64_t, uint64_t, cache_capacity, counting_loader, std::hash<uint64_t>, _PolicyT> oCache(counting_loader{ &iMisses });
+    volatile uint64_t iSink = 0;
+    auto dSeconds = benchmark::time_it([&](){
+      for (auto key : oTrace){
+        iSink = oCache[key];
+      }
+    });
+    std::ostringstream sName;
+    sName << sTrace << " " << sPolicy << " hit ratio " << std::fixed << std::setprecision(3) << (1.0 - static_cast<double>(iMisses) / oTrace.size());
+    benchmark::report(sName.str(), oTrace.size(), dSeconds);
+  }
+
+  void replay_all(const std::string& sTrace, const std::vector<uint64_t>& oTrace){
+    replay<xtd::lru_policy>("lru", sTrace, oTrace);
+    replay<xtd::clock_policy>("clock", sTrace, oTrace);
+    replay<xtd::slru_policy>("slru", sTrace, oTrace);
+    replay<xtd::tinylfu_policy>("tinylfu", sTrace, oTrace);
+  }
+}
+
+int main(int argc, char * argv[]){
+  std::cout << cache_capacity << " entry cache" << std::endl;
+  if (argc > 1){
+    replay_all(argv[1], read_trace(argv[1]));
+    return 0;
+  }
+  const size_t iCount = 2000000;
+  replay_all("points", point_lookups(iCount, 1));
+  replay_all("scan+points", scan_with_point_lookups(iCount));
+  replay_all("loop", loop(iCount));
+  return 0;
+}
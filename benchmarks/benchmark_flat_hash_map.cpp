@@ -0,0 +1,85 @@
+/** @file
+compares xtd::concurrent::flat_hash_map with xtd::concurrent::hash_map and a mutex guarded std::unordered_map
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+usage: benchmark_flat_hash_map [keys] [threads]
+*/
+
+#include "benchmark.hpp"
+
+#include <mutex>
+#include <random>
+#include <unordered_map>
+
+#include <xtd/concurrent/flat_hash_map.hpp>
+#include <xtd/concurrent/hash_map.hpp>
+
+/// the common baseline: a standard container behind a single lock
+template <typename _KeyT, typename _ValueT>
+class locked_unordered_map{
+  std::unordered_map<_KeyT, _ValueT> _map;
+  std::mutex _lock;
+public:
+  bool insert(const _KeyT& Key, _ValueT&& Value){
+    std::lock_guard<std::mutex> oLock(_lock);
+    return _map.emplace(Key, std::move(Value)).second;
+  }
+  bool exists(const _KeyT& Key){
+    std::lock_guard<std::mutex> oLock(_lock);
+    return _map.end() != _map.find(Key);
+  }
+  bool remove(const _KeyT& Key){
+    std::lock_guard<std::mutex> oLock(_lock);
+    return 0 != _map.erase(Key);
+  }
+};
+
+template <typename _MapT>
+void run(const std::string& sName, const std::vector<uint64_t>& oKeys, size_t iThreads){
+  auto pMap = new _MapT;
+  auto iPerThread = oKeys.size() / iThreads;
+  benchmark::report(sName + " insert", iPerThread * iThreads, benchmark::time_threads(iThreads, [&](size_t iThread){
+    for (size_t i = iThread * iPerThread; i < (1 + iThread) * iPerThread; ++i){
+      pMap->insert(oKeys[i], uint64_t(i));
+    }
+  }));
+  benchmark::report(sName + " exists hit", iPerThread * iThreads, benchmark::time_threads(iThreads, [&](size_t iThread){
+    for (size_t i = iThread * iPerThread; i < (1 + iThread) * iPerThread; ++i){
+      if (!pMap->exists(oKeys[oKeys.size() - 1 - i])){
+        std::abort();
+      }
+    }
+  }));
+  benchmark::report(sName + " exists miss", iPerThread * iThreads, benchmark::time_threads(iThreads, [&](size_t iThread){
+    for (size_t i = iThread * iPerThread; i < (1 + iThread) * iPerThread; ++i){
+      if (pMap->exists(~oKeys[i])){
+        std::abort();
+      }
+    }
+  }));
+  benchmark::report(sName + " remove", iPerThread * iThreads, benchmark::time_threads(iThreads, [&](size_t iThread){
+    for (size_t i = iThread * iPerThread; i < (1 + iThread) * iPerThread; ++i){
+      pMap->remove(oKeys[i]);
+    }
+  }));
+  benchmark::report(sName + " destroy", oKeys.size(), benchmark::time_it([&](){ delete pMap; }));
+}
+
+int main(int argc, char * argv[]){
+  auto iKeys = benchmark::arg(argc, argv, 1, 1000000);
+  auto iThreads = benchmark::arg(argc, argv, 2, std::thread::hardware_concurrency());
+  if (!iThreads) iThreads = 1;
+
+  // keys with the top bit clear so their complements are guaranteed misses
+  std::vector<uint64_t> oKeys(iKeys);
+  std::mt19937_64 oEngine(0x5eed);
+  for (auto & Key : oKeys){
+    Key = oEngine() >> 1;
+  }
+
+  std::cout << iKeys << " keys on " << iThreads << " threads" << std::endl;
+  run<locked_unordered_map<uint64_t, uint64_t>>("unordered_map+mutex", oKeys, iThreads);
+  run<xtd::concurrent::hash_map<uint64_t, uint64_t>>("hash_map", oKeys, iThreads);
+  run<xtd::concurrent::flat_hash_map<uint64_t, uint64_t>>("flat_hash_map", oKeys, iThreads);
+  return 0;
+}
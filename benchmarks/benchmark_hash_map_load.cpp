@@ -0,0 +1,51 @@
+/** @file
+compares loading xtd::concurrent::hash_map one item at a time with insert_bulk and build_from
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+usage: benchmark_hash_map_load [keys] [threads]
+*/
+
+#include "benchmark.hpp"
+
+#include <random>
+
+#include <xtd/concurrent/hash_map.hpp>
+
+using map_type = xtd::concurrent::hash_map<uint64_t, uint64_t>;
+
+template <typename _LoadT>
+void run(const std::string& sName, size_t iKeys, _LoadT&& fnLoad){
+  auto pMap = new map_type;
+  benchmark::report(sName + " load", iKeys, benchmark::time_it([&](){ fnLoad(*pMap); }));
+  benchmark::report(sName + " destroy", iKeys, benchmark::time_it([&](){ delete pMap; }));
+}
+
+int main(int argc, char * argv[]){
+  auto iKeys = benchmark::arg(argc, argv, 1, 250000);
+  auto iThreads = benchmark::arg(argc, argv, 2, std::thread::hardware_concurrency());
+  if (!iThreads) iThreads = 1;
+
+  std::vector<std::pair<uint64_t, uint64_t>> oItems(iKeys);
+  std::mt19937_64 oEngine(0x5eed);
+  for (size_t i = 0; i < iKeys; ++i){
+    oItems[i] = std::make_pair(oEngine(), uint64_t(i));
+  }
+
+  std::cout << iKeys << " keys on " << iThreads << " threads" << std::endl;
+  run("insert", iKeys, [&](map_type& oMap){
+    for (auto & oItem : oItems){
+      oMap.insert(oItem.first, uint64_t(oItem.second));
+    }
+  });
+  run("threaded insert", iKeys, [&](map_type& oMap){
+    auto iPerThread = (iKeys + iThreads - 1) / iThreads;
+    benchmark::time_threads(iThreads, [&](size_t iThread){
+      for (size_t i = iThread * iPerThread; i < std::min(iKeys, (1 + iThread) * iPerThread); ++i){
+        oMap.insert(oItems[i].first, uint64_t(oItems[i].second));
+      }
+    });
+  });
+  run("insert_bulk", iKeys, [&](map_type& oMap){ oMap.insert_bulk(oItems.begin(), oItems.end()); });
+  run("build_from", iKeys, [&](map_type& oMap){ oMap.build_from(oItems, iThreads); });
+  return 0;
+}
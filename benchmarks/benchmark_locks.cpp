@@ -0,0 +1,65 @@
+/** @file
+measures the throughput and acquisition latency of the concurrent locks from 1 to 64 threads
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+usage: benchmark_locks [acquisitions per thread] [max threads]
+
+Each line reports the total throughput followed by percentiles of the time threads waited to acquire the lock. A lock
+that lets the same threads win repeatedly shows a long tail even when its throughput is high.
+*/
+
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+#include <xtd/concurrent/mcs_lock.hpp>
+#include <xtd/concurrent/spin_lock.hpp>
+#include <xtd/concurrent/ticket_lock.hpp>
+
+template <typename _LockT>
+void run(const std::string& sName, size_t iAcquisitions, size_t iMaxThreads){
+  for (size_t iThreads = 1; iThreads <= iMaxThreads; iThreads *= 2){
+    _LockT oLock;
+    size_t iShared = 0;
+    std::vector<std::vector<uint32_t>> oLatencies(iThreads);
+    auto dSeconds = benchmark::time_threads(iThreads, [&](size_t iThread){
+      auto & oMine = oLatencies[iThread];
+      oMine.reserve(iAcquisitions);
+      for (size_t i = 0; i < iAcquisitions; ++i){
+        auto oStart = std::chrono::steady_clock::now();
+        oLock.lock();
+        oMine.push_back(static_cast<uint32_t>(std::min<int64_t>(UINT32_MAX, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - oStart).count())));
+        // a short critical section that writes shared state
+        iShared += i;
+        oLock.unlock();
+      }
+    });
+    std::vector<uint32_t> oAll;
+    for (auto & oMine : oLatencies){
+      oAll.insert(oAll.end(), oMine.begin(), oMine.end());
+    }
+    std::sort(oAll.begin(), oAll.end());
+    auto percentile = [&](double d){ return oAll[std::min(oAll.size() - 1, static_cast<size_t>(d * oAll.size()))]; };
+    benchmark::report(sName + " " + std::to_string(iThreads) + " threads", iAcquisitions * iThreads, dSeconds);
+    std::cout << "    wait ns p50 " << percentile(0.5) << " p99 " << percentile(0.99) << " p99.9 " << percentile(0.999) << " max " << oAll.back() << std::endl;
+  }
+}
+
+int main(int argc, char * argv[]){
+  using namespace xtd::concurrent;
+  auto iAcquisitions = benchmark::arg(argc, argv, 1, 100000);
+  auto iMaxThreads = benchmark::arg(argc, argv, 2, 64);
+
+  std::cout << iAcquisitions << " acquisitions per thread" << std::endl;
+  run<std::mutex>("std::mutex", iAcquisitions, iMaxThreads);
+  run<spin_lock>("spin_lock", iAcquisitions, iMaxThreads);
+  run<spin_lock_base<adaptive_wait_policy>>("spin_lock adaptive", iAcquisitions, iMaxThreads);
+  run<ticket_lock>("ticket_lock", iAcquisitions, iMaxThreads);
+  run<ticket_lock_base<adaptive_wait_policy>>("ticket_lock adaptive", iAcquisitions, iMaxThreads);
+  run<mcs_lock>("mcs_lock", iAcquisitions, iMaxThreads);
+  run<mcs_lock_base<adaptive_wait_policy>>("mcs_lock adaptive", iAcquisitions, iMaxThreads);
+  return 0;
+}
@@ -0,0 +1,84 @@
+/** @file
+compares the sharded concurrent lru_cache with an xtd::lru_cache behind a mutex on a skewed read mostly workload from 1 thread up to the number of hardware threads
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+usage: benchmark_lru_cache [lookups per thread] [max threads]
+
+Keys are drawn from a power law over twice the capacity so most lookups hit and a miss loads and evicts.
+*/
+
+#include "benchmark.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <random>
+
+#include <xtd/lru_cache.hpp>
+#include <xtd/concurrent/lru_cache.hpp>
+
+namespace{
+  const size_t cache_capacity = 4096;
+
+  uint64_t load(const uint64_t& key){
+    return key * 3;
+  }
+
+  std::vector<uint64_t> skewed_keys(size_t iCount, size_t iSeed){
+    std::mt19937_64 oRandom(iSeed);
+    std::uniform_real_distribution<double> oUniform(0, 1);
+    std::vector<uint64_t> oRet(iCount);
+    for (auto & key : oRet){
+      key = static_cast<uint64_t>(std::pow(oUniform(oRandom), 3) * cache_capacity * 2);
+    }
+    return oRet;
+  }
+
+  class locked_cache{
+    std::mutex _lock;
+    xtd::lru_cache<uint64_t, uint64_t, cache_capacity> _cache{&load};
+  public:
+    uint64_t get(uint64_t key){
+      std::lock_guard<std::mutex> oLock(_lock);
+      return _cache[key];
+    }
+  };
+
+  class sharded_cache{
+    xtd::concurrent::lru_cache<uint64_t, uint64_t> _cache{cache_capacity};
+  public:
+    uint64_t get(uint64_t key){
+      return _cache.get_or_load(key, &load);
+    }
+  };
+
+  template <typename _CacheT>
+  void run(const std::string& sName, size_t iLookups, size_t iMaxThreads){
+    for (size_t iThreads = 1; iThreads <= iMaxThreads; iThreads *= 2){
+      _CacheT oCache;
+      std::vector<std::vector<uint64_t>> oKeys;
+      for (size_t i = 0; i < iThreads; ++i){
+        oKeys.push_back(skewed_keys(iLookups, i));
+      }
+      std::atomic<uint64_t> iSink(0);
+      auto dSeconds = benchmark::time_threads(iThreads, [&](size_t iThread){
+        uint64_t iSum = 0;
+        for (auto key : oKeys[iThread]){
+          iSum += oCache.get(key);
+        }
+        iSink += iSum;
+      });
+      benchmark::report(sName + " " + std::to_string(iThreads) + " threads", iLookups * iThreads, dSeconds);
+    }
+  }
+}
+
+int main(int argc, char * argv[]){
+  auto iLookups = benchmark::arg(argc, argv, 1, 2000000);
+  auto iMaxThreads = benchmark::arg(argc, argv, 2, std::max<size_t>(1, std::thread::hardware_concurrency()));
+
+  std::cout << iLookups << " lookups per thread" << std::endl;
+  run<locked_cache>("std::mutex + xtd::lru_cache", iLookups, iMaxThreads);
+  run<sharded_cache>("concurrent::lru_cache", iLookups, iMaxThreads);
+  return 0;
+}
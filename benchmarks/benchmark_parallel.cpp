@@ -0,0 +1,63 @@
+/** @file
+compares the parallel algorithms with their sequential standard library counterparts from 1 thread up to the number of hardware threads
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+usage: benchmark_parallel [items] [max threads]
+*/
+
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <random>
+
+#include <xtd/parallel.hpp>
+
+namespace{
+  std::vector<uint64_t> random_items(size_t iItems){
+    std::mt19937_64 oRandom(42);
+    std::vector<uint64_t> oRet(iItems);
+    for (auto & i : oRet){
+      i = oRandom();
+    }
+    return oRet;
+  }
+
+  double work(uint64_t i){
+    return std::sqrt(static_cast<double>(i));
+  }
+}
+
+int main(int argc, char * argv[]){
+  auto iItems = benchmark::arg(argc, argv, 1, 20000000);
+  auto iMaxThreads = benchmark::arg(argc, argv, 2, std::max<size_t>(1, std::thread::hardware_concurrency()));
+
+  std::cout << iItems << " items" << std::endl;
+  auto oItems = random_items(iItems);
+  volatile double dSink = 0;
+
+  benchmark::report("std::sort", iItems, benchmark::time_it([&](){ std::sort(oItems.begin(), oItems.end()); }));
+  benchmark::report("std::transform_reduce", iItems, benchmark::time_it([&](){
+    dSink = std::transform_reduce(oItems.begin(), oItems.end(), 0.0, std::plus<double>(), work);
+  }));
+
+  for (size_t iThreads = 1; iThreads <= iMaxThreads; iThreads *= 2){
+    xtd::concurrent::thread_pool oPool(iThreads);
+    auto sThreads = " " + std::to_string(iThreads) + " threads";
+    oItems = random_items(iItems);
+    benchmark::report("parallel::sort" + sThreads, iItems, benchmark::time_it([&](){
+      xtd::parallel::sort(oItems.begin(), oItems.end(), std::less<uint64_t>(), 0, oPool);
+    }));
+    benchmark::report("parallel::transform_reduce" + sThreads, iItems, benchmark::time_it([&](){
+      dSink = xtd::parallel::transform_reduce(oItems.begin(), oItems.end(), 0.0, std::plus<double>(), work, 0, oPool);
+    }));
+    benchmark::report("parallel::for_each" + sThreads, iItems, benchmark::time_it([&](){
+      xtd::parallel::for_each(oItems.begin(), oItems.end(), [](uint64_t& i){ i ^= i >> 7; }, 0, oPool);
+    }));
+  }
+  (void)dSink;
+  return 0;
+}
@@ -0,0 +1,91 @@
+/** @file
+measures the hand-off throughput of concurrent::queue against a std::deque guarded by a std::mutex
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+usage: benchmark_queue [items per producer] [max producer/consumer pairs] [batch size]
+*/
+
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+
+#include <xtd/concurrent/queue.hpp>
+
+/// std::deque and std::mutex behind the interface of concurrent::queue
+class locked_deque{
+  std::deque<size_t> _items;
+  std::mutex _lock;
+public:
+  explicit locked_deque(size_t){}
+  void push(size_t iValue){
+    std::lock_guard<std::mutex> oLock(_lock);
+    _items.push_back(iValue);
+  }
+  bool try_pop(size_t& iRet){
+    std::lock_guard<std::mutex> oLock(_lock);
+    if (_items.empty()){
+      return false;
+    }
+    iRet = _items.front();
+    _items.pop_front();
+    return true;
+  }
+};
+
+template <typename _QueueT, typename _PushT, typename _PopT>
+void run(const std::string& sName, size_t iItems, size_t iMaxPairs, _PushT&& push, _PopT&& pop){
+  for (size_t iPairs = 1; iPairs <= iMaxPairs; iPairs *= 2){
+    _QueueT oQueue(4096);
+    // even threads produce and odd threads consume the same number of items
+    benchmark::report(sName + " " + std::to_string(iPairs) + " pairs", 2 * iItems * iPairs, benchmark::time_threads(2 * iPairs, [&](size_t iThread){
+      if (iThread % 2){
+        for (size_t iPopped = 0; iPopped < iItems;){
+          auto iCount = pop(oQueue);
+          if (!iCount){
+            std::this_thread::yield();
+          }
+          iPopped += iCount;
+        }
+      } else{
+        for (size_t iPushed = 0; iPushed < iItems;){
+          auto iCount = push(oQueue, iPushed, iItems - iPushed);
+          if (!iCount){
+            std::this_thread::yield();
+          }
+          iPushed += iCount;
+        }
+      }
+    }));
+  }
+}
+
+int main(int argc, char * argv[]){
+  auto iItems = benchmark::arg(argc, argv, 1, 1000000);
+  auto iMaxPairs = benchmark::arg(argc, argv, 2, 8);
+  auto iBatch = benchmark::arg(argc, argv, 3, 32);
+  using queue_type = xtd::concurrent::queue<size_t>;
+
+  std::cout << iItems << " items per producer" << std::endl;
+  run<locked_deque>("std::deque + std::mutex", iItems, iMaxPairs,
+    [](locked_deque& oQueue, size_t iValue, size_t){ oQueue.push(iValue); return size_t(1); },
+    [](locked_deque& oQueue){ size_t iValue; return size_t(oQueue.try_pop(iValue) ? 1 : 0); });
+  run<queue_type>("queue", iItems, iMaxPairs,
+    [](queue_type& oQueue, size_t iValue, size_t){ return size_t(oQueue.try_push(iValue) ? 1 : 0); },
+    [](queue_type& oQueue){ size_t iValue; return size_t(oQueue.try_pop(iValue) ? 1 : 0); });
+  run<queue_type>("queue push_n/pop_n " + std::to_string(iBatch), iItems, iMaxPairs,
+    [iBatch](queue_type& oQueue, size_t iValue, size_t iLeft){
+      size_t oBatch[256];
+      auto iCount = std::min<size_t>(std::min<size_t>(iBatch, 256), iLeft);
+      for (size_t i = 0; i < iCount; ++i){
+        oBatch[i] = iValue + i;
+      }
+      return oQueue.push_n(oBatch, iCount);
+    },
+    [iBatch](queue_type& oQueue){
+      size_t oBatch[256];
+      return oQueue.pop_n(oBatch, std::min<size_t>(iBatch, 256));
+    });
+  return 0;
+}
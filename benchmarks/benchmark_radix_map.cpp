@@ -0,0 +1,60 @@
+/** @file
+compares xtd::concurrent::radix_map with the nibble trie xtd::concurrent::hash_map on random and dense key sets
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+usage: benchmark_radix_map [keys] [threads]
+*/
+
+#include "benchmark.hpp"
+
+#include <random>
+
+#include <xtd/concurrent/hash_map.hpp>
+#include <xtd/concurrent/radix_map.hpp>
+
+template <typename _MapT>
+void run(const std::string& sName, const std::vector<uint64_t>& oKeys, size_t iThreads){
+  auto pMap = new _MapT;
+  auto iPerThread = oKeys.size() / iThreads;
+  benchmark::report(sName + " insert", iPerThread * iThreads, benchmark::time_threads(iThreads, [&](size_t iThread){
+    for (size_t i = iThread * iPerThread; i < (1 + iThread) * iPerThread; ++i){
+      pMap->insert(oKeys[i], uint64_t(i));
+    }
+  }));
+  benchmark::report(sName + " exists", iPerThread * iThreads, benchmark::time_threads(iThreads, [&](size_t iThread){
+    for (size_t i = iThread * iPerThread; i < (1 + iThread) * iPerThread; ++i){
+      if (!pMap->exists(oKeys[oKeys.size() - 1 - i])){
+        std::abort();
+      }
+    }
+  }));
+  benchmark::report(sName + " remove", iPerThread * iThreads, benchmark::time_threads(iThreads, [&](size_t iThread){
+    for (size_t i = iThread * iPerThread; i < (1 + iThread) * iPerThread; ++i){
+      pMap->remove(oKeys[i]);
+    }
+  }));
+  benchmark::report(sName + " destroy", oKeys.size(), benchmark::time_it([&](){ delete pMap; }));
+}
+
+int main(int argc, char * argv[]){
+  auto iKeys = benchmark::arg(argc, argv, 1, 1000000);
+  auto iThreads = benchmark::arg(argc, argv, 2, std::thread::hardware_concurrency());
+  if (!iThreads) iThreads = 1;
+
+  std::vector<uint64_t> oDense(iKeys);
+  for (size_t i = 0; i < iKeys; ++i){
+    oDense[i] = i;
+  }
+  std::vector<uint64_t> oRandom(iKeys);
+  std::mt19937_64 oEngine(0x5eed);
+  for (auto & Key : oRandom){
+    Key = oEngine();
+  }
+
+  std::cout << iKeys << " keys on " << iThreads << " threads" << std::endl;
+  run<xtd::concurrent::hash_map<uint64_t, uint64_t>>("hash_map dense", oDense, iThreads);
+  run<xtd::concurrent::radix_map<uint64_t, uint64_t>>("radix_map dense", oDense, iThreads);
+  run<xtd::concurrent::hash_map<uint64_t, uint64_t>>("hash_map random", oRandom, iThreads);
+  run<xtd::concurrent::radix_map<uint64_t, uint64_t>>("radix_map random", oRandom, iThreads);
+  return 0;
+}
@@ -0,0 +1,60 @@
+/** @file
+measures the hand-off throughput between one producer and one consumer thread
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+usage: benchmark_spsc_queue [items] [batch size]
+*/
+
+#include "benchmark.hpp"
+
+#include <memory>
+
+#include <xtd/concurrent/queue.hpp>
+#include <xtd/concurrent/spsc_queue.hpp>
+
+using spsc_type = xtd::concurrent::spsc_queue<size_t, 4096>;
+using mpmc_type = xtd::concurrent::queue<size_t>;
+
+template <typename _ProduceT, typename _ConsumeT>
+void run(const std::string& sName, size_t iItems, _ProduceT&& produce, _ConsumeT&& consume){
+  benchmark::report(sName, iItems, benchmark::time_threads(2, [&](size_t iThread){
+    for (size_t iDone = 0; iDone < iItems;){
+      auto iCount = (iThread ? consume() : produce(iDone, iItems - iDone));
+      if (!iCount){
+        std::this_thread::yield();
+      }
+      iDone += iCount;
+    }
+  }));
+}
+
+int main(int argc, char * argv[]){
+  auto iItems = benchmark::arg(argc, argv, 1, 20000000);
+  auto iBatch = benchmark::arg(argc, argv, 2, 32);
+
+  {
+    mpmc_type oQueue(4096);
+    run("queue", iItems,
+      [&](size_t iValue, size_t){ return size_t(oQueue.try_push(iValue) ? 1 : 0); },
+      [&](){ size_t iValue; return size_t(oQueue.try_pop(iValue) ? 1 : 0); });
+  }
+  {
+    std::unique_ptr<spsc_type> pQueue(new spsc_type);
+    run("spsc_queue", iItems,
+      [&](size_t iValue, size_t){ return size_t(pQueue->try_push(iValue) ? 1 : 0); },
+      [&](){ size_t iValue; return size_t(pQueue->try_pop(iValue) ? 1 : 0); });
+  }
+  {
+    std::unique_ptr<spsc_type> pQueue(new spsc_type);
+    size_t iSum = 0;
+    run("spsc_queue commit_batch/consume " + std::to_string(iBatch), iItems,
+      [&](size_t iValue, size_t iLeft){
+        size_t i = 0;
+        for (; i < iBatch && i < iLeft && pQueue->try_stage(iValue + i); ++i){}
+        pQueue->commit_batch();
+        return i;
+      },
+      [&](){ return pQueue->consume([&](size_t& iValue){ iSum += iValue; }, iBatch); });
+  }
+  return 0;
+}
@@ -0,0 +1,37 @@
+/** @file
+measures the push and pop throughput of the concurrent stacks from 1 to 64 threads
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+usage: benchmark_stack [operations per thread] [max threads]
+*/
+
+#include "benchmark.hpp"
+
+#include <xtd/concurrent/pooled_stack.hpp>
+#include <xtd/concurrent/stack.hpp>
+
+template <typename _StackT>
+void run(const std::string& sName, size_t iOperations, size_t iMaxThreads){
+  for (size_t iThreads = 1; iThreads <= iMaxThreads; iThreads *= 2){
+    _StackT oStack;
+    // each thread alternates pushes and pops so the stack stays shallow and every operation contends for the top
+    benchmark::report(sName + " " + std::to_string(iThreads) + " threads", 2 * iOperations * iThreads, benchmark::time_threads(iThreads, [&](size_t){
+      size_t iValue = 0;
+      for (size_t i = 0; i < iOperations; ++i){
+        oStack.push(i);
+        oStack.try_pop(iValue);
+      }
+    }));
+  }
+}
+
+int main(int argc, char * argv[]){
+  auto iOperations = benchmark::arg(argc, argv, 1, 200000);
+  auto iMaxThreads = benchmark::arg(argc, argv, 2, 64);
+
+  std::cout << iOperations << " push/pop pairs per thread" << std::endl;
+  run<xtd::concurrent::stack<size_t>>("stack", iOperations, iMaxThreads);
+  run<xtd::concurrent::stack<size_t, xtd::concurrent::null_wait_policy, xtd::concurrent::elimination_array<>>>("stack elimination", iOperations, iMaxThreads);
+  run<xtd::concurrent::pooled_stack<size_t>>("pooled_stack", iOperations, iMaxThreads);
+  return 0;
+}
@@ -0,0 +1,101 @@
+/** @file
+compares timer_wheel with a std::multimap of deadlines for many idle connections whose timeouts are pushed back on activity
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+usage: benchmark_timer_wheel [connections] [activity events]
+*/
+
+#include "benchmark.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <random>
+
+#include <xtd/concurrent/timer_wheel.hpp>
+
+namespace{
+  using timer_clock = xtd::concurrent::timer_wheel::clock;
+
+  /// the deadline table the socket code used before the timer wheel
+  class multimap_timers{
+    std::multimap<timer_clock::time_point, std::function<void()>> _timers;
+  public:
+    using timer_id = std::multimap<timer_clock::time_point, std::function<void()>>::iterator;
+    timer_id schedule_at(timer_clock::time_point oWhen, std::function<void()> fn){
+      return _timers.emplace(oWhen, std::move(fn));
+    }
+    timer_id reschedule(timer_id iTimer, timer_clock::time_point oWhen){
+      auto fn = std::move(iTimer->second);
+      _timers.erase(iTimer);
+      return _timers.emplace(oWhen, std::move(fn));
+    }
+    size_t advance(timer_clock::time_point oNow){
+      size_t iRet = 0;
+      while (!_timers.empty() && _timers.begin()->first <= oNow){
+        _timers.begin()->second();
+        _timers.erase(_timers.begin());
+        ++iRet;
+      }
+      return iRet;
+    }
+  };
+
+  class wheel_timers{
+    xtd::concurrent::timer_wheel _wheel;
+  public:
+    using timer_id = xtd::concurrent::timer_wheel::timer_id;
+    explicit wheel_timers(timer_clock::time_point oStart) : _wheel(std::chrono::milliseconds(1), nullptr, oStart){}
+    timer_id schedule_at(timer_clock::time_point oWhen, std::function<void()> fn){
+      return _wheel.schedule_at(oWhen, std::move(fn));
+    }
+    timer_id reschedule(timer_id iTimer, timer_clock::time_point oWhen){
+      _wheel.reschedule(iTimer, oWhen - timer_clock::now());
+      return iTimer;
+    }
+    size_t advance(timer_clock::time_point oNow){
+      return _wheel.advance(oNow);
+    }
+  };
+
+  template <typename _TimersT>
+  void run(const std::string& sName, _TimersT& oTimers, timer_clock::time_point oStart, size_t iConnections, size_t iEvents){
+    std::mt19937 oRandom(5);
+    std::vector<typename _TimersT::timer_id> oIds;
+    oIds.reserve(iConnections);
+    size_t iExpired = 0;
+    benchmark::report(sName + " schedule", iConnections, benchmark::time_it([&](){
+      for (size_t i = 0; i < iConnections; ++i){
+        oIds.push_back(oTimers.schedule_at(oStart + std::chrono::seconds(30) + std::chrono::milliseconds(oRandom() % 30000), [&iExpired](){ ++iExpired; }));
+      }
+    }));
+    benchmark::report(sName + " reschedule on activity", iEvents, benchmark::time_it([&](){
+      for (size_t i = 0; i < iEvents; ++i){
+        auto & iTimer = oIds[oRandom() % iConnections];
+        iTimer = oTimers.reschedule(iTimer, timer_clock::now() + std::chrono::seconds(30) + std::chrono::milliseconds(oRandom() % 30000));
+      }
+    }));
+    benchmark::report(sName + " expire all", iConnections, benchmark::time_it([&](){
+      oTimers.advance(timer_clock::now() + std::chrono::seconds(120));
+    }));
+  }
+}
+
+int main(int argc, char * argv[]){
+  auto iConnections = benchmark::arg(argc, argv, 1, 100000);
+  auto iEvents = benchmark::arg(argc, argv, 2, 1000000);
+
+  std::cout << iConnections << " connections " << iEvents << " activity events" << std::endl;
+  {
+    auto oStart = timer_clock::now();
+    multimap_timers oTimers;
+    run("std::multimap", oTimers, oStart, iConnections, iEvents);
+  }
+  {
+    auto oStart = timer_clock::now();
+    wheel_timers oTimers(oStart);
+    run("timer_wheel", oTimers, oStart, iConnections, iEvents);
+  }
+  return 0;
+}
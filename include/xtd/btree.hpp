@@ -30,6 +30,7 @@ copyable. A least-recently-used cache keeps hot pages mapped.
 #include <cstdint>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 #include <xtd/lru_cache.hpp>
 #include <xtd/mapped_file.hpp>
@@ -108,21 +109,20 @@ namespace xtd{
       /** an lru_cache of mapped pages that can also grow the backing file
       @tparam _page_size size of a page or -1 for the system page size
       @tparam _cache_size number of pages kept resident
+
+      Uses tinylfu_policy so a range scan over many leaves doesn't evict the branch and leaf pages that point lookups
+      running at the same time keep hitting.
       */
       template <size_t _page_size, size_t _cache_size>
-      class page_cache : public xtd::lru_cache<size_t, mapped_page<page_base>, _cache_size, page_loader<_page_size> >{
-        using _super_t = xtd::lru_cache<size_t, mapped_page<page_base>, _cache_size, page_loader<_page_size> >;
+      class page_cache : public xtd::lru_cache<size_t, mapped_page<page_base>, _cache_size, page_loader<_page_size>, std::hash<size_t>, xtd::tinylfu_policy>{
+        using _super_t = xtd::lru_cache<size_t, mapped_page<page_base>, _cache_size, page_loader<_page_size>, std::hash<size_t>, xtd::tinylfu_policy>;
       public:
         explicit page_cache(mapped_file<_page_size>& oFile) : _super_t(page_loader<_page_size>(oFile)){}
 
         /// appends a brand new page at the end of the file and caches it
         mapped_page<page_base> append(size_t& newpage){
-          if (_super_t::size() >= _cache_size){
-            _super_t::pop_back();
-          }
           auto oPage = _super_t::_loader._file->template append<page_base>(newpage);
-          _super_t::push_front(std::make_pair(newpage, oPage));
-          return _super_t::front().second;
+          return _super_t::emplace(newpage, std::move(oPage));
         }
       };
 
@@ -541,6 +541,46 @@ namespace xtd{
     const_iterator cbegin() const { return begin(); }
     const_iterator cend() const { return end(); }
 
+    // ---- leaf ranges ---------------------------------------------------------
+
+    /// consecutive leaves kept mapped so their records can be read on any thread without the page cache
+    class leaf_range{
+      friend class btree;
+      std::vector<mapped_page<leaf_t>> _leaves;
+      size_t _count = 0;
+
+    public:
+      /// number of records in the range
+      size_t size() const { return _count; }
+
+      /// calls @p fn with the key and value of each record in key order
+      template <typename _fn_t> void for_each(_fn_t&& fn) const {
+        for (auto & oLeaf : _leaves){
+          for (size_t i = 0; i < oLeaf->_count; ++i) fn(oLeaf->_records[i]._key, oLeaf->_records[i]._value);
+        }
+      }
+    };
+
+    /** walks the leaf chain in key order, passing @p fn ranges of at least @p grain records (the last may hold fewer)
+    Only the calling thread uses the page cache, so the ranges may be read concurrently by other threads as long as
+    the tree is not modified until they are released.
+    */
+    template <typename _fn_t> void for_each_leaf_range(size_t grain, _fn_t&& fn) const {
+      leaf_range oRange;
+      for (size_t idx = header()->_first_leaf; idx; ){
+        auto oLeaf = get_leaf(idx);
+        idx = oLeaf->_next_page;
+        if (!oLeaf->_count) continue;
+        oRange._count += oLeaf->_count;
+        oRange._leaves.push_back(std::move(oLeaf));
+        if (oRange._count >= grain){
+          fn(std::move(oRange));
+          oRange = leaf_range();
+        }
+      }
+      if (oRange._count) fn(std::move(oRange));
+    }
+
     // ---- capacity ------------------------------------------------------------
 
     size_t size() const { return header()->_count; }
@@ -6,47 +6,24 @@ shared declarations for the concurrent namespace
 #pragma once
 #include <xtd/xtd.hpp>
 
-#include <thread>
-
-namespace xtd{
-
-
-  namespace concurrent{
-    /** @addtogroup Concurrent
-    @{*/
-    ///Wait policy that does nothing. This is the default behavior.
-    class null_wait_policy{
-    public:
-      FORCEINLINE void operator ()(){/*nothing*/}
-    };
-    ///Wait policy that yields the current thread.
-    class yield_wait_policy{
-    public:
-      FORCEINLINE void operator ()(){ std::this_thread::yield(); }
-    };
-
-    ///RAII pattern to automatically acquire and release the spin lock
-    template <typename _Ty>
-    class scope_locker{
-    public:
-      using spin_lock_type = _Ty;
-      ~scope_locker(){ _Lock.unlock(); }
-      explicit scope_locker(spin_lock_type& oLock) : _Lock(oLock){ _Lock.lock(); }
-      scope_locker(const scope_locker&) = delete;
-      scope_locker& operator=(const scope_locker&) = delete;
-
-    private:
-      spin_lock_type& _Lock;
-    };
-
-    ///@}
-  }
-  
-}
-
+#include "wait_policy.hpp"
+#include "lock_profile.hpp"
+#include "epoch_domain.hpp"
+#include "striped_counter.hpp"
+#include "flat_hash_map.hpp"
 #include "hash_map.hpp"
+#include "pooled_stack.hpp"
+#include "mpsc_queue.hpp"
 #include "queue.hpp"
+#include "spsc_queue.hpp"
+#include "radix_map.hpp"
 #include "stack.hpp"
 #include "spin_lock.hpp"
 #include "rw_lock.hpp"
+#include "distributed_rw_lock.hpp"
 #include "recursive_spin_lock.hpp"
+#include "ticket_lock.hpp"
+#include "mcs_lock.hpp"
+#include "thread_pool.hpp"
+#include "timer_wheel.hpp"
+#include "lru_cache.hpp"
@@ -0,0 +1,162 @@
+/** @file
+multi reader/single writer lock that spreads readers over cache line sized slots and prefers writers
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+A reader increments the counter of its own slot then checks the writer word, and a writer sets the writer word then
+waits for every slot to drain. Both sides write before they read, so either the reader sees the writer and backs out
+or the writer sees the reader and waits for it. Readers on different slots never write the same cache line.
+*/
+#pragma once
+
+#include <xtd/concurrent/striped_counter.hpp>
+#include <xtd/concurrent/wait_policy.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+namespace xtd{
+  namespace concurrent{
+    /** A multiple reader/single writer lock for read mostly data
+    Each reader counts itself in one of _SlotCount padded slots chosen by its thread, so concurrent readers do not
+    contend on a shared counter. A writer announces itself before it waits for the readers to leave and new readers
+    wait while a writer is announced, so a steady stream of readers cannot starve writers.
+    Read locks are released with unlock_read and write locks with unlock_write. A thread must not take a second read
+    lock while it holds one since a waiting writer blocks the second lock and waits for the first.
+    @tparam _WaitPolicyT behavior when waiting
+    @tparam _SlotCount number of reader slots
+    */
+    template <typename _WaitPolicyT = null_wait_policy, size_t _SlotCount = 32>
+    class distributed_rw_lock_base{
+      struct alignas(64) slot{
+        slot() : _readers(0){}
+        std::atomic<uint32_t> _readers;
+      };
+      alignas(64) std::atomic<uint32_t> _writer;
+      slot _slots[_SlotCount];
+      _WaitPolicyT _WaitPolicy;
+
+      static size_t _slot_index(){
+        return _::striped_counter::thread_stripe() % _SlotCount;
+      }
+
+    public:
+      using wait_policy_type = _WaitPolicyT;
+      static constexpr size_t slot_count = _SlotCount;
+
+      distributed_rw_lock_base(wait_policy_type oWait = wait_policy_type()) : _writer(0), _WaitPolicy(oWait){}
+      distributed_rw_lock_base(const distributed_rw_lock_base&) = delete;
+      distributed_rw_lock_base& operator=(const distributed_rw_lock_base&) = delete;
+
+      ///Returns the number of active read locks. approximate while other threads lock and unlock
+      uint32_t readers() const{
+        uint32_t iRet = 0;
+        for (auto & oSlot : _slots){
+          iRet += oSlot._readers.load(std::memory_order_relaxed);
+        }
+        return iRet;
+      }
+
+      /// Acquires a shared read lock, waiting while a writer holds or waits for the lock
+      void lock_read(){
+        auto & oSlot = _slots[_slot_index()];
+        forever{
+          oSlot._readers.fetch_add(1);
+          if (!_writer.load()){
+            return;
+          }
+          _leave(oSlot);
+          _::wait::wait(_WaitPolicy, _writer, 1);
+        }
+      }
+      /** tries to acquire a shared read lock
+      @return true if the lock was acquired
+      */
+      bool try_lock_read(){
+        auto & oSlot = _slots[_slot_index()];
+        oSlot._readers.fetch_add(1);
+        if (!_writer.load()){
+          return true;
+        }
+        _leave(oSlot);
+        return false;
+      }
+      ///Releases a read lock acquired by the calling thread
+      void unlock_read(){
+        _leave(_slots[_slot_index()]);
+      }
+      ///acquires a write lock for exclusive access
+      void lock_write(){
+        forever{
+          uint32_t iWriter = 0;
+          if (_writer.compare_exchange_strong(iWriter, 1)){
+            break;
+          }
+          _::wait::wait(_WaitPolicy, _writer, iWriter);
+        }
+        for (auto & oSlot : _slots){
+          forever{
+            auto iReaders = oSlot._readers.load();
+            if (!iReaders){
+              break;
+            }
+            _::wait::wait(_WaitPolicy, oSlot._readers, iReaders);
+          }
+        }
+      }
+      /** attempts to acquire a write lock for exclusive access
+      @returns true if the lock was acquired
+      */
+      bool try_lock_write(){
+        uint32_t iWriter = 0;
+        if (!_writer.compare_exchange_strong(iWriter, 1)){
+          return false;
+        }
+        for (auto & oSlot : _slots){
+          if (oSlot._readers.load()){
+            unlock_write();
+            return false;
+          }
+        }
+        return true;
+      }
+      ///Releases the write lock
+      void unlock_write(){
+        _writer.store(0, std::memory_order_release);
+        _::wait::notify(_WaitPolicy, _writer, true);
+      }
+      /// RAII pattern to acquire and release a read lock
+      class scope_read{
+        distributed_rw_lock_base& _Lock;
+      public:
+        explicit scope_read(distributed_rw_lock_base& oLock) : _Lock(oLock){
+          _Lock.lock_read();
+        }
+        ~scope_read(){
+          _Lock.unlock_read();
+        }
+      };
+      /// RAII pattern to acquire and release a write lock
+      class scope_write{
+        distributed_rw_lock_base& _Lock;
+      public:
+        explicit scope_write(distributed_rw_lock_base& oLock) : _Lock(oLock){
+          _Lock.lock_write();
+        }
+        ~scope_write(){
+          _Lock.unlock_write();
+        }
+      };
+
+    private:
+
+      /// removes a reader from a slot and wakes a writer waiting for the slot to drain
+      void _leave(slot& oSlot){
+        if (1 == oSlot._readers.fetch_sub(1) && _writer.load()){
+          _::wait::notify(_WaitPolicy, oSlot._readers, false);
+        }
+      }
+    };
+
+    using distributed_rw_lock = distributed_rw_lock_base<null_wait_policy>;
+  }
+}
@@ -0,0 +1,262 @@
+/** @file
+epoch based reclamation of memory shared by lock-free containers
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+A lock-free container cannot delete a node as soon as it is unlinked because other threads may still be reading it.
+Threads instead enter a critical section with an epoch_domain::guard before touching shared nodes and unlinked nodes
+are retired to the domain. Each thread publishes the global epoch it observed when it entered. The global epoch only
+advances once every thread inside a critical section has observed the current epoch, so an object retired in epoch E
+can no longer be referenced by anyone once the global epoch reaches E + 2 and is then deleted.
+
+Retired objects are kept in a per-thread list so retiring never contends with other threads.
+*/
+
+#pragma once
+#include <xtd/xtd.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace xtd{
+
+  namespace concurrent{
+
+#if (!DOXY_INVOKED)
+    namespace _{
+      namespace epoch{
+
+        /// an object waiting for the global epoch to advance far enough to be deleted
+        struct retired{
+          void * _object;
+          void(*_deleter)(void*);
+          uint64_t _epoch;
+        };
+
+        /// per-thread state within a domain. records are never freed while the domain lives; exiting threads hand them to new threads
+        struct thread_record{
+          thread_record() : _state(0), _in_use(true), _nesting(0), _next(nullptr){}
+          std::atomic<uint64_t> _state; ///< (epoch << 1) | 1 while inside a critical section, 0 when quiescent
+          std::atomic<bool> _in_use;
+          uint32_t _nesting;
+          std::vector<retired> _retired;
+          thread_record * _next;
+        };
+
+        struct domain_state{
+          domain_state() : _epoch(1), _records(nullptr), _pending(0), _id(next_id()){}
+          ~domain_state(){
+            for (auto pRecord = _records.load(); pRecord;){
+              for (auto & oItem : pRecord->_retired){
+                oItem._deleter(oItem._object);
+              }
+              auto pNext = pRecord->_next;
+              delete pRecord;
+              pRecord = pNext;
+            }
+          }
+          static uint64_t next_id(){
+            static std::atomic<uint64_t> _next_id(0);
+            return ++_next_id;
+          }
+
+          /// advances the global epoch if every thread inside a critical section has observed the current one
+          void try_advance(){
+            auto iEpoch = _epoch.load();
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            for (auto pRecord = _records.load(); pRecord; pRecord = pRecord->_next){
+              auto iState = pRecord->_state.load();
+              if ((iState & 1) && (iState >> 1) != iEpoch){
+                return;
+              }
+            }
+            _epoch.compare_exchange_strong(iEpoch, 1 + iEpoch);
+          }
+
+          /// deletes the objects retired to a record that are no longer reachable
+          void reclaim(thread_record * pRecord){
+            try_advance();
+            auto iEpoch = _epoch.load();
+            auto & oRetired = pRecord->_retired;
+            auto oEnd = std::find_if(oRetired.begin(), oRetired.end(), [iEpoch](const retired& oItem){ return oItem._epoch + 2 > iEpoch; });
+            // move the expired objects out first since a deleter may retire more objects
+            std::vector<retired> oExpired(oRetired.begin(), oEnd);
+            oRetired.erase(oRetired.begin(), oEnd);
+            _pending.fetch_sub(oExpired.size(), std::memory_order_relaxed);
+            for (auto & oItem : oExpired){
+              oItem._deleter(oItem._object);
+            }
+          }
+
+          std::atomic<uint64_t> _epoch;
+          std::atomic<thread_record*> _records;
+          std::atomic<size_t> _pending;
+          const uint64_t _id;
+        };
+
+        /// the calling thread's records in every domain it has entered. released to the domain when the thread exits
+        class thread_registry{
+          struct entry{
+            uint64_t _id;
+            std::weak_ptr<domain_state> _domain;
+            thread_record * _record;
+          };
+          std::vector<entry> _entries;
+        public:
+          ~thread_registry();
+
+          thread_record * get(const std::shared_ptr<domain_state>& oDomain);
+
+          static thread_registry& instance(){
+            static thread_local thread_registry _instance;
+            return _instance;
+          }
+        };
+
+      }
+    }
+#endif
+
+    /** @addtogroup Concurrent
+    @{*/
+
+    /** epoch based memory reclamation domain
+    Containers retire unlinked objects to a domain instead of deleting them. Retired objects are deleted once every
+    thread that could have observed them has left its critical section.
+    */
+    class epoch_domain{
+      using domain_state = _::epoch::domain_state;
+      using thread_record = _::epoch::thread_record;
+      std::shared_ptr<domain_state> _state;
+
+    public:
+      /// number of objects a thread retires before it tries to advance the epoch and reclaim memory
+      static constexpr size_t collect_threshold = 64;
+
+      epoch_domain() : _state(std::make_shared<domain_state>()){}
+      ~epoch_domain() = default;
+      epoch_domain(const epoch_domain&) = delete;
+      epoch_domain& operator=(const epoch_domain&) = delete;
+
+      /// process wide domain used by the xtd::concurrent containers
+      static epoch_domain& global(){
+        static epoch_domain _global;
+        return _global;
+      }
+
+      /** RAII critical section
+      Shared nodes read while a guard is alive are not deleted until the guard is destroyed. Guards nest and must be
+      destroyed on the thread that created them.
+      */
+      class guard{
+        epoch_domain& _domain;
+        thread_record * _record;
+      public:
+        explicit guard(epoch_domain& oDomain = epoch_domain::global()) : _domain(oDomain), _record(oDomain._enter()){}
+        ~guard(){ _domain._exit(_record); }
+        guard(const guard&) = delete;
+        guard& operator=(const guard&) = delete;
+      };
+
+      /** retires an object that is no longer reachable from the shared structure
+      @param pObject the unlinked object
+      @param pDeleter function that deletes the object once no thread can reference it
+      */
+      void retire(void * pObject, void(*pDeleter)(void*)){
+        auto pRecord = _record();
+        pRecord->_retired.push_back(_::epoch::retired{ pObject, pDeleter, _state->_epoch.load() });
+        _state->_pending.fetch_add(1, std::memory_order_relaxed);
+        if (pRecord->_retired.size() >= collect_threshold){
+          _state->reclaim(pRecord);
+        }
+      }
+
+      /// retires an object allocated with new
+      template <typename _Ty>
+      void retire(_Ty * pObject){
+        retire(pObject, [](void * p){ delete static_cast<_Ty*>(p); });
+      }
+
+      /// attempts to advance the global epoch and deletes objects retired by the calling thread that are no longer reachable
+      void collect(){
+        _state->reclaim(_record());
+      }
+
+      /// number of objects retired to the domain by all threads that have not been deleted yet. approximate while threads are retiring
+      size_t pending() const{
+        return _state->_pending.load(std::memory_order_relaxed);
+      }
+
+    private:
+
+      thread_record * _record(){
+        return _::epoch::thread_registry::instance().get(_state);
+      }
+
+      thread_record * _enter(){
+        auto pRecord = _record();
+        if (0 == pRecord->_nesting++){
+          pRecord->_state.store((_state->_epoch.load() << 1) | 1);
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+        return pRecord;
+      }
+
+      void _exit(thread_record * pRecord){
+        if (0 == --pRecord->_nesting){
+          pRecord->_state.store(0, std::memory_order_release);
+        }
+      }
+
+    };
+
+#if (!DOXY_INVOKED)
+    namespace _{
+      namespace epoch{
+
+        inline thread_registry::~thread_registry(){
+          for (auto & oEntry : _entries){
+            if (auto oDomain = oEntry._domain.lock()){
+              // objects that cannot be reclaimed yet are adopted by the next thread to take the record
+              oEntry._record->_state.store(0);
+              oDomain->reclaim(oEntry._record);
+              oEntry._record->_in_use.store(false);
+            }
+          }
+        }
+
+        inline thread_record * thread_registry::get(const std::shared_ptr<domain_state>& oDomain){
+          for (auto & oEntry : _entries){
+            if (oEntry._id == oDomain->_id){
+              return oEntry._record;
+            }
+          }
+          thread_record * pRecord = nullptr;
+          // adopt a record abandoned by an exited thread
+          for (auto pItem = oDomain->_records.load(); pItem; pItem = pItem->_next){
+            bool bInUse = false;
+            if (!pItem->_in_use.load() && pItem->_in_use.compare_exchange_strong(bInUse, true)){
+              pRecord = pItem;
+              break;
+            }
+          }
+          if (!pRecord){
+            pRecord = new thread_record;
+            pRecord->_next = oDomain->_records.load();
+            while (!oDomain->_records.compare_exchange_weak(pRecord->_next, pRecord)){}
+          }
+          // forget domains that have been destroyed
+          _entries.erase(std::remove_if(_entries.begin(), _entries.end(), [](const entry& oEntry){ return oEntry._domain.expired(); }), _entries.end());
+          _entries.push_back(entry{ oDomain->_id, oDomain, pRecord });
+          return pRecord;
+        }
+
+      }
+    }
+#endif
+
+    ///@}
+  }
+}
@@ -0,0 +1,563 @@
+/** @file
+concurrently insert, query and delete items in an open addressing hash map that stores items inline
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+Slots are arranged in groups of 16 with one control byte per slot, either empty, deleted or 7 bits (h2) of the
+hash of the key held in the slot. A lookup visits groups along a probe sequence starting at the group selected
+by the rest of the hash and compares all 16 control bytes against h2 at once with SSE2, so only slots whose h2 matches
+have their keys compared and a lookup usually touches one or two cache lines.
+
+Each group carries a sequence lock. Writers hold it odd while they modify the group. Readers of trivially copyable
+keys and values read a group optimistically and retry if the sequence changed; other types are read under the lock.
+Writers of the same key are serialized by a striped key lock so checking for and inserting a key is atomic.
+
+The table grows incrementally. A resize publishes a new table and every writer then moves a few groups from the
+old table before doing its own work. A moved group keeps its control bytes so probe sequences through it still end in
+the same place, while its keys are looked up in the new table. Retired tables are released through the epoch_domain.
+*/
+
+#pragma once
+#include <xtd/concurrent/concurrent.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define XTD_FLAT_HASH_MAP_SSE2 1
+#endif
+
+#include <xtd/meta.hpp>
+#include <xtd/concurrent/epoch_domain.hpp>
+#include <xtd/concurrent/hash_map.hpp>
+#include <xtd/concurrent/spin_lock.hpp>
+
+namespace xtd{
+
+  namespace concurrent{
+
+#if (!DOXY_INVOKED)
+    namespace _{
+      namespace flat_hash_map{
+
+        static constexpr size_t group_width = 16;
+        static constexpr uint8_t empty = 0x80;
+        static constexpr uint8_t deleted = 0xfe;
+
+        /// bit i set where control byte i equals value
+        inline uint32_t match(const uint8_t * pCtrl, uint8_t value){
+#if defined(XTD_FLAT_HASH_MAP_SSE2)
+          auto oCtrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pCtrl));
+          return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(oCtrl, _mm_set1_epi8(static_cast<char>(value)))));
+#else
+          uint32_t iRet = 0;
+          for (size_t i = 0; i < group_width; ++i){
+            iRet |= static_cast<uint32_t>(pCtrl[i] == value) << i;
+          }
+          return iRet;
+#endif
+        }
+
+        /// bit i set where slot i is empty or deleted
+        inline uint32_t match_available(const uint8_t * pCtrl){
+#if defined(XTD_FLAT_HASH_MAP_SSE2)
+          return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pCtrl))));
+#else
+          uint32_t iRet = 0;
+          for (size_t i = 0; i < group_width; ++i){
+            iRet |= static_cast<uint32_t>(pCtrl[i] >> 7) << i;
+          }
+          return iRet;
+#endif
+        }
+
+        inline uint32_t lowest_bit(uint32_t x){
+          uint32_t iRet = 0;
+          for (; !(x & 1); x >>= 1, ++iRet){}
+          return iRet;
+        }
+
+        template <typename _KeyT, typename _ValueT>
+        struct slot{
+          template <typename ... _ArgTs>
+          slot(const _KeyT& key, _ArgTs&&...oArgs) : _key(key), _value(std::forward<_ArgTs>(oArgs)...){}
+          _KeyT _key;
+          _ValueT _value;
+        };
+
+        /// 16 slots sharing a cache line aligned header of control bytes and a sequence lock
+        template <typename _SlotT>
+        struct alignas(64) group{
+          group() : _seq(0), _moved(false){
+            _ctrl[0].store(0x8080808080808080ULL, std::memory_order_relaxed);
+            _ctrl[1].store(0x8080808080808080ULL, std::memory_order_relaxed);
+          }
+          ~group(){
+            if (_moved.load()){
+              return;
+            }
+            uint8_t oCtrl[group_width];
+            ctrl(oCtrl);
+            for (size_t i = 0; i < group_width; ++i){
+              if (!(oCtrl[i] & 0x80)){
+                get(i)->~_SlotT();
+              }
+            }
+          }
+          group(const group&) = delete;
+          group& operator=(const group&) = delete;
+
+          void ctrl(uint8_t * pCtrl) const{
+            uint64_t oWords[2] = { _ctrl[0].load(std::memory_order_relaxed), _ctrl[1].load(std::memory_order_relaxed) };
+            std::memcpy(pCtrl, oWords, group_width);
+          }
+
+          /// only called while the group is locked
+          void set_ctrl(size_t i, uint8_t value){
+            auto & oWord = _ctrl[i / 8];
+            uint64_t iWord = oWord.load(std::memory_order_relaxed);
+            uint8_t oBytes[8];
+            std::memcpy(oBytes, &iWord, 8);
+            oBytes[i % 8] = value;
+            std::memcpy(&iWord, oBytes, 8);
+            oWord.store(iWord, std::memory_order_relaxed);
+          }
+
+          _SlotT * get(size_t i){ return reinterpret_cast<_SlotT*>(&_slots[i]); }
+
+          void lock(){
+            forever{
+              auto iSeq = _seq.load(std::memory_order_relaxed);
+              if (!(iSeq & 1) && _seq.compare_exchange_weak(iSeq, iSeq + 1, std::memory_order_acquire)){
+                return;
+              }
+            }
+          }
+
+          void unlock(){
+            _seq.fetch_add(1, std::memory_order_release);
+          }
+
+          uint32_t read_begin() const{
+            forever{
+              auto iSeq = _seq.load(std::memory_order_acquire);
+              if (!(iSeq & 1)){
+                return iSeq;
+              }
+            }
+          }
+
+          bool read_retry(uint32_t iSeq) const{
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return _seq.load(std::memory_order_relaxed) != iSeq;
+          }
+
+          std::atomic<uint32_t> _seq;
+          std::atomic<bool> _moved; ///< set once the keys have been moved to the next table. control bytes are frozen
+          std::atomic<uint64_t> _ctrl[2];
+          typename std::aligned_storage<sizeof(_SlotT), alignof(_SlotT)>::type _slots[group_width];
+        };
+
+        template <typename _SlotT>
+        struct table{
+          using group_type = group<_SlotT>;
+          explicit table(size_t iGroups) : _mask(iGroups - 1), _groups(new group_type[iGroups]), _used(0), _prev(nullptr), _next_move(0), _moved(0){}
+          ~table(){
+            delete[] _groups;
+            delete _prev.load();
+          }
+          table(const table&) = delete;
+          table& operator=(const table&) = delete;
+
+          size_t groups() const{ return 1 + _mask; }
+          size_t capacity() const{ return group_width * groups(); }
+
+          const size_t _mask;
+          group_type * const _groups;
+          std::atomic<size_t> _used; ///< full and deleted slots
+          std::atomic<table*> _prev; ///< table whose groups are being moved into this one
+          std::atomic<size_t> _next_move; ///< next group of this table to be moved to its successor
+          std::atomic<size_t> _moved;
+        };
+
+      }
+    }
+#endif
+
+    /** @addtogroup Concurrent
+    @{*/
+
+    /** thread-safe key-value container with open addressing and inline storage
+    An alternative to hash_map when values are small and lookups dominate. Keys and values are stored in the table
+    rather than in separately allocated nodes so values are returned by copy and never by address.
+    Lookups of trivially copyable keys and values are lock-free. Writers lock the key's stripe and the group being modified.
+    @tparam _KeyT The key type. Must be equality comparable
+    @tparam _ValueT The value type
+    @tparam _HashT The hashing policy. See hash_map_hasher
+    */
+    template <typename _KeyT, typename _ValueT, typename _HashT = hash_map_hasher<_KeyT>>
+    class flat_hash_map{
+      using slot_type = _::flat_hash_map::slot<_KeyT, _ValueT>;
+      using group_type = _::flat_hash_map::group<slot_type>;
+      using table_type = _::flat_hash_map::table<slot_type>;
+      static constexpr size_t group_width = _::flat_hash_map::group_width;
+      static constexpr size_t stripe_count = 64;
+      static constexpr size_t move_chunk = 4;
+      /// groups of trivially copyable items are read optimistically, others under the group lock
+      static constexpr bool optimistic = std::is_trivially_copyable<_KeyT>::value && std::is_trivially_copyable<_ValueT>::value;
+
+      enum class probe_result{
+        found,
+        absent,
+        next,
+      };
+
+      struct alignas(64) stripe{
+        spin_lock _lock;
+      };
+
+    public:
+      using value_type = _ValueT;
+      using key_type = _KeyT;
+      using hasher = _HashT;
+
+      /** constructor
+      @param iCapacity number of items to reserve room for
+      @param oHash hashing policy instance
+      */
+      explicit flat_hash_map(size_t iCapacity = 0, const hasher& oHash = hasher()) : _table(new table_type(_groups_for(iCapacity))), _size(0), _hash(oHash){}
+
+      ~flat_hash_map(){
+        delete _table.load();
+      }
+
+      flat_hash_map(const flat_hash_map&) = delete;
+      flat_hash_map& operator=(const flat_hash_map&) = delete;
+
+      /** concurrently insert a new value associated with a key
+      @param Key key to use for indexing
+      @param Value the value to insert
+      @returns true if insert was successful
+      */
+      bool insert(const key_type& Key, value_type&& Value){
+        epoch_domain::guard oGuard;
+        _help_move();
+        auto x = _mix(Key);
+        spin_lock::scope_locker oLock(_stripe(x));
+        return _insert(x, Key, std::forward<value_type>(Value));
+      }
+
+      /** concurrently insert a value or replace the value of an existing key
+      @param Key key to use for indexing
+      @param Value the value to insert or assign
+      @returns true if the value was inserted, false if an existing value was assigned
+      */
+      bool insert_or_assign(const key_type& Key, value_type&& Value){
+        epoch_domain::guard oGuard;
+        _help_move();
+        auto x = _mix(Key);
+        spin_lock::scope_locker oLock(_stripe(x));
+        if (_modify(x, Key, [&](table_type&, group_type& oGroup, size_t i){ oGroup.get(i)->_value = std::forward<value_type>(Value); })){
+          return false;
+        }
+        return _insert(x, Key, std::forward<value_type>(Value));
+      }
+
+      /** concurrently modify the value of an existing key in place
+      @param Key key of the value to update
+      @param oFn callable invoked as oFn(value_type&) while the value is locked
+      @returns true if the key existed and was updated
+      */
+      template <typename _FnT>
+      bool update(const key_type& Key, _FnT&& oFn){
+        epoch_domain::guard oGuard;
+        auto x = _mix(Key);
+        spin_lock::scope_locker oLock(_stripe(x));
+        return _modify(x, Key, [&](table_type&, group_type& oGroup, size_t i){ oFn(oGroup.get(i)->_value); });
+      }
+
+      /** concurrently remove a value
+      @param Key key of the item to remove
+      @returns true if the item was removed
+      */
+      bool remove(const key_type& Key){
+        epoch_domain::guard oGuard;
+        _help_move();
+        auto x = _mix(Key);
+        spin_lock::scope_locker oLock(_stripe(x));
+        if (!_modify(x, Key, [&](table_type& oTable, group_type& oGroup, size_t i){ _erase(oTable, oGroup, i); })){
+          return false;
+        }
+        _size.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+      }
+
+      /** concurrently search for a key and copy its value
+      @param Key the key to search for
+      @param oRet receives a copy of the value
+      @returns true if the key exists
+      */
+      bool find(const key_type& Key, value_type& oRet) const{
+        epoch_domain::guard oGuard;
+        return _lookup(_mix(Key), Key, [&](table_type&, group_type& oGroup, size_t i){ oRet = oGroup.get(i)->_value; });
+      }
+
+      /** concurrently search for an existing key
+      @param Key the key to search for
+      @returns true if the item exists in the map
+      */
+      bool exists(const key_type& Key) const{
+        epoch_domain::guard oGuard;
+        return _lookup(_mix(Key), Key, [](table_type&, group_type&, size_t){});
+      }
+
+      /// number of items in the map. approximate while other threads are writing
+      size_t size() const{
+        return _size.load(std::memory_order_relaxed);
+      }
+
+    private:
+
+      static size_t _groups_for(size_t iCapacity){
+        size_t iGroups = 1;
+        while (iGroups * group_width * 7 / 8 < iCapacity){
+          iGroups <<= 1;
+        }
+        return iGroups;
+      }
+
+      uint64_t _mix(const key_type& Key) const{
+        return static_cast<uint64_t>(_hash(Key)) * 0x9E3779B97F4A7C15ULL;
+      }
+
+      static uint8_t _h2(uint64_t x){ return static_cast<uint8_t>(x >> 57); }
+
+      static size_t _h1(uint64_t x){ return static_cast<size_t>(x ^ (x >> 29)); }
+
+      spin_lock& _stripe(uint64_t x){ return _stripes[(x >> 40) % stripe_count]._lock; }
+
+      /// runs fn on a group either optimistically or under the group lock
+      template <typename _FnT>
+      static probe_result _read(group_type& oGroup, bool bLock, _FnT&& fn){
+        if (optimistic && !bLock){
+          forever{
+            auto iSeq = oGroup.read_begin();
+            auto eRet = fn();
+            if (!oGroup.read_retry(iSeq)){
+              return eRet;
+            }
+          }
+        }
+        oGroup.lock();
+        auto eRet = fn();
+        oGroup.unlock();
+        return eRet;
+      }
+
+      /** searches one table for a key
+      @param bLock lock each group while it is examined so fnFound can modify the slot
+      @param fnFound invoked as fnFound(table, group, slot_index) when the key is found in a group that has not moved
+      */
+      template <typename _FnT>
+      static probe_result _probe(table_type& oTable, uint64_t x, const key_type& Key, bool bLock, _FnT&& fnFound){
+        auto h2 = _h2(x);
+        auto iGroup = _h1(x) & oTable._mask;
+        for (size_t i = 0; i <= oTable._mask; ++i){
+          auto & oGroup = oTable._groups[iGroup];
+          auto eRet = _read(oGroup, bLock, [&]() -> probe_result{
+            uint8_t oCtrl[group_width];
+            oGroup.ctrl(oCtrl);
+            if (!oGroup._moved.load(std::memory_order_relaxed)){
+              for (auto iMatch = _::flat_hash_map::match(oCtrl, h2); iMatch; iMatch &= iMatch - 1){
+                auto iSlot = _::flat_hash_map::lowest_bit(iMatch);
+                if (Key == oGroup.get(iSlot)->_key){
+                  fnFound(oTable, oGroup, iSlot);
+                  return probe_result::found;
+                }
+              }
+            }
+            return (_::flat_hash_map::match(oCtrl, _::flat_hash_map::empty) ? probe_result::absent : probe_result::next);
+          });
+          if (probe_result::next != eRet){
+            return eRet;
+          }
+          iGroup = (iGroup + i + 1) & oTable._mask;
+        }
+        return probe_result::absent;
+      }
+
+      /// searches the table being moved from then the current table. restarts if the current table starts moving
+      template <typename _FnT>
+      bool _search(uint64_t x, const key_type& Key, bool bLock, _FnT&& fnFound) const{
+        forever{
+          auto pTable = _table.load();
+          if (auto pPrev = pTable->_prev.load()){
+            if (probe_result::found == _probe(*pPrev, x, Key, bLock, fnFound)){
+              return true;
+            }
+          }
+          if (probe_result::found == _probe(*pTable, x, Key, bLock, fnFound)){
+            return true;
+          }
+          if (pTable == _table.load()){
+            return false;
+          }
+        }
+      }
+
+      template <typename _FnT>
+      bool _lookup(uint64_t x, const key_type& Key, _FnT&& fnFound) const{
+        return _search(x, Key, false, std::forward<_FnT>(fnFound));
+      }
+
+      template <typename _FnT>
+      bool _modify(uint64_t x, const key_type& Key, _FnT&& fnFound){
+        return _search(x, Key, true, std::forward<_FnT>(fnFound));
+      }
+
+      static void _erase(table_type& oTable, group_type& oGroup, size_t i){
+        oGroup.get(i)->~slot_type();
+        uint8_t oCtrl[group_width];
+        oGroup.ctrl(oCtrl);
+        // no probe sequence passes a group that still has an empty slot so the slot can become empty rather than deleted
+        if (_::flat_hash_map::match(oCtrl, _::flat_hash_map::empty)){
+          oGroup.set_ctrl(i, _::flat_hash_map::empty);
+          oTable._used.fetch_sub(1, std::memory_order_relaxed);
+        } else {
+          oGroup.set_ctrl(i, _::flat_hash_map::deleted);
+        }
+      }
+
+      /// inserts a key known to be absent. called with the key's stripe locked
+      bool _insert(uint64_t x, const key_type& Key, value_type&& Value){
+        forever{
+          if (_search(x, Key, false, [](table_type&, group_type&, size_t){})){
+            return false;
+          }
+          auto pTable = _table.load();
+          bool bPlaced = false;
+          if (_place(*pTable, x, bPlaced, [&](slot_type * pSlot){ new (pSlot) slot_type(Key, std::forward<value_type>(Value)); })){
+            if (!bPlaced){
+              continue;
+            }
+            _size.fetch_add(1, std::memory_order_relaxed);
+            if (pTable->_used.load(std::memory_order_relaxed) * 8 > pTable->capacity() * 7){
+              _grow(pTable);
+            }
+            return true;
+          }
+          // no free slot
+          _grow(pTable);
+          _help_move();
+        }
+      }
+
+      /** constructs an item in the first free slot of its probe sequence
+      @param bPlaced set if the item was constructed. false if the table began moving and the caller must retry
+      @returns false if the table has no free slot
+      */
+      template <typename _CtorT>
+      bool _place(table_type& oTable, uint64_t x, bool& bPlaced, _CtorT&& fnCtor){
+        auto iGroup = _h1(x) & oTable._mask;
+        for (size_t i = 0; i <= oTable._mask; ++i){
+          auto & oGroup = oTable._groups[iGroup];
+          uint8_t oCtrl[group_width];
+          oGroup.ctrl(oCtrl);
+          if (_::flat_hash_map::match_available(oCtrl)){
+            oGroup.lock();
+            // items must not be added to a table once a newer one is published since its groups may already have moved
+            if (&oTable != _table.load()){
+              oGroup.unlock();
+              return true;
+            }
+            oGroup.ctrl(oCtrl);
+            if (auto iAvailable = _::flat_hash_map::match_available(oCtrl)){
+              auto iSlot = _::flat_hash_map::lowest_bit(iAvailable);
+              if (_::flat_hash_map::empty == oCtrl[iSlot]){
+                oTable._used.fetch_add(1, std::memory_order_relaxed);
+              }
+              fnCtor(oGroup.get(iSlot));
+              oGroup.set_ctrl(iSlot, _h2(x));
+              oGroup.unlock();
+              bPlaced = true;
+              return true;
+            }
+            oGroup.unlock();
+          }
+          iGroup = (iGroup + i + 1) & oTable._mask;
+        }
+        return false;
+      }
+
+      /// publishes a new table that the items of pTable will be moved to
+      void _grow(table_type * pTable){
+        if (pTable->_prev.load() || !_resize_lock.try_lock()){
+          return;
+        }
+        if (pTable == _table.load() && !pTable->_prev.load()){
+          auto iGroups = pTable->groups();
+          // a table full of deleted slots is rebuilt at the same size
+          if (_size.load() * 2 > pTable->capacity()){
+            iGroups <<= 1;
+          }
+          auto pNew = new table_type(iGroups);
+          pNew->_prev.store(pTable);
+          _table.store(pNew);
+        }
+        _resize_lock.unlock();
+      }
+
+      /// moves a few groups of the table being replaced and releases it once every group has moved
+      void _help_move(){
+        auto pTable = _table.load();
+        auto pPrev = pTable->_prev.load();
+        if (!pPrev){
+          return;
+        }
+        auto iBegin = pPrev->_next_move.fetch_add(move_chunk);
+        if (iBegin >= pPrev->groups()){
+          return;
+        }
+        auto iEnd = std::min(iBegin + move_chunk, pPrev->groups());
+        for (auto i = iBegin; i < iEnd; ++i){
+          _move_group(*pTable, pPrev->_groups[i]);
+        }
+        if (pPrev->groups() == pPrev->_moved.fetch_add(iEnd - iBegin) + (iEnd - iBegin)){
+          pTable->_prev.store(nullptr);
+          epoch_domain::global().retire(pPrev);
+        }
+      }
+
+      void _move_group(table_type& oTable, group_type& oGroup){
+        oGroup.lock();
+        uint8_t oCtrl[group_width];
+        oGroup.ctrl(oCtrl);
+        for (size_t i = 0; i < group_width; ++i){
+          if (oCtrl[i] & 0x80){
+            continue;
+          }
+          auto pSlot = oGroup.get(i);
+          bool bPlaced = false;
+          // the new table is sized so moved items always fit
+          _place(oTable, _mix(pSlot->_key), bPlaced, [&](slot_type * pNew){ new (pNew) slot_type(pSlot->_key, std::move(pSlot->_value)); });
+          pSlot->~slot_type();
+        }
+        oGroup._moved.store(true, std::memory_order_relaxed);
+        oGroup.unlock();
+      }
+
+      std::atomic<table_type*> _table;
+      std::atomic<size_t> _size;
+      stripe _stripes[stripe_count];
+      spin_lock _resize_lock;
+      hasher _hash;
+    };
+
+    ///@}
+  }
+}
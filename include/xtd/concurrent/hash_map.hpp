@@ -1,16 +1,31 @@
 /** @file
 concurrently insert, query and delete items in an unordered hash map
 @copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+Keys are hashed by a hashing policy and the hash is indexed by a 16-way trie, one nibble per level. Each leaf slot
+holds a lock-free list of the entries whose hashes are identical so keys wider than the hash (strings, unique_ids,
+composite keys) can collide without being lost. Lookups compare the stored hash before comparing keys.
 */
 
 #pragma once
-#include <xtd/concurrent/concurrent.hpp>
+#include <xtd/xtd.hpp>
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <type_traits>
 #include <vector>
 #include <atomic>
 
 #include <xtd/meta.hpp>
+#include <xtd/concurrent/epoch_domain.hpp>
+#include <xtd/concurrent/spin_lock.hpp>
+#include <xtd/concurrent/striped_counter.hpp>
 
 namespace xtd{
 
@@ -18,31 +33,464 @@ namespace xtd{
     /** @addtogroup Concurrent
     @{*/
 
-    /** Unsafe iterator
-    iterating should be done on a constant hash_map since it's not thread-safe to use with insertion/deletion.
+    /** default hashing policy of hash_map
+    Integral keys are their own hash so dense keys stay dense in the trie and never collide.
+    Other keys are hashed with std::hash and folded to 32 bits since the trie depth grows with the width of the hash.
+    A hashing policy is any function object returning an unsigned integral hash for a key.
+    @tparam _KeyT the key type
+    */
+    template <typename _KeyT, typename = void>
+    struct hash_map_hasher{
+      uint32_t operator()(const _KeyT& Key) const{
+        auto x = static_cast<uint64_t>(std::hash<_KeyT>()(Key));
+        return static_cast<uint32_t>(x ^ (x >> 32));
+      }
+    };
+
+    /** memory, shape and contention of a hash_map
+    The shape is measured by walking the map so it is approximate while other threads are writing. The contention
+    counters accumulate from the construction of the map.
+    */
+    struct hash_map_stats{
+      size_t entries = 0; ///< items in the map
+      size_t removed_entries = 0; ///< removed items that are still linked. items that have been unlinked and are waiting for the epoch_domain are not counted
+      size_t trie_nodes = 0;
+      size_t entry_bytes = 0; ///< memory of the linked entries. excludes memory the keys and values own
+      size_t trie_bytes = 0; ///< memory of the trie nodes
+      size_t arena_bytes = 0; ///< memory reserved by insert_bulk and build_from. holds some of the entries and nodes counted above
+      size_t longest_list = 0; ///< most items whose keys share one hash
+      std::vector<std::array<size_t, 17>> occupancy; ///< occupancy[level][n] is the number of trie nodes of a level with n of their 16 slots in use. level 0 is the root
+      uint64_t insert_cas_failures = 0; ///< inserts that lost a race to change a list head
+      uint64_t remove_cas_failures = 0; ///< removals that lost a race to mark an item
+      uint64_t unlink_cas_failures = 0; ///< failed attempts to unlink a removed item
+      uint64_t node_cas_failures = 0; ///< trie nodes created by two threads at once
+    };
+
+#if (!DOXY_INVOKED)
+    template <typename _KeyT>
+    struct hash_map_hasher<_KeyT, typename std::enable_if<std::is_integral<_KeyT>::value>::type>{
+      typename processor_intrinsic<_KeyT>::type operator()(const _KeyT& Key) const{
+        return intrinsic_cast(Key);
+      }
+    };
+
+    namespace _{
+      namespace hash_map{
+
+        /// tagged link to the next entry. bit 0 set when the entry owning the link has been removed
+        using link = std::atomic<uintptr_t>;
+        static constexpr uintptr_t mark_bit = 1;
+
+        enum counter{
+          insert_failures,
+          remove_failures,
+          unlink_failures,
+          node_failures,
+          counter_count,
+        };
+        using counters = xtd::concurrent::striped_counter<counter_count>;
+
+        /// blocks of memory handed out by arenas. freed when the last owner releases the pool
+        class arena_pool{
+          spin_lock _lock;
+          std::vector<void*> _blocks;
+          std::atomic<size_t> _bytes;
+        public:
+          arena_pool() : _bytes(0){}
+          ~arena_pool(){
+            for (auto pBlock : _blocks){
+              ::operator delete(pBlock);
+            }
+          }
+          arena_pool(const arena_pool&) = delete;
+          arena_pool& operator=(const arena_pool&) = delete;
+
+          char * block(size_t iSize){
+            auto pRet = ::operator new(iSize);
+            _bytes.fetch_add(iSize, std::memory_order_relaxed);
+            spin_lock::scope_locker oLock(_lock);
+            try{
+              _blocks.push_back(pRet);
+            } catch (...){
+              ::operator delete(pRet);
+              throw;
+            }
+            return static_cast<char*>(pRet);
+          }
+
+          /// memory of every block handed out
+          size_t bytes() const{ return _bytes.load(std::memory_order_relaxed); }
+        };
+
+        /// single threaded bump allocator drawing blocks from a pool. objects are destroyed in place and their memory is never reused
+        class arena{
+          arena_pool& _pool;
+          char * _pos;
+          size_t _left;
+        public:
+          static constexpr size_t block_size = 1 << 20;
+
+          explicit arena(arena_pool& oPool) : _pool(oPool), _pos(nullptr), _left(0){}
+          arena(const arena&) = delete;
+          arena& operator=(const arena&) = delete;
+
+          void * allocate(size_t iSize, size_t iAlign){
+            auto iPad = static_cast<size_t>(-reinterpret_cast<intptr_t>(_pos)) & (iAlign - 1);
+            if (iPad + iSize > _left){
+              _left = std::max(block_size, iSize + iAlign);
+              _pos = _pool.block(_left);
+              iPad = static_cast<size_t>(-reinterpret_cast<intptr_t>(_pos)) & (iAlign - 1);
+            }
+            auto pRet = _pos + iPad;
+            _pos += iPad + iSize;
+            _left -= iPad + iSize;
+            return pRet;
+          }
+
+          template <typename _Ty, typename ... _ArgTs>
+          _Ty * make(_ArgTs&&...oArgs){
+            return new (allocate(sizeof(_Ty), alignof(_Ty))) _Ty(std::forward<_ArgTs>(oArgs)...);
+          }
+        };
+
+        template <typename _KeyT, typename _ValueT, typename _HashT>
+        struct entry{
+          template <typename ... _ArgTs>
+          entry(_HashT hash, const _KeyT& key, _ArgTs&&...oArgs) : _hash(hash), _key(key), _value(std::forward<_ArgTs>(oArgs)...), _next(0), _arena(false){}
+          entry(const entry&) = delete;
+          entry& operator=(const entry&) = delete;
+          const _HashT _hash;
+          const _KeyT _key;
+          _ValueT _value;
+          link _next;
+          spin_lock _lock; ///< serializes in-place updates of _value
+          bool _arena; ///< allocated from an arena so only destroyed in place
+
+          /// destroys an entry and frees it unless its memory belongs to an arena
+          static void release(entry * pEntry){
+            if (pEntry->_arena){
+              pEntry->~entry();
+            } else {
+              delete pEntry;
+            }
+          }
+
+          static entry * from_link(uintptr_t p){ return reinterpret_cast<entry*>(p & ~mark_bit); }
+          bool removed() const{ return 0 != (_next.load() & mark_bit); }
+
+          /// the first entry in a list starting at p that has not been removed
+          static entry * first(uintptr_t p){
+            for (auto pEntry = from_link(p); pEntry; pEntry = from_link(pEntry->_next.load())){
+              if (!pEntry->removed()){
+                return pEntry;
+              }
+            }
+            return nullptr;
+          }
+
+          /// the last entry in a list starting at p that has not been removed and precedes pBefore
+          static entry * last(uintptr_t p, const entry * pBefore = nullptr){
+            entry * pRet = nullptr;
+            for (auto pEntry = from_link(p); pEntry && pEntry != pBefore; pEntry = from_link(pEntry->_next.load())){
+              if (!pEntry->removed()){
+                pRet = pEntry;
+              }
+            }
+            return pRet;
+          }
+
+          /// deletes every entry in a list including removed entries that were never unlinked
+          static void destroy(uintptr_t p){
+            for (auto pEntry = from_link(p); pEntry;){
+              auto pNext = from_link(pEntry->_next.load());
+              release(pEntry);
+              pEntry = pNext;
+            }
+          }
+        };
+
+        /// 16-way trie indexed by the hash one nibble per level
+        template <typename _EntryT, int _NibblePos>
+        class trie{
+          using child_type = trie<_EntryT, _NibblePos - 1>;
+          template <typename, int> friend class trie;
+          static constexpr int8_t nibble_count = 16;
+          std::atomic<child_type *> _Buckets[nibble_count];
+          const bool _arena;
+
+        public:
+          explicit trie(bool bArena = false) : _arena(bArena){
+            for (auto &oItem : _Buckets){
+              oItem.store(nullptr);
+            }
+          }
+
+          ~trie(){
+            for (auto &oItem : _Buckets){
+              if (auto pChild = oItem.load()){
+                if (pChild->_arena){
+                  pChild->~child_type();
+                } else {
+                  delete pChild;
+                }
+              }
+            }
+          }
+
+          trie(const trie&) = delete;
+          trie& operator=(const trie&) = delete;
+
+          /** the list head of a hash, creating the path to it when bCreate is set
+          @param pArena allocates created nodes when not null
+          @param pCounters counts nodes that lose the race to be created when not null
+          */
+          template <typename _HashT>
+          link * slot(_HashT x, bool bCreate, arena * pArena = nullptr, counters * pCounters = nullptr){
+            int Index = (x & 0xf);
+            auto pChild = _Buckets[Index].load();
+            if (!pChild){
+              if (!bCreate){
+                return nullptr;
+              }
+              pChild = (pArena ? pArena->make<child_type>(true) : new child_type);
+              child_type *pNullBucket = nullptr;
+              if (!_Buckets[Index].compare_exchange_strong(pNullBucket, pChild)){
+                if (pArena){
+                  pChild->~child_type();
+                } else {
+                  delete pChild;
+                }
+                pChild = pNullBucket;
+                if (pCounters){
+                  pCounters->add(node_failures);
+                }
+              }
+            }
+            return pChild->slot(static_cast<_HashT>(x >> 4), bCreate, pArena, pCounters);
+          }
+
+          /// adds the shape of this node and its children to the stats
+          void shape(hash_map_stats& oStats, size_t iLevel) const{
+            size_t iUsed = 0;
+            for (auto &oItem : _Buckets){
+              if (auto pChild = oItem.load()){
+                ++iUsed;
+                pChild->shape(oStats, 1 + iLevel);
+              }
+            }
+            ++oStats.occupancy[iLevel][iUsed];
+            ++oStats.trie_nodes;
+            oStats.trie_bytes += sizeof(trie);
+          }
+
+          /// invokes fn on every entry below the buckets [iBegin, iEnd)
+          template <typename _FnT>
+          void visit(_FnT &fn, int8_t iBegin = 0, int8_t iEnd = nibble_count) const{
+            for (auto i = iBegin; i < iEnd; ++i){
+              if (auto pChild = _Buckets[i].load()){
+                pChild->visit(fn);
+              }
+            }
+          }
+
+          _EntryT *_begin(int8_t *pKey) const{
+            child_type *pChildBucket;
+            for (*pKey = 0; *pKey < nibble_count; ++*pKey){
+              _EntryT *pRet;
+              if ((pChildBucket = _Buckets[*pKey].load()) && (pRet = pChildBucket->_begin(1 + pKey))){
+                return pRet;
+              }
+            }
+            return nullptr;
+          }
+
+          _EntryT *_back(int8_t *pKey) const{
+            child_type *pChildBucket;
+            for (*pKey = nibble_count - 1; *pKey >= 0; --*pKey){
+              _EntryT *pRet;
+              if ((pChildBucket = _Buckets[*pKey].load()) && (pRet = pChildBucket->_back(1 + pKey))){
+                return pRet;
+              }
+            }
+            return nullptr;
+          }
+
+          _EntryT *_next(int8_t *pKey) const{
+            child_type *pChildBucket;
+            if (*pKey < 0 || *pKey >= nibble_count){
+              *pKey = 0;
+            }
+            for (; *pKey < nibble_count; ++*pKey){
+              _EntryT *pRet;
+              if ((pChildBucket = _Buckets[*pKey].load()) && (pRet = pChildBucket->_next(1 + pKey))){
+                return pRet;
+              }
+            }
+            *pKey = -1;
+            return nullptr;
+          }
+
+          _EntryT *_prev(int8_t *pKey) const{
+            child_type *pChildBucket;
+            if (*pKey < 0 || *pKey >= nibble_count){
+              *pKey = nibble_count - 1;
+            }
+            for (; *pKey >= 0; --*pKey){
+              _EntryT *pRet;
+              if ((pChildBucket = _Buckets[*pKey].load()) && (pRet = pChildBucket->_prev(1 + pKey))){
+                return pRet;
+              }
+            }
+            *pKey = -1;
+            return nullptr;
+          }
+        };
+
+        template <typename _EntryT>
+        class trie<_EntryT, 0>{
+          template <typename, int> friend class trie;
+          static constexpr int8_t nibble_count = 16;
+          link _Values[nibble_count];
+          const bool _arena;
+
+        public:
+          explicit trie(bool bArena = false) : _arena(bArena){
+            for (auto &oItem : _Values){
+              oItem.store(0);
+            }
+          }
+
+          ~trie(){
+            for (auto &oItem : _Values){
+              _EntryT::destroy(oItem.load());
+            }
+          }
+
+          trie(const trie&) = delete;
+          trie& operator=(const trie&) = delete;
+
+          template <typename _HashT>
+          link * slot(_HashT x, bool, arena * = nullptr, counters * = nullptr){
+            return &_Values[x & 0xf];
+          }
+
+          void shape(hash_map_stats& oStats, size_t iLevel) const{
+            size_t iUsed = 0;
+            for (auto &oItem : _Values){
+              size_t iLength = 0;
+              for (auto pEntry = _EntryT::from_link(oItem.load()); pEntry; pEntry = _EntryT::from_link(pEntry->_next.load())){
+                if (pEntry->removed()){
+                  ++oStats.removed_entries;
+                } else {
+                  ++oStats.entries;
+                  ++iLength;
+                }
+                oStats.entry_bytes += sizeof(_EntryT);
+              }
+              iUsed += (iLength ? 1 : 0);
+              oStats.longest_list = std::max(oStats.longest_list, iLength);
+            }
+            ++oStats.occupancy[iLevel][iUsed];
+            ++oStats.trie_nodes;
+            oStats.trie_bytes += sizeof(trie);
+          }
+
+          /// invokes fn on every entry in the leaf that has not been removed. the epoch is only pinned while the leaf is visited
+          template <typename _FnT>
+          void visit(_FnT &fn, int8_t iBegin = 0, int8_t iEnd = nibble_count) const{
+            epoch_domain::guard oGuard;
+            for (auto i = iBegin; i < iEnd; ++i){
+              for (auto pEntry = _EntryT::first(_Values[i].load()); pEntry; pEntry = _EntryT::first(pEntry->_next.load())){
+                fn(pEntry->_key, pEntry->_value);
+              }
+            }
+          }
+
+          _EntryT *_begin(int8_t *pKey) const{
+            for (*pKey = 0; *pKey < nibble_count; ++*pKey){
+              if (auto pRet = _EntryT::first(_Values[*pKey].load())){
+                return pRet;
+              }
+            }
+            return nullptr;
+          }
+
+          _EntryT *_back(int8_t *pKey) const{
+            for (*pKey = nibble_count - 1; *pKey >= 0; --*pKey){
+              if (auto pRet = _EntryT::last(_Values[*pKey].load())){
+                return pRet;
+              }
+            }
+            return nullptr;
+          }
+
+          _EntryT *_next(int8_t *pKey) const{
+            if (*pKey < 0 || *pKey >= nibble_count){
+              *pKey = 0;
+            }
+            for (; *pKey < nibble_count; ++*pKey){
+              if (auto pRet = _EntryT::first(_Values[*pKey].load())){
+                return pRet;
+              }
+            }
+            *pKey = -1;
+            return nullptr;
+          }
+
+          _EntryT *_prev(int8_t *pKey) const{
+            if (*pKey < 0 || *pKey >= nibble_count){
+              *pKey = nibble_count - 1;
+            }
+            for (; *pKey >= 0; --*pKey){
+              if (auto pRet = _EntryT::last(_Values[*pKey].load())){
+                return pRet;
+              }
+            }
+            *pKey = -1;
+            return nullptr;
+          }
+        };
+
+      }
+    }
+#endif
+
+    /** weakly consistent iterator
+    Iterating is safe while other threads insert and remove items. An iterator visits every item that is in the map for
+    the whole traversal and may or may not visit items inserted or removed during it. A key that is removed and inserted
+    again during the traversal may be visited twice.
+    An iterator holds an epoch_domain::guard so the entries it references stay valid, which also delays reclamation of
+    removed items until it is destroyed. An iterator must be used and destroyed on the thread that created it. Use
+    hash_map::for_each for long scans.
     @tparam _HashMapT the hash_map type associated with this iterator.
     */
     template<typename _HashMapT>
     class hash_map_iterator {
-      template<typename, typename, int> friend
+      template<typename, typename, typename> friend
       class hash_map;
 
-      static constexpr int key_nibbles = sizeof(typename _HashMapT::key_type) * 2;
+      using entry_type = typename _HashMapT::entry_type;
+      static constexpr int key_nibbles = sizeof(typename _HashMapT::hash_type) * 2;
+      epoch_domain::guard _Guard;
       const _HashMapT *_Map;
-      typename _HashMapT::value_type *_Current;
-      std::vector<int8_t> _Key;
+      entry_type *_Current;
+      int8_t _Key[key_nibbles];
 
-      hash_map_iterator(const _HashMapT *pMap, typename _HashMapT::value_type *pCurrent,
-                        const std::vector<int8_t> &oKey) : _Map(pMap), _Current(pCurrent), _Key(oKey) {}
+      explicit hash_map_iterator(const _HashMapT *pMap) : _Map(pMap), _Current(nullptr) {
+        std::fill(_Key, _Key + key_nibbles, static_cast<int8_t>(-1));
+      }
 
     public:
       using value_type = typename _HashMapT::value_type;
+      using key_type = typename _HashMapT::key_type;
 
-      hash_map_iterator(const hash_map_iterator &src) : _Map(src._Map), _Current(src._Current), _Key(src._Key) {}
+      hash_map_iterator(const hash_map_iterator &src) : _Map(src._Map), _Current(src._Current) {
+        std::copy(src._Key, src._Key + key_nibbles, _Key);
+      }
 
-      hash_map_iterator(hash_map_iterator &&src) : _Map(src._Map), _Current(src._Current), _Key(std::move(src._Key)) {}
+      hash_map_iterator(hash_map_iterator &&src) : hash_map_iterator(static_cast<const hash_map_iterator&>(src)) {}
 
-      hash_map_iterator() : _Map(nullptr), _Current(nullptr), _Key(key_nibbles, -1) {}
+      hash_map_iterator() : hash_map_iterator(nullptr) {}
 
       hash_map_iterator &operator=(const hash_map_iterator &src) {
         if (this == &src) {
@@ -50,16 +498,12 @@ namespace xtd{
         }
         _Map = src._Map;
         _Current = src._Current;
-        _Key = src._Key;
+        std::copy(src._Key, src._Key + key_nibbles, _Key);
+        return *this;
       }
 
-      hash_map_iterator &operator==(hash_map_iterator &&src) {
-        if (this == &src) {
-          return *this;
-        }
-        _Map = src._Map;
-        _Current = src._Current;
-        _Key = std::move(src._Key);
+      hash_map_iterator &operator=(hash_map_iterator &&src) {
+        return *this = static_cast<const hash_map_iterator&>(src);
       }
 
       bool operator==(const hash_map_iterator &rhs) const {
@@ -70,27 +514,30 @@ namespace xtd{
         return (_Current != rhs._Current);
       }
 
-      value_type *get() { return _Current; }
+      /// key of the current element
+      const key_type &key() const {
+        return _Current->_key;
+      }
+
+      /// the value of the current element. like find, reading does not synchronize with update
+      value_type *get() { return (_Current ? &_Current->_value : nullptr); }
 
-      const value_type *get() const { return _Current; }
+      const value_type *get() const { return (_Current ? &_Current->_value : nullptr); }
 
-      value_type *operator->() { return _Current; }
+      value_type *operator->() { return get(); }
 
-      const value_type *operator->() const { return _Current; }
+      const value_type *operator->() const { return get(); }
 
       value_type &operator*() {
-        XTD_ASSERT(_Current);
-        return *_Current;
+        return _Current->_value;
       }
 
       const value_type &operator*() const {
-        XTD_ASSERT(_Current);
-        return *_Current;
+        return _Current->_value;
       }
 
       hash_map_iterator &operator++() {
-        ++_Key.back();
-        _Current = _Map->_next(&_Key[0]);
+        _Current = _Map->_next(&_Key[0], _Current);
         return *this;
       }
 
@@ -101,8 +548,7 @@ namespace xtd{
       }
 
       hash_map_iterator &operator--() {
-        --_Key.back();
-        _Current = _Map->_prev(&_Key[0]);
+        _Current = _Map->_prev(&_Key[0], _Current);
         return *this;
       }
 
@@ -117,44 +563,61 @@ namespace xtd{
 
 
       /** thread-safe key-value pair container
-      insertion and removal from multiple threads is safe but invalidates iterators.
-      iteration from multiple threads is also safe but should not be done while mixing insertion and removal since they invalidate iterators.
-      @tparam _KeyT The key type
+      insertion and removal from multiple threads is safe.
+      removed values are retired to epoch_domain::global() and deleted once no thread holding an epoch_domain::guard can reference them.
+      insert_or_assign, try_emplace, compute_if_absent and update are linearizable. in place updates of a value are serialized by a per-entry spin lock.
+      iterators, for_each and parallel_for_each are weakly consistent and safe to use while other threads insert and remove items.
+      @tparam _KeyT The key type. Must be equality comparable
       @tparam _ValueT The value type
+      @tparam _HashT The hashing policy. See hash_map_hasher
       */
-      template<typename _KeyT, typename _ValueT, int _NibblePos = sizeof(_KeyT) * 2>
+      template<typename _KeyT, typename _ValueT, typename _HashT = hash_map_hasher<_KeyT>>
       class hash_map {
-        using _my_t = hash_map<_KeyT, _ValueT, _NibblePos>;
-        using child_bucket_type = hash_map<_KeyT, _ValueT, _NibblePos - 1>;
-        static constexpr int nibble_pos = _NibblePos;
         template<typename> friend
         class hash_map_iterator;
 
-        template<typename, typename, int> friend
-        class hash_map;
-
-        static constexpr int8_t nibble_count = 16;
-        std::atomic<child_bucket_type *> _Buckets[nibble_count];
-
       public:
         using value_type = _ValueT;
         using key_type = _KeyT;
-        using iterator_type = hash_map_iterator<_my_t>;
+        using hasher = _HashT;
+        using hash_type = typename std::decay<decltype(std::declval<const _HashT&>()(std::declval<const _KeyT&>()))>::type;
+        using iterator_type = hash_map_iterator<hash_map>;
 
-        hash_map() {
-          for (auto &oItem : _Buckets) {
-            oItem.store(nullptr);
+      private:
+        static_assert(std::is_integral<hash_type>::value && std::is_unsigned<hash_type>::value, "hash_map hashing policy must return an unsigned integral hash");
+
+        using entry_type = _::hash_map::entry<_KeyT, _ValueT, hash_type>;
+        using link = _::hash_map::link;
+        using trie_type = _::hash_map::trie<entry_type, sizeof(hash_type) * 2 - 1>;
+        using arena_type = _::hash_map::arena;
+        using arena_pool_type = _::hash_map::arena_pool;
+        static constexpr int key_nibbles = sizeof(hash_type) * 2;
+        static constexpr int8_t bucket_count = 16;
+        /// items inserted by a bulk load between entering and leaving the epoch
+        static constexpr size_t bulk_batch = 1024;
+
+        /// an entry allocated from an arena that has been removed. keeps the arena alive until the entry is destroyed
+        struct retired_entry {
+          entry_type *_entry;
+          std::shared_ptr<arena_pool_type> _pool;
+
+          static void release(void *pObject) {
+            auto pRetired = static_cast<retired_entry*>(pObject);
+            pRetired->_entry->~entry_type();
+            delete pRetired;
           }
-        }
+        };
 
-        ~hash_map(){
-          for (int8_t i=0 ; i<nibble_count ; ++i){
-            auto pItem = _Buckets[i].load();
-            if (pItem){
-              delete pItem;
-            }
-          }
-        }
+        std::shared_ptr<arena_pool_type> _Pool; ///< declared before _Root so arena items are destroyed before their memory is freed
+        trie_type _Root;
+        hasher _Hash;
+        _::hash_map::counters _Counters;
+
+      public:
+
+        hash_map(const hasher& oHash = hasher()) : _Pool(std::make_shared<arena_pool_type>()), _Hash(oHash) {}
+
+        ~hash_map() = default;
 
         hash_map(const hash_map &) = delete;
 
@@ -166,18 +629,149 @@ namespace xtd{
         @returns true if insert was successful
         */
         bool insert(const key_type &Key, value_type &&Value) {
-          auto x = intrinsic_cast(Key);
-          int Index = (x & 0xf);
-          auto pChild = _Buckets[Index].load();
-          if (!pChild) {
-            pChild = new child_bucket_type;
-            child_bucket_type *pNullBucket = nullptr;
-            if (!_Buckets[Index].compare_exchange_strong(pNullBucket, pChild)) {
-              delete pChild;
-            }
-          }
-          x >>= 4;
-          return pChild->insert(intrinsic_cast(x), std::forward<value_type>(Value));
+          epoch_domain::guard oGuard;
+          return nullptr != _insert(Key, [&](hash_type Hash){ return new entry_type(Hash, Key, std::forward<value_type>(Value)); }, nullptr);
+        }
+
+        /** insert a sequence of key-value pairs
+        Entries and trie nodes are allocated from an arena rather than individually so loading many items is dominated
+        by neither the allocator nor freeing the items later. The memory of items loaded in bulk is only returned when
+        the map is destroyed. Safe to call while other threads use the map.
+        @param first iterator to the first pair. pairs of an rvalue sequence (e.g. std::move_iterator) are moved from
+        @param last iterator past the last pair
+        @returns number of pairs inserted. pairs whose key exists are skipped
+        */
+        template <typename _IteratorT>
+        size_t insert_bulk(_IteratorT first, _IteratorT last) {
+          arena_type oArena(*_Pool);
+          size_t iRet = 0;
+          while (first != last) {
+            epoch_domain::guard oGuard;
+            for (size_t i = 0; i < bulk_batch && first != last; ++i, ++first) {
+              auto &&oItem = *first;
+              iRet += _insert_arena(oArena, oItem.first, std::forward<decltype(oItem)>(oItem).second);
+            }
+          }
+          return iRet;
+        }
+
+        /** insert the key-value pairs of a random access range with several threads
+        The input is partitioned by the top level trie bucket of each key so every thread fills a disjoint subtree and
+        the threads never contend. Each thread allocates from its own arena as in insert_bulk.
+        @param oRange random access range of pairs. copied from
+        @param iThreads number of threads to build with. at most 16 are used
+        @returns number of pairs inserted. pairs whose key exists are skipped
+        */
+        template <typename _RangeT>
+        size_t build_from(const _RangeT &oRange, size_t iThreads = std::thread::hardware_concurrency()) {
+          using std::begin;
+          using std::end;
+          auto oBegin = begin(oRange);
+          auto iCount = static_cast<size_t>(std::distance(oBegin, end(oRange)));
+          iThreads = std::max<size_t>(1, std::min<size_t>(iThreads, bucket_count));
+          // first pass finds the thread that owns each item
+          std::vector<uint8_t> oOwners(iCount);
+          _parallel(iThreads, [&](size_t iThread) {
+            auto iEnd = iCount * (1 + iThread) / iThreads;
+            for (auto i = iCount * iThread / iThreads; i < iEnd; ++i) {
+              oOwners[i] = static_cast<uint8_t>((_Hash(oBegin[i].first) & 0xf) * iThreads / bucket_count);
+            }
+          });
+          std::atomic<size_t> iRet(0);
+          _parallel(iThreads, [&](size_t iThread) {
+            arena_type oArena(*_Pool);
+            size_t iInserted = 0;
+            for (size_t i = 0; i < iCount;) {
+              epoch_domain::guard oGuard;
+              for (auto iEnd = std::min(iCount, i + bulk_batch); i < iEnd; ++i) {
+                if (iThread == oOwners[i]) {
+                  auto &&oItem = oBegin[i];
+                  iInserted += _insert_arena(oArena, oItem.first, oItem.second);
+                }
+              }
+            }
+            iRet += iInserted;
+          });
+          return iRet;
+        }
+
+        /** concurrently insert a value constructed in place if the key does not exist
+        The value is only constructed when the key is absent so a failed call does not allocate unless it loses a race
+        with another insertion of the same key.
+        @param Key key to use for indexing
+        @param oArgs arguments forwarded to the value constructor
+        @returns true if the value was inserted
+        */
+        template <typename ... _ArgTs>
+        bool try_emplace(const key_type &Key, _ArgTs&&...oArgs) {
+          epoch_domain::guard oGuard;
+          return nullptr != _insert(Key, [&](hash_type Hash){ return new entry_type(Hash, Key, std::forward<_ArgTs>(oArgs)...); }, nullptr);
+        }
+
+        /** concurrently insert a value or replace the value of an existing key
+        @param Key key to use for indexing
+        @param Value the value to insert or assign
+        @returns true if the value was inserted, false if an existing value was assigned
+        */
+        bool insert_or_assign(const key_type &Key, value_type &&Value) {
+          epoch_domain::guard oGuard;
+          // holds Value when an insert loses the race to another insert of the key
+          entry_type *pSpare = nullptr;
+          forever {
+            entry_type *pExisting = nullptr;
+            if (_insert(Key, [&](hash_type Hash){ return (pSpare ? pSpare : new entry_type(Hash, Key, std::forward<value_type>(Value))); }, &pExisting, &pSpare)) {
+              return true;
+            }
+            spin_lock::scope_locker oLock(pExisting->_lock);
+            // a removed entry is no longer in the map so the key must be inserted again
+            if (!pExisting->removed()) {
+              pExisting->_value = (pSpare ? std::move(pSpare->_value) : std::forward<value_type>(Value));
+              delete pSpare;
+              return false;
+            }
+          }
+        }
+
+        /** concurrently get the value of a key, inserting the value returned by a factory if the key does not exist
+        The factory is only invoked when the key is absent. Threads racing to insert the same key may each invoke it but
+        only one result is stored and returned to all of them.
+        @param Key key to use for indexing
+        @param oFactory callable returning the value to insert
+        @returns copy of the value associated with the key
+        */
+        template <typename _FactoryT>
+        value_type compute_if_absent(const key_type &Key, _FactoryT&& oFactory) {
+          epoch_domain::guard oGuard;
+          entry_type *pExisting = nullptr;
+          auto pEntry = _insert(Key, [&](hash_type Hash){ return new entry_type(Hash, Key, oFactory()); }, &pExisting);
+          if (!pEntry) {
+            pEntry = pExisting;
+          }
+          spin_lock::scope_locker oLock(pEntry->_lock);
+          return pEntry->_value;
+        }
+
+        /** concurrently modify the value of an existing key in place
+        Updates of the same key are serialized. Values that are updated should only be read through update since find
+        does not synchronize with it.
+        @param Key key of the value to update
+        @param oFn callable invoked as oFn(value_type&)
+        @returns true if the key existed and was updated
+        */
+        template <typename _FnT>
+        bool update(const key_type &Key, _FnT&& oFn) {
+          epoch_domain::guard oGuard;
+          forever {
+            auto pEntry = _find(Key);
+            if (!pEntry) {
+              return false;
+            }
+            spin_lock::scope_locker oLock(pEntry->_lock);
+            if (!pEntry->removed()) {
+              oFn(pEntry->_value);
+              return true;
+            }
+          }
         }
 
         /** concurrently search for an existing key
@@ -185,11 +779,20 @@ namespace xtd{
         @returns true if the item exists in the map
         */
         bool exists(const key_type &Key) const {
-          auto x = intrinsic_cast(Key);
-          int Index = (x & 0xf);
-          auto pChild = _Buckets[Index].load();
-          x >>= 4;
-          return (pChild ? pChild->exists(intrinsic_cast(x)) : false);
+          epoch_domain::guard oGuard;
+          return nullptr != _find(Key);
+        }
+
+        /** concurrently search for an existing value
+        Removed values are retired to epoch_domain::global() so the returned pointer remains valid while the caller
+        holds an epoch_domain::guard taken before the call.
+        @param Key the key to search for
+        @returns pointer to the value or nullptr if the key does not exist
+        */
+        value_type * find(const key_type &Key) const {
+          epoch_domain::guard oGuard;
+          auto pEntry = _find(Key);
+          return (pEntry ? &pEntry->_value : nullptr);
         }
 
         /** concurrently remove a value
@@ -197,14 +800,34 @@ namespace xtd{
         @returns true if the item was removed
         */
         bool remove(const key_type &Key) {
-          auto x = intrinsic_cast(Key);
-          int Index = (x & 0xf);
-          auto pChild = _Buckets[Index].load();
-          if (pChild) {
-            x >>= 4;
-            return pChild->remove(intrinsic_cast(x));
-          }
-          return false;
+          epoch_domain::guard oGuard;
+          auto Hash = _Hash(Key);
+          auto pHead = _Root.slot(Hash, false);
+          if (!pHead) {
+            return false;
+          }
+          forever {
+            link *pPrev;
+            uintptr_t iHead;
+            auto pEntry = _search(*pHead, Hash, Key, pPrev, iHead);
+            if (!pEntry) {
+              return false;
+            }
+            auto iNext = pEntry->_next.load();
+            if ((iNext & _::hash_map::mark_bit) || !pEntry->_next.compare_exchange_strong(iNext, iNext | _::hash_map::mark_bit)) {
+              _Counters.add(_::hash_map::remove_failures);
+              continue;
+            }
+            // logically removed. unlink it here or let the next search that passes it do so
+            auto iEntry = reinterpret_cast<uintptr_t>(pEntry);
+            if (pPrev->compare_exchange_strong(iEntry, iNext)) {
+              _retire(pEntry);
+            } else {
+              _Counters.add(_::hash_map::unlink_failures);
+              _search(*pHead, Hash, Key, pPrev, iHead);
+            }
+            return true;
+          }
         }
 
         /** unsafe access an item by key
@@ -213,229 +836,221 @@ namespace xtd{
         @returns reference to the value
          */
         value_type &operator[](const key_type &Key) {
-          auto x = intrinsic_cast(Key);
-          int Index = (x & 0xf);
-          auto pChild = _Buckets[Index].load();
-          if (!pChild) {
-            insert(Key, value_type());
-            pChild = _Buckets[Index].load();
-          }
-          x >>= 4;
-          return pChild->operator[](intrinsic_cast(x));
+          epoch_domain::guard oGuard;
+          entry_type *pExisting = nullptr;
+          auto pEntry = _insert(Key, [&](hash_type Hash){ return new entry_type(Hash, Key); }, &pExisting);
+          return (pEntry ? pEntry : pExisting)->_value;
+        }
+
+        /** measures the memory and shape of the map and reads its contention counters
+        Walks the whole map without blocking writers
+        @returns the measurements
+        */
+        hash_map_stats stats() const {
+          epoch_domain::guard oGuard;
+          hash_map_stats oRet;
+          oRet.occupancy.resize(key_nibbles);
+          _Root.shape(oRet, 0);
+          oRet.arena_bytes = _Pool->bytes();
+          oRet.insert_cas_failures = _Counters.get(_::hash_map::insert_failures);
+          oRet.remove_cas_failures = _Counters.get(_::hash_map::remove_failures);
+          oRet.unlink_cas_failures = _Counters.get(_::hash_map::unlink_failures);
+          oRet.node_cas_failures = _Counters.get(_::hash_map::node_failures);
+          return oRet;
         }
 
-        /// unsafe get an iterator to the first element
+        /// get an iterator to the first element
         iterator_type begin() const {
-          std::vector<int8_t> oKey(iterator_type::key_nibbles, -1);
-          return iterator_type(this, _begin(&oKey[0]), oKey);
+          iterator_type oRet(this);
+          oRet._Current = _Root._begin(oRet._Key);
+          return oRet;
         }
 
-        /// unsafe get an iterator past the last element
+        /// get an iterator past the last element
         iterator_type end() const {
-          return iterator_type(this, nullptr, std::vector<int8_t>(iterator_type::key_nibbles, -1));
+          return iterator_type(this);
         }
 
-        /// unsafe get an iterator to the last element
+        /// get an iterator to the last element
         iterator_type back() const {
-          std::vector<int8_t> oKey(iterator_type::key_nibbles, -1);
-          return iterator_type(this, _back(&oKey[0]), oKey);
+          iterator_type oRet(this);
+          oRet._Current = _Root._back(oRet._Key);
+          return oRet;
         }
 
-      private:
-
-        value_type *_begin(int8_t *pKey) const {
-          child_bucket_type *pChildBucket;
-          for (*pKey = 0; *pKey < nibble_count; ++*pKey) {
-            value_type *pRet;
-            if ((pChildBucket = _Buckets[*pKey].load()) && (pRet = pChildBucket->_begin(1 + pKey))) {
-              return pRet;
-            }
-          }
-          return nullptr;
+        /** weakly consistent visit of every item
+        Writers are not blocked and the epoch is only pinned while one leaf of the trie is visited so a long scan does not
+        delay reclamation. fn may insert and remove items, including the item it is visiting.
+        @param fn callable invoked as fn(const key_type&, value_type&) for each item
+        */
+        template <typename _FnT>
+        void for_each(_FnT &&fn) const {
+          _Root.visit(fn);
         }
 
-        value_type *_back(int8_t *pKey) const {
-          child_bucket_type *pChildBucket;
-          for (*pKey = nibble_count - 1; *pKey >= 0; --*pKey) {
-            value_type *pRet;
-            if ((pChildBucket = _Buckets[*pKey].load()) && (pRet = pChildBucket->_back(1 + pKey))) {
-              return pRet;
+        /** weakly consistent visit of every item by several threads
+        The 16 top level buckets of the trie are shared among the threads. The calling thread is one of them.
+        @param fn callable invoked as fn(const key_type&, value_type&) for each item. invoked concurrently so must be thread-safe
+        @param iThreads number of threads to visit with. at most 16 are used
+        */
+        template <typename _FnT>
+        void parallel_for_each(_FnT &&fn, size_t iThreads = std::thread::hardware_concurrency()) const {
+          std::atomic<int8_t> iNext(0);
+          _parallel(std::min<size_t>(iThreads, bucket_count), [&](size_t) {
+            for (int8_t i; (i = iNext++) < bucket_count;) {
+              _Root.visit(fn, i, static_cast<int8_t>(1 + i));
             }
-          }
-          return nullptr;
+          });
         }
 
-        value_type *_next(int8_t *pKey) const {
-          child_bucket_type *pChildBucket;
-          if (*pKey < 0 || *pKey >= nibble_count) {
-            *pKey = 0;
-          }
-          for (; *pKey < nibble_count; ++*pKey) {
-            value_type *pRet;
-            if ((pChildBucket = _Buckets[*pKey].load()) && (pRet = pChildBucket->_next(1 + pKey))) {
-              return pRet;
-            }
-          }
-          *pKey = -1;
-          return nullptr;
-        }
+      private:
 
-        value_type *_prev(int8_t *pKey) const {
-          child_bucket_type *pChildBucket;
-          if (*pKey < 0 || *pKey >= nibble_count) {
-            *pKey = nibble_count - 1;
+        /// runs fn(thread_index) on iThreads threads including the calling thread
+        template <typename _FnT>
+        static void _parallel(size_t iThreads, _FnT &&fn) {
+          std::vector<std::future<void>> oThreads;
+          for (size_t i = 1; i < iThreads; ++i) {
+            oThreads.push_back(std::async(std::launch::async, [&fn, i]() { fn(i); }));
           }
-          for (; *pKey >= 0; --*pKey) {
-            value_type *pRet;
-            if ((pChildBucket = _Buckets[*pKey].load()) && (pRet = pChildBucket->_prev(1 + pKey))) {
-              return pRet;
-            }
+          fn(0);
+          for (auto &oThread : oThreads) {
+            oThread.get();
           }
-          *pKey = -1;
-          return nullptr;
         }
 
-      };
-
-#if (!DOXY_INVOKED)
-
-      template<typename _KeyT, typename _ValueT>
-      class hash_map<_KeyT, _ValueT, 1> {
-        template<typename, typename, int> friend
-        class hash_map;
-
-        static constexpr int nibble_pos = 1;
-        static constexpr int8_t nibble_count = 16;
-        std::atomic<_ValueT *> _Values[nibble_count];
-      public:
-        using _my_t = hash_map<_KeyT, _ValueT, 1>;
-        using value_type = _ValueT;
-        using key_type = _KeyT;
-
-
-        hash_map() {
-          for (auto &oItem : _Values) {
-            oItem.store(nullptr);
+        /// retires an unlinked entry to the epoch domain
+        void _retire(entry_type *pEntry) {
+          if (pEntry->_arena) {
+            epoch_domain::global().retire(new retired_entry{ pEntry, _Pool }, &retired_entry::release);
+          } else {
+            epoch_domain::global().retire(pEntry);
           }
         }
 
-        ~hash_map(){
-          for (int8_t i=0 ; i<nibble_count ; ++i){
-            auto pItem = _Values[i].load();
-            if (pItem){
-              delete pItem;
-            }
-          }
+        /// inserts a pair allocating the entry and any new trie nodes from an arena
+        template <typename _ValT>
+        bool _insert_arena(arena_type &oArena, const key_type &Key, _ValT &&Value) {
+          return nullptr != _insert(Key, [&](hash_type Hash) {
+            auto pRet = oArena.make<entry_type>(Hash, Key, std::forward<_ValT>(Value));
+            pRet->_arena = true;
+            return pRet;
+          }, nullptr, nullptr, &oArena);
         }
 
-        bool insert(const key_type &Key, value_type &&Value) {
-          auto x = intrinsic_cast(Key);
-          int Index = (x & 0xf);
-          auto pValue = _Values[Index].load();
-          if (pValue) {
-            return false;
-          }
-          pValue = new value_type(std::forward<value_type>(Value));
-          value_type *pNullValue = nullptr;
-          if (!_Values[Index].compare_exchange_strong(pNullValue, pValue)) {
-            delete pValue;
-            return false;
+        /** finds the entry of a key in a list unlinking removed entries it passes
+        @param oHead head of the list
+        @param pPrev receives the link that points to the returned entry
+        @param iHead receives the value of the head when the list was last found unchanged
+        @returns the entry or nullptr
+        */
+        entry_type *_search(link &oHead, hash_type Hash, const key_type &Key, link *&pPrev, uintptr_t &iHead) {
+          forever {
+            pPrev = &oHead;
+            iHead = oHead.load();
+            auto iCurrent = iHead;
+            bool bRestart = false;
+            while (auto pCurrent = entry_type::from_link(iCurrent)) {
+              auto iNext = pCurrent->_next.load();
+              if (iNext & _::hash_map::mark_bit) {
+                if (!pPrev->compare_exchange_strong(iCurrent, iNext & ~_::hash_map::mark_bit)) {
+                  _Counters.add(_::hash_map::unlink_failures);
+                  bRestart = true;
+                  break;
+                }
+                _retire(pCurrent);
+                iCurrent = iNext & ~_::hash_map::mark_bit;
+                if (pPrev == &oHead) {
+                  iHead = iCurrent;
+                }
+                continue;
+              }
+              if (Hash == pCurrent->_hash && Key == pCurrent->_key) {
+                return pCurrent;
+              }
+              pPrev = &pCurrent->_next;
+              iCurrent = iNext;
+            }
+            if (!bRestart) {
+              return nullptr;
+            }
           }
-          return true;
         }
 
-        bool remove(const key_type &Key) {
-          auto x = intrinsic_cast(Key);
-          int Index = (x & 0xf);
-          auto pVal = _Values[Index].load();
-          value_type *pNullValue = nullptr;
-          if (pVal && _Values[Index].compare_exchange_strong(pVal, pNullValue)) {
-            delete pVal;
-            return true;
+        entry_type *_find(const key_type &Key) const {
+          auto Hash = _Hash(Key);
+          auto pHead = const_cast<trie_type&>(_Root).slot(Hash, false);
+          if (!pHead) {
+            return nullptr;
           }
-          return false;
-        }
-
-        bool exists(const key_type &Key) const {
-          auto x = intrinsic_cast(Key);
-          int Index = (x & 0xf);
-          auto pVal = _Values[Index].load();
-          return (pVal ? true : false);
-        }
-
-        value_type &operator[](const key_type &Key) {
-          auto x = intrinsic_cast(Key);
-          int Index = (x & 0xf);
-          auto pRet = _Values[Index].load();
-          if (!pRet) {
-            pRet = new value_type;
-            value_type *pNull = nullptr;
-            if (!_Values[Index].compare_exchange_strong(pNull, pRet)) {
-              delete pRet;
-              pRet = _Values[Index].load();
-            }
-          }
-          XTD_ASSERT(pRet);
-          return *pRet;
-        }
-
-      private:
-
-        value_type *_begin(int8_t *pKey) const {
-          for (*pKey = 0; *pKey < nibble_count; ++*pKey) {
-            value_type *pRet;
-            if ((pRet = _Values[*pKey].load())) {
-              return pRet;
+          for (auto pEntry = entry_type::from_link(pHead->load()); pEntry; pEntry = entry_type::from_link(pEntry->_next.load())) {
+            if (Hash == pEntry->_hash && Key == pEntry->_key && !pEntry->removed()) {
+              return pEntry;
             }
           }
           return nullptr;
         }
 
-        value_type *_back(int8_t *pKey) const {
-          for (*pKey = nibble_count - 1; *pKey >= 0; --*pKey) {
-            value_type *pRet;
-            if ((pRet = _Values[*pKey].load())) {
-              return pRet;
+        /** pushes a new entry to the head of its list if the key is not already present
+        Entries are only ever added at the head so a key that is absent from a list is still absent if the head is unchanged.
+        @param oFactory creates the new entry from the hash. only invoked once the key is known to be absent and at most once
+        @param pUnused receives the new entry instead of deleting it if the key turns out to exist
+        @param pArena allocates any trie nodes that must be created when not null
+        @returns the new entry or nullptr if the key exists, in which case pExisting receives the existing entry
+        */
+        template <typename _FactoryT>
+        entry_type *_insert(const key_type &Key, _FactoryT&& oFactory, entry_type **pExisting, entry_type **pUnused = nullptr, arena_type *pArena = nullptr) {
+          auto Hash = _Hash(Key);
+          auto &oHead = *_Root.slot(Hash, true, pArena, &_Counters);
+          entry_type *pNew = nullptr;
+          forever {
+            link *pPrev;
+            uintptr_t iHead;
+            if (auto pEntry = _search(oHead, Hash, Key, pPrev, iHead)) {
+              if (pUnused && pNew) {
+                *pUnused = pNew;
+              } else if (pNew) {
+                entry_type::release(pNew);
+              }
+              if (pExisting) {
+                *pExisting = pEntry;
+              }
+              return nullptr;
+            }
+            if (!pNew) {
+              pNew = oFactory(Hash);
             }
+            pNew->_next.store(iHead);
+            if (oHead.compare_exchange_strong(iHead, reinterpret_cast<uintptr_t>(pNew))) {
+              return pNew;
+            }
+            _Counters.add(_::hash_map::insert_failures);
           }
-          return nullptr;
         }
 
-        value_type *_next(int8_t *pKey) const {
-          if (*pKey < 0 || *pKey >= nibble_count) {
-            *pKey = 0;
-          }
-          for (; *pKey < nibble_count; ++*pKey) {
-            value_type *pRet;
-            if ((pRet = _Values[*pKey].load())) {
+        entry_type *_next(int8_t *pKey, const entry_type *pCurrent) const {
+          if (pCurrent) {
+            if (auto pRet = entry_type::first(pCurrent->_next.load())) {
               return pRet;
             }
+            ++pKey[key_nibbles - 1];
           }
-          *pKey = -1;
-          return nullptr;
+          return _Root._next(pKey);
         }
 
-        value_type *_prev(int8_t *pKey) const {
-          if (*pKey < 0 || *pKey >= nibble_count) {
-            *pKey = nibble_count - 1;
-          }
-          for (; *pKey >= 0; --*pKey) {
-            value_type *pRet;
-            if ((pRet = _Values[*pKey].load())) {
+        entry_type *_prev(int8_t *pKey, const entry_type *pCurrent) const {
+          if (pCurrent) {
+            auto pHead = const_cast<trie_type&>(_Root).slot(pCurrent->_hash, false);
+            if (auto pRet = entry_type::last(pHead->load(), pCurrent)) {
               return pRet;
             }
+            --pKey[key_nibbles - 1];
           }
-          *pKey = -1;
-          return nullptr;
+          return _Root._prev(pKey);
         }
 
       };
-    }
-#endif
 
     ///@}
+  }
 
-
-  
 }
-
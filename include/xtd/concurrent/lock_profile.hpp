@@ -0,0 +1,269 @@
+/** @file
+opt-in contention profiling of the concurrent locks
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+The locks take a profile policy as a template parameter. null_lock_profile is the default and compiles to nothing.
+lock_profile counts the acquisitions of a lock, the spins and time spent waiting for it and the time it was held,
+in total and for each call site that acquired it. Every lock_profile is registered so the profiles of all locks in a
+process can be reported together, ordered by the time threads waited for them.
+*/
+#pragma once
+#include <xtd/xtd.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <xtd/source_location.hpp>
+
+namespace xtd{
+  namespace concurrent{
+
+    class lock_profile;
+
+#if (!DOXY_INVOKED)
+    namespace _{
+      namespace lock_profile{
+
+        using clock = std::chrono::steady_clock;
+
+        /// lock held by the calling thread
+        struct hold{
+          const xtd::concurrent::lock_profile * _profile;
+          clock::time_point _start;
+          const char * _file;
+          int _line;
+        };
+
+        /// locks held by the calling thread in the order they were acquired
+        inline std::vector<hold>& holds(){
+          static thread_local std::vector<hold> _holds;
+          return _holds;
+        }
+
+        /// every live lock_profile
+        struct registry{
+          std::mutex _lock;
+          std::vector<const xtd::concurrent::lock_profile*> _profiles;
+
+          static registry& instance(){
+            static registry _instance;
+            return _instance;
+          }
+        };
+
+      }
+    }
+#endif
+
+    /** @addtogroup Concurrent
+    @{*/
+
+    /// counters of a profiled lock or one of its call sites
+    struct lock_counters{
+      uint64_t acquisitions = 0; ///< successful lock calls
+      uint64_t contended = 0; ///< acquisitions that had to wait
+      uint64_t spins = 0; ///< times waiting threads invoked the wait policy
+      uint64_t wait_ns = 0; ///< total time spent waiting to acquire
+      uint64_t max_wait_ns = 0; ///< longest wait to acquire
+      uint64_t hold_ns = 0; ///< total time the lock was held
+      uint64_t max_hold_ns = 0; ///< longest time the lock was held
+
+      lock_counters& operator+=(const lock_counters& src){
+        acquisitions += src.acquisitions;
+        contended += src.contended;
+        spins += src.spins;
+        wait_ns += src.wait_ns;
+        max_wait_ns = std::max(max_wait_ns, src.max_wait_ns);
+        hold_ns += src.hold_ns;
+        max_hold_ns = std::max(max_hold_ns, src.max_hold_ns);
+        return *this;
+      }
+    };
+
+    /// counters of the acquisitions made at one source location
+    struct lock_site_stats{
+      std::string file;
+      int line = 0;
+      lock_counters counters;
+    };
+
+    /// snapshot of a lock_profile
+    struct lock_profile_stats{
+      std::string name;
+      lock_counters totals;
+      std::vector<lock_site_stats> sites; ///< ordered by descending wait time
+    };
+
+    /// profile policy of a lock that records nothing
+    class null_lock_profile{
+    public:
+      struct wait_token{};
+      FORCEINLINE wait_token begin_wait(){ return wait_token(); }
+      FORCEINLINE void spin(wait_token&){}
+      FORCEINLINE void acquired(wait_token&, const source_location&){}
+      FORCEINLINE void released(){}
+    };
+
+    /** profile policy of a lock that records its contention
+    Counters are updated under a mutex owned by the profile so profiling slows the lock down. Hold times are measured
+    from the acquisition to the release by the same thread, using a per-thread list of held locks.
+    */
+    class lock_profile{
+      using clock = _::lock_profile::clock;
+      using site_key = std::pair<const char*, int>;
+      struct site_less{
+        bool operator()(const site_key& lhs, const site_key& rhs) const{
+          if (lhs.first != rhs.first){
+            return std::less<const char*>()(lhs.first, rhs.first);
+          }
+          return lhs.second < rhs.second;
+        }
+      };
+
+    public:
+      struct wait_token{
+        clock::time_point _start;
+        uint64_t _spins;
+      };
+
+      explicit lock_profile(const char * sName = "lock") : _name(sName){
+        auto & oRegistry = _::lock_profile::registry::instance();
+        std::lock_guard<std::mutex> oLock(oRegistry._lock);
+        oRegistry._profiles.push_back(this);
+      }
+
+      lock_profile(const lock_profile& src) : lock_profile(src._name.c_str()){}
+      lock_profile& operator=(const lock_profile&){ return *this; }
+
+      ~lock_profile(){
+        auto & oRegistry = _::lock_profile::registry::instance();
+        std::lock_guard<std::mutex> oLock(oRegistry._lock);
+        oRegistry._profiles.erase(std::remove(oRegistry._profiles.begin(), oRegistry._profiles.end(), this), oRegistry._profiles.end());
+      }
+
+      /// name reported for the lock
+      void name(const std::string& sName){
+        std::lock_guard<std::mutex> oLock(_lock);
+        _name = sName;
+      }
+
+      wait_token begin_wait(){
+        return wait_token{ clock::now(), 0 };
+      }
+
+      void spin(wait_token& oToken){
+        ++oToken._spins;
+      }
+
+      void acquired(wait_token& oToken, const source_location& oWhere){
+        auto oNow = clock::now();
+        lock_counters oSample;
+        oSample.acquisitions = 1;
+        oSample.contended = (oToken._spins ? 1 : 0);
+        oSample.spins = oToken._spins;
+        oSample.wait_ns = oSample.max_wait_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(oNow - oToken._start).count());
+        {
+          std::lock_guard<std::mutex> oLock(_lock);
+          _totals += oSample;
+          _sites[site_key(oWhere.file(), oWhere.line())] += oSample;
+        }
+        _::lock_profile::holds().push_back(_::lock_profile::hold{ this, oNow, oWhere.file(), oWhere.line() });
+      }
+
+      void released(){
+        auto & oHolds = _::lock_profile::holds();
+        auto oHold = std::find_if(oHolds.rbegin(), oHolds.rend(), [this](const _::lock_profile::hold& oItem){ return this == oItem._profile; });
+        if (oHolds.rend() == oHold){
+          return;
+        }
+        lock_counters oSample;
+        oSample.hold_ns = oSample.max_hold_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - oHold->_start).count());
+        site_key oKey(oHold->_file, oHold->_line);
+        oHolds.erase(std::next(oHold).base());
+        std::lock_guard<std::mutex> oLock(_lock);
+        _totals += oSample;
+        _sites[oKey] += oSample;
+      }
+
+      /// snapshot of the counters
+      lock_profile_stats stats() const{
+        lock_profile_stats oRet;
+        std::lock_guard<std::mutex> oLock(_lock);
+        oRet.name = _name;
+        oRet.totals = _totals;
+        for (auto & oSite : _sites){
+          // the same file may be named by different string literals in different translation units
+          auto oExisting = std::find_if(oRet.sites.begin(), oRet.sites.end(), [&oSite](const lock_site_stats& oItem){
+            return oItem.line == oSite.first.second && oItem.file == oSite.first.first;
+          });
+          if (oRet.sites.end() == oExisting){
+            oRet.sites.push_back(lock_site_stats{ oSite.first.first, oSite.first.second, oSite.second });
+          } else{
+            oExisting->counters += oSite.second;
+          }
+        }
+        std::sort(oRet.sites.begin(), oRet.sites.end(), [](const lock_site_stats& lhs, const lock_site_stats& rhs){ return lhs.counters.wait_ns > rhs.counters.wait_ns; });
+        return oRet;
+      }
+
+      /// zeroes the counters
+      void reset(){
+        std::lock_guard<std::mutex> oLock(_lock);
+        _totals = lock_counters();
+        _sites.clear();
+      }
+
+      /// writes the counters of the lock and each of its call sites
+      void report(std::ostream& oOut) const{
+        write(oOut, stats());
+      }
+
+      /// writes the profiles of every profiled lock in the process ordered by descending wait time
+      static void report_all(std::ostream& oOut){
+        std::vector<lock_profile_stats> oStats;
+        {
+          auto & oRegistry = _::lock_profile::registry::instance();
+          std::lock_guard<std::mutex> oLock(oRegistry._lock);
+          for (auto pProfile : oRegistry._profiles){
+            oStats.push_back(pProfile->stats());
+          }
+        }
+        std::sort(oStats.begin(), oStats.end(), [](const lock_profile_stats& lhs, const lock_profile_stats& rhs){ return lhs.totals.wait_ns > rhs.totals.wait_ns; });
+        for (auto & oItem : oStats){
+          write(oOut, oItem);
+        }
+      }
+
+      /// writes a snapshot of a profile
+      static void write(std::ostream& oOut, const lock_profile_stats& oStats){
+        auto counters = [&oOut](const lock_counters& oCounters){
+          oOut << "acquisitions " << oCounters.acquisitions << " contended " << oCounters.contended << " spins " << oCounters.spins
+            << " wait ns " << oCounters.wait_ns << " (max " << oCounters.max_wait_ns << ")"
+            << " hold ns " << oCounters.hold_ns << " (max " << oCounters.max_hold_ns << ")" << std::endl;
+        };
+        oOut << oStats.name << ": ";
+        counters(oStats.totals);
+        for (auto & oSite : oStats.sites){
+          oOut << "  " << oSite.file << ":" << oSite.line << ": ";
+          counters(oSite.counters);
+        }
+      }
+
+    private:
+      mutable std::mutex _lock;
+      std::string _name;
+      lock_counters _totals;
+      std::map<site_key, lock_counters, site_less> _sites;
+    };
+
+    ///@}
+  }
+}
@@ -0,0 +1,495 @@
+/** @file
+concurrent least recently used cache partitioned into independently locked shards
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+A key belongs to one shard chosen by its hash. Each shard indexes its entries with an open addressing table of atomic
+entry pointers and keeps them in a recency list. Readers probe the table inside an epoch_domain::guard and never take
+a lock. A hit cannot relink the entry without the lock, so it is recorded in a small buffer of the shard instead and
+the buffered hits are applied in one batch by whichever thread next holds the shard lock: a writer before it evicts,
+or the reader that fills the buffer if the lock happens to be free. The buffer is lossy, so under heavy load some hits
+are not counted and recency is approximate.
+
+Entries are never modified once published. Replacing or evicting an entry unlinks it and retires it to the epoch
+domain of the cache, which destroys the key and value and returns the entry to the shard once no reader can hold it.
+Entry memory is only freed with the cache, so a buffered hit never refers to freed memory.
+
+get_or_load records the keys it is loading in a table of the shard. A thread that misses on a key found there waits
+on the shared future of that load, so a burst of misses on a cold key calls the loader once.
+*/
+#pragma once
+#include <xtd/xtd.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <xtd/lru_cache.hpp>
+#include <xtd/concurrent/epoch_domain.hpp>
+#include <xtd/concurrent/spin_lock.hpp>
+#include <xtd/concurrent/striped_counter.hpp>
+#include <xtd/concurrent/wait_policy.hpp>
+
+namespace xtd{
+  namespace concurrent{
+
+    /** @addtogroup Concurrent
+    @{*/
+
+    /** A thread safe least recently used cache
+    Lookups of cached keys are lock-free. Inserts, replacements and evictions lock only the shard of the key. Values are
+    returned by copy since another thread may evict the entry at any time.
+    @tparam _KeyT key type
+    @tparam _ValueT cached value type
+    @tparam _HashT hash of the keys
+    @tparam _ShardCount number of shards. a power of 2
+    */
+    template <typename _KeyT, typename _ValueT, typename _HashT = std::hash<_KeyT>, size_t _ShardCount = 16>
+    class lru_cache{
+      static_assert(_ShardCount && !(_ShardCount & (_ShardCount - 1)), "shard count must be a power of 2");
+
+      struct shard;
+
+      struct entry : xtd::_::lru_cache::link{
+        explicit entry(shard * pShard = nullptr) : _shard(pShard){}
+        std::optional<std::pair<const _KeyT, _ValueT>> _item;
+        uint64_t _hash = 0;
+        bool _linked = false; ///< in the recency list and table. only accessed under the shard lock
+        shard * const _shard;
+        entry * _free_next = nullptr;
+      };
+
+      struct table{
+        explicit table(size_t iSize) : _mask(iSize - 1), _slots(new std::atomic<entry*>[iSize]){
+          for (size_t i = 0; i < iSize; ++i){
+            _slots[i].store(nullptr, std::memory_order_relaxed);
+          }
+        }
+        size_t size() const{ return 1 + _mask; }
+        const size_t _mask;
+        std::unique_ptr<std::atomic<entry*>[]> _slots;
+      };
+
+      using lock_type = spin_lock_base<adaptive_wait_policy>;
+      using scope_locker = typename lock_type::scope_locker;
+
+    public:
+      using key_type = _KeyT;
+      using value_type = _ValueT;
+      static constexpr size_t shard_count = _ShardCount;
+      /// hits buffered by each shard before they are applied to its recency list
+      static constexpr size_t read_buffer_size = 32;
+
+      /// @param iCapacity maximum number of cached values. spread evenly over the shards so rounded up to a multiple of the shard count
+      explicit lru_cache(size_t iCapacity){
+        auto iShardCapacity = std::max<size_t>(1, (iCapacity + _ShardCount - 1) / _ShardCount);
+        size_t iTableSize = 8;
+        while (iTableSize < 2 * iShardCapacity){
+          iTableSize <<= 1;
+        }
+        for (auto & oShard : _shards){
+          oShard._capacity = iShardCapacity;
+          oShard._table.store(new table(iTableSize));
+        }
+      }
+      lru_cache(const lru_cache&) = delete;
+      lru_cache& operator=(const lru_cache&) = delete;
+
+      /// maximum number of cached values
+      size_t capacity() const{ return _ShardCount * _shards[0]._capacity; }
+
+      /// number of cached values. approximate while other threads modify the cache
+      size_t size() const{
+        size_t iRet = 0;
+        for (auto & oShard : _shards){
+          iRet += oShard._size.load(std::memory_order_relaxed);
+        }
+        return iRet;
+      }
+
+      /// returns a copy of the cached value of key or an empty optional
+      std::optional<_ValueT> find(const _KeyT& key){
+        std::optional<_ValueT> oRet;
+        visit(key, [&oRet](const _ValueT& oValue){ oRet.emplace(oValue); });
+        return oRet;
+      }
+
+      /** calls fn with the cached value of key without copying it
+      The value stays valid until fn returns even if another thread evicts it. fn should not modify the cache.
+      @returns false if key is not cached
+      */
+      template <typename _FnT>
+      bool visit(const _KeyT& key, _FnT&& fn){
+        auto iHash = _hash(key);
+        auto & oShard = _shard(iHash);
+        epoch_domain::guard oGuard(_epoch);
+        auto pEntry = _lookup(*oShard._table.load(std::memory_order_acquire), iHash, key);
+        if (!pEntry){
+          _counters.add(miss_counter);
+          return false;
+        }
+        fn(static_cast<const _ValueT&>(pEntry->_item->second));
+        _counters.add(hit_counter);
+        _record_hit(oShard, pEntry);
+        return true;
+      }
+
+      /** returns the value of key, caching loader(key) if it is not cached
+      The loader runs without a lock. Threads that miss on a key while it is being loaded wait for that load instead of
+      calling the loader again and receive its value or exception. If another thread caches key with insert or
+      insert_or_assign during the load, the cached value is kept and returned.
+      */
+      template <typename _LoaderT>
+      _ValueT get_or_load(const _KeyT& key, _LoaderT&& loader){
+        if (auto oValue = find(key)){
+          return std::move(*oValue);
+        }
+        auto iHash = _hash(key);
+        auto & oShard = _shard(iHash);
+        flight oFlight(iHash, key);
+        std::shared_future<_ValueT> oLoading;
+        {
+          scope_locker oLock(oShard._lock);
+          if (auto pEntry = _lookup(*oShard._table.load(std::memory_order_relaxed), iHash, key)){
+            return pEntry->_item->second;
+          }
+          auto oLoader = std::find_if(oShard._loading.begin(), oShard._loading.end(), [&](flight * pLoading){
+            return iHash == pLoading->_hash && key == pLoading->_key;
+          });
+          if (oShard._loading.end() == oLoader){
+            oShard._loading.push_back(&oFlight);
+          } else{
+            // the promise is only made when a second thread misses on the key
+            auto & oPromise = (*oLoader)->_promise;
+            if (!oPromise){
+              oPromise.emplace();
+              (*oLoader)->_result = oPromise->get_future().share();
+            }
+            oLoading = (*oLoader)->_result;
+          }
+        }
+        if (oLoading.valid()){
+          return oLoading.get();
+        }
+        std::optional<_ValueT> oRet;
+        auto oStart = std::chrono::steady_clock::now();
+        try{
+          _ValueT oLoaded = loader(key);
+          _counters.add(load_time_counter, _elapsed_nanoseconds(oStart));
+          _counters.add(load_counter);
+          scope_locker oLock(oShard._lock);
+          _land(oShard, oFlight);
+          auto pEntry = _lookup(*oShard._table.load(std::memory_order_relaxed), iHash, key);
+          if (!pEntry){
+            pEntry = _insert(oShard, iHash, key, std::move(oLoaded));
+          }
+          oRet.emplace(pEntry->_item->second);
+        } catch (...){
+          _counters.add(load_time_counter, _elapsed_nanoseconds(oStart));
+          _counters.add(load_failure_counter);
+          {
+            scope_locker oLock(oShard._lock);
+            _land(oShard, oFlight);
+          }
+          if (oFlight._promise){
+            oFlight._promise->set_exception(std::current_exception());
+          }
+          throw;
+        }
+        if (oFlight._promise){
+          oFlight._promise->set_value(*oRet);
+        }
+        return std::move(*oRet);
+      }
+
+      /** caches a value if key is not cached
+      @returns false if key was already cached
+      */
+      bool insert(const _KeyT& key, _ValueT oValue){
+        auto iHash = _hash(key);
+        auto & oShard = _shard(iHash);
+        scope_locker oLock(oShard._lock);
+        if (_lookup(*oShard._table.load(std::memory_order_relaxed), iHash, key)){
+          return false;
+        }
+        _insert(oShard, iHash, key, std::move(oValue));
+        return true;
+      }
+
+      /** caches a value replacing any cached value of key
+      @returns true if the value was inserted and false if it replaced a cached value
+      */
+      bool insert_or_assign(const _KeyT& key, _ValueT oValue){
+        auto iHash = _hash(key);
+        auto & oShard = _shard(iHash);
+        scope_locker oLock(oShard._lock);
+        bool bRet = !_erase(oShard, iHash, key);
+        _insert(oShard, iHash, key, std::move(oValue));
+        return bRet;
+      }
+
+      /// removes key from the cache. returns false if it was not cached
+      bool erase(const _KeyT& key){
+        auto iHash = _hash(key);
+        auto & oShard = _shard(iHash);
+        scope_locker oLock(oShard._lock);
+        return _erase(oShard, iHash, key);
+      }
+
+      /// hit, miss and load counters. approximate while other threads use the cache
+      cache_stats stats() const{
+        cache_stats oRet;
+        oRet.hits = _counters.get(hit_counter);
+        oRet.misses = _counters.get(miss_counter);
+        oRet.evictions = _counters.get(eviction_counter);
+        oRet.loads = _counters.get(load_counter);
+        oRet.load_failures = _counters.get(load_failure_counter);
+        oRet.load_time = std::chrono::nanoseconds(_counters.get(load_time_counter));
+        return oRet;
+      }
+
+      /// removes every cached value
+      void clear(){
+        for (auto & oShard : _shards){
+          scope_locker oLock(oShard._lock);
+          _drain(oShard);
+          while (oShard._recent._prev != &oShard._recent){
+            _remove(oShard, static_cast<entry*>(oShard._recent._prev));
+          }
+        }
+      }
+
+    private:
+      enum counter{
+        hit_counter,
+        miss_counter,
+        eviction_counter,
+        load_counter,
+        load_failure_counter,
+        load_time_counter,
+        counter_count,
+      };
+
+      /// a load in progress that other threads missing on the same key wait for. lives on the stack of the loading thread
+      struct flight{
+        flight(uint64_t iHash, const _KeyT& key) : _hash(iHash), _key(key){}
+        const uint64_t _hash;
+        const _KeyT& _key;
+        std::optional<std::promise<_ValueT>> _promise;
+        std::shared_future<_ValueT> _result;
+      };
+
+      struct alignas(64) shard{
+        shard() = default;
+        shard(const shard&) = delete;
+        ~shard(){
+          delete _table.load();
+        }
+
+        lock_type _lock;
+        std::atomic<table*> _table{nullptr};
+        xtd::_::lru_cache::link _recent; ///< _next is the most and _prev the least recently used entry
+        std::atomic<size_t> _size{0};
+        size_t _tombstones = 0;
+        size_t _capacity = 1;
+        entry * _free = nullptr; ///< entries ready for reuse. only accessed under the lock
+        std::atomic<entry*> _recycled{nullptr}; ///< entries returned by the epoch domain
+        std::vector<std::unique_ptr<entry>> _owned;
+        std::vector<flight*> _loading; ///< loads in progress. short so searched linearly
+        alignas(64) std::atomic<uint32_t> _reads{0};
+        std::atomic<entry*> _read_buffer[read_buffer_size] = {};
+
+        /// returns a reclaimed entry. called by the epoch domain on any thread
+        void recycle(entry * pEntry){
+          auto pHead = _recycled.load(std::memory_order_relaxed);
+          do{
+            pEntry->_free_next = pHead;
+          } while (!_recycled.compare_exchange_weak(pHead, pEntry, std::memory_order_release, std::memory_order_relaxed));
+        }
+      };
+
+      static entry * _tombstone(){
+        static entry _instance;
+        return &_instance;
+      }
+
+      static uint64_t _elapsed_nanoseconds(std::chrono::steady_clock::time_point oStart){
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - oStart).count());
+      }
+
+      /// removes a load from the loads in progress. waiting threads have copied its future so it isn't referenced afterwards
+      static void _land(shard& oShard, flight& oFlight){
+        auto oItem = std::find(oShard._loading.begin(), oShard._loading.end(), &oFlight);
+        if (oShard._loading.end() != oItem){
+          *oItem = oShard._loading.back();
+          oShard._loading.pop_back();
+        }
+      }
+
+      static uint64_t _hash(const _KeyT& key){
+        return static_cast<uint64_t>(_HashT()(key)) * 0x9E3779B97F4A7C15ULL;
+      }
+
+      shard& _shard(uint64_t iHash){
+        return _shards[(iHash >> 48) & (_ShardCount - 1)];
+      }
+
+      static entry * _lookup(const table& oTable, uint64_t iHash, const _KeyT& key){
+        for (auto i = static_cast<size_t>(iHash) & oTable._mask;; i = (1 + i) & oTable._mask){
+          auto pEntry = oTable._slots[i].load(std::memory_order_acquire);
+          if (!pEntry){
+            return nullptr;
+          }
+          if (_tombstone() != pEntry && iHash == pEntry->_hash && key == pEntry->_item->first){
+            return pEntry;
+          }
+        }
+      }
+
+      void _record_hit(shard& oShard, entry * pEntry){
+        auto iRead = oShard._reads.fetch_add(1, std::memory_order_relaxed);
+        if (iRead < read_buffer_size){
+          oShard._read_buffer[iRead].store(pEntry, std::memory_order_release);
+          if (1 + iRead < read_buffer_size){
+            return;
+          }
+        }
+        // the buffer is full. apply it if no other thread holds the lock otherwise further hits are dropped until it is drained
+        if (oShard._lock.try_lock()){
+          _drain(oShard);
+          oShard._lock.unlock();
+        }
+      }
+
+      /// applies buffered hits to the recency list. called under the shard lock
+      static void _drain(shard& oShard){
+        auto iReads = std::min<size_t>(read_buffer_size, oShard._reads.load(std::memory_order_relaxed));
+        for (size_t i = 0; i < iReads; ++i){
+          auto pEntry = oShard._read_buffer[i].load(std::memory_order_acquire);
+          oShard._read_buffer[i].store(nullptr, std::memory_order_relaxed);
+          // the entry may have been evicted or even reused for another key since the hit, which only costs accuracy
+          if (pEntry && pEntry->_linked){
+            pEntry->unlink();
+            pEntry->link_after(oShard._recent);
+          }
+        }
+        oShard._reads.store(0, std::memory_order_relaxed);
+      }
+
+      entry * _allocate(shard& oShard){
+        if (!oShard._free){
+          oShard._free = oShard._recycled.exchange(nullptr, std::memory_order_acquire);
+        }
+        if (oShard._free){
+          auto pRet = oShard._free;
+          oShard._free = pRet->_free_next;
+          return pRet;
+        }
+        oShard._owned.emplace_back(new entry(&oShard));
+        return oShard._owned.back().get();
+      }
+
+      static void _reclaim(void * pObject){
+        auto pEntry = static_cast<entry*>(pObject);
+        pEntry->_item.reset();
+        pEntry->_shard->recycle(pEntry);
+      }
+
+      /// links a new entry and evicts the least recently used entry if the shard is over capacity. called under the shard lock
+      entry * _insert(shard& oShard, uint64_t iHash, const _KeyT& key, _ValueT&& oValue){
+        auto pTable = oShard._table.load(std::memory_order_relaxed);
+        if (4 * (1 + oShard._size.load(std::memory_order_relaxed) + oShard._tombstones) > 3 * pTable->size()){
+          pTable = _rebuild(oShard);
+        }
+        auto pEntry = _allocate(oShard);
+        try{
+          pEntry->_item.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::move(oValue)));
+        } catch (...){
+          pEntry->_free_next = oShard._free;
+          oShard._free = pEntry;
+          throw;
+        }
+        pEntry->_hash = iHash;
+        pEntry->_linked = true;
+        pEntry->link_after(oShard._recent);
+        for (auto i = static_cast<size_t>(iHash) & pTable->_mask;; i = (1 + i) & pTable->_mask){
+          auto pSlot = pTable->_slots[i].load(std::memory_order_relaxed);
+          if (!pSlot || _tombstone() == pSlot){
+            if (pSlot){
+              --oShard._tombstones;
+            }
+            pTable->_slots[i].store(pEntry, std::memory_order_release);
+            break;
+          }
+        }
+        oShard._size.fetch_add(1, std::memory_order_relaxed);
+        if (oShard._size.load(std::memory_order_relaxed) > oShard._capacity){
+          _drain(oShard);
+          _remove(oShard, static_cast<entry*>(oShard._recent._prev));
+          _counters.add(eviction_counter);
+        }
+        return pEntry;
+      }
+
+      bool _erase(shard& oShard, uint64_t iHash, const _KeyT& key){
+        auto pEntry = _lookup(*oShard._table.load(std::memory_order_relaxed), iHash, key);
+        if (!pEntry){
+          return false;
+        }
+        _remove(oShard, pEntry);
+        return true;
+      }
+
+      /// unlinks an entry from the table and recency list and retires it. called under the shard lock
+      void _remove(shard& oShard, entry * pEntry){
+        auto pTable = oShard._table.load(std::memory_order_relaxed);
+        for (auto i = static_cast<size_t>(pEntry->_hash) & pTable->_mask;; i = (1 + i) & pTable->_mask){
+          if (pEntry == pTable->_slots[i].load(std::memory_order_relaxed)){
+            pTable->_slots[i].store(_tombstone(), std::memory_order_release);
+            ++oShard._tombstones;
+            break;
+          }
+        }
+        pEntry->unlink();
+        pEntry->_linked = false;
+        oShard._size.fetch_sub(1, std::memory_order_relaxed);
+        _epoch.retire(pEntry, &_reclaim);
+      }
+
+      /// replaces a table clogged with tombstones. readers still probing the old table finish before it is deleted
+      table * _rebuild(shard& oShard){
+        auto pOld = oShard._table.load(std::memory_order_relaxed);
+        auto pNew = new table(pOld->size());
+        for (size_t i = 0; i < pOld->size(); ++i){
+          auto pEntry = pOld->_slots[i].load(std::memory_order_relaxed);
+          if (!pEntry || _tombstone() == pEntry){
+            continue;
+          }
+          for (auto j = static_cast<size_t>(pEntry->_hash) & pNew->_mask;; j = (1 + j) & pNew->_mask){
+            if (!pNew->_slots[j].load(std::memory_order_relaxed)){
+              pNew->_slots[j].store(pEntry, std::memory_order_relaxed);
+              break;
+            }
+          }
+        }
+        oShard._table.store(pNew, std::memory_order_release);
+        oShard._tombstones = 0;
+        _epoch.retire(pOld);
+        return pNew;
+      }
+
+      shard _shards[_ShardCount];
+      striped_counter<counter_count> _counters;
+      /// declared last so it is destroyed first and returns the entries it still holds while the shards exist
+      epoch_domain _epoch;
+    };
+
+    ///@}
+  }
+}
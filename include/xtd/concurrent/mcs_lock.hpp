@@ -0,0 +1,141 @@
+/** @file
+fair queue lock where each waiter spins on its own cache line
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+The lock is the tail of a queue of waiter nodes. A thread swaps its node into the tail, links itself behind the
+previous tail and waits on a flag in its own node. The owner hands the lock to its successor by clearing the
+successor's flag, so a release touches one other cache line no matter how many threads wait.
+*/
+#pragma once
+
+#include <xtd/concurrent/wait_policy.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace xtd{
+  namespace concurrent{
+
+#if (!DOXY_INVOKED)
+    namespace _{
+      namespace mcs_lock{
+
+        struct alignas(64) node{
+          std::atomic<node*> _next;
+          std::atomic<uint32_t> _waiting;
+        };
+
+        /** nodes of the calling thread that are not queued on a lock
+        A thread needs one node for each MCS lock it holds or waits for at once. Nodes are reused and freed when the
+        thread exits, by which time no other thread can reference them.
+        */
+        class thread_nodes{
+          std::vector<std::unique_ptr<node>> _owned;
+          std::vector<node*> _free;
+        public:
+          node * acquire(){
+            if (_free.empty()){
+              _owned.emplace_back(new node);
+              return _owned.back().get();
+            }
+            auto pRet = _free.back();
+            _free.pop_back();
+            return pRet;
+          }
+          void release(node * pNode){
+            _free.push_back(pNode);
+          }
+          static thread_nodes& instance(){
+            static thread_local thread_nodes _instance;
+            return _instance;
+          }
+        };
+
+      }
+    }
+#endif
+
+    /** A single owner queue lock granted in arrival order
+    Waiters spin on a flag in their own node instead of a shared word, so contention does not grow the coherence
+    traffic of the lock. Nodes come from a per-thread list so the lock is used like any other lock with lock, unlock
+    and scope_locker. The lock must be released by the thread that acquired it.
+    @tparam _WaitPolicyT behavior while waiting for the predecessor to hand over the lock
+    */
+    template <typename _WaitPolicyT = null_wait_policy>
+    class mcs_lock_base{
+      using node = _::mcs_lock::node;
+      alignas(64) std::atomic<node*> _tail;
+      node * _owner; ///< node of the owning thread. only accessed while holding the lock
+      _WaitPolicyT _WaitPolicy;
+    public:
+      using wait_policy_type = _WaitPolicyT;
+      using scope_locker = xtd::concurrent::scope_locker<mcs_lock_base<_WaitPolicyT>>;
+
+      ~mcs_lock_base() = default;
+      mcs_lock_base(wait_policy_type oWait = wait_policy_type()) : _tail(nullptr), _owner(nullptr), _WaitPolicy(oWait){}
+      mcs_lock_base(const mcs_lock_base&) = delete;
+      mcs_lock_base(mcs_lock_base&&) = delete;
+
+      ///Acquires the lock
+      void lock(){
+        auto pNode = _prepare();
+        auto pPrevious = _tail.exchange(pNode, std::memory_order_acq_rel);
+        if (pPrevious){
+          pNode->_waiting.store(1, std::memory_order_relaxed);
+          pPrevious->_next.store(pNode, std::memory_order_release);
+          while (pNode->_waiting.load(std::memory_order_acquire)){
+            _::wait::wait(_WaitPolicy, pNode->_waiting, 1);
+          }
+        }
+        _owner = pNode;
+      }
+      /// Releases the lock to the next waiter
+      void unlock(){
+        auto pNode = _owner;
+        auto pNext = pNode->_next.load(std::memory_order_acquire);
+        if (!pNext){
+          auto pExpected = pNode;
+          if (_tail.compare_exchange_strong(pExpected, nullptr, std::memory_order_release, std::memory_order_relaxed)){
+            _::mcs_lock::thread_nodes::instance().release(pNode);
+            return;
+          }
+          // a waiter swapped itself into the tail and is about to link behind this node
+          while (!(pNext = pNode->_next.load(std::memory_order_acquire))){
+            _::wait::pause();
+          }
+        }
+        pNext->_waiting.store(0, std::memory_order_release);
+        _::wait::notify(_WaitPolicy, pNext->_waiting, false);
+        _::mcs_lock::thread_nodes::instance().release(pNode);
+      }
+      /** Attempts to acquire the lock
+      @return true if the lock was acquired
+      */
+      bool try_lock(){
+        if (_tail.load(std::memory_order_relaxed)){
+          return false;
+        }
+        auto pNode = _prepare();
+        node * pExpected = nullptr;
+        if (!_tail.compare_exchange_strong(pExpected, pNode, std::memory_order_acquire, std::memory_order_relaxed)){
+          _::mcs_lock::thread_nodes::instance().release(pNode);
+          return false;
+        }
+        _owner = pNode;
+        return true;
+      }
+
+    private:
+      static node * _prepare(){
+        auto pNode = _::mcs_lock::thread_nodes::instance().acquire();
+        pNode->_next.store(nullptr, std::memory_order_relaxed);
+        pNode->_waiting.store(0, std::memory_order_relaxed);
+        return pNode;
+      }
+    };
+
+    using mcs_lock = mcs_lock_base<null_wait_policy>;
+  }
+}
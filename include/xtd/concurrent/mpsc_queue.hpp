@@ -0,0 +1,166 @@
+/** @file
+many threads push and a single thread pops items from an unbounded FIFO queue
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+The queue is a singly linked list that always holds a stub node at the front. A producer swaps its node into the back
+with a single atomic exchange then links the previous back node to it, so pushes never retry. The consumer reads past
+the stub and the node holding the popped item becomes the new stub. Between the exchange and the link the chain is
+briefly broken and the consumer sees the queue as ending at the break.
+
+Nodes come from the chunked pool of pooled_stack. Producers take nodes from their thread cache and the consumer
+returns popped nodes to its own, which hands batches back to the shared free list, so steady state pushes and pops
+never touch the heap.
+*/
+
+#pragma once
+#include <xtd/xtd.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include <xtd/concurrent/pooled_stack.hpp>
+#include <xtd/concurrent/wait_policy.hpp>
+
+namespace xtd{
+
+  namespace concurrent{
+    /** @addtogroup Concurrent
+    @{*/
+
+    /** An unbounded multi-producer single-consumer FIFO queue
+    Pushes are a single atomic exchange and never wait for other producers. Only one thread at a time may pop.
+    Items pushed by a single producer are popped in the order they were pushed.
+    @tparam _ValueT type of value contained in the queue. Must be move constructible.
+    @tparam _WaitPolicyT policy invoked while pop waits for an item
+    */
+    template <typename _ValueT, typename _WaitPolicyT = null_wait_policy>
+    class mpsc_queue{
+      using pool_type = _::pooled_stack::pool<_ValueT>;
+      using cache_type = _::pooled_stack::thread_cache;
+
+    public:
+      using value_type = _ValueT;
+      using wait_policy_type = _WaitPolicyT;
+
+      mpsc_queue(wait_policy_type oWait = wait_policy_type()) : _pool(std::make_shared<pool_type>()), _wait_policy(oWait){
+        _tail = _pool->acquire(_cache());
+        _pool->at(_tail)._next.store(0, std::memory_order_relaxed);
+        _head.store(_tail);
+      }
+
+      ~mpsc_queue(){
+        for (auto iIndex = _pool->at(_tail)._next.load(); iIndex;){
+          auto & oNode = _pool->at(iIndex);
+          oNode.value()->~value_type();
+          iIndex = oNode._next.load();
+        }
+      }
+
+      mpsc_queue(const mpsc_queue&) = delete;
+      mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+      void push(const value_type& value){
+        emplace(value);
+      }
+
+      void push(value_type&& value){
+        emplace(std::move(value));
+      }
+
+      /// constructs an item at the back of the queue. may be called by any thread
+      template <typename ... _ArgTs>
+      void emplace(_ArgTs&&...oArgs){
+        auto & oCache = _cache();
+        auto iIndex = _pool->acquire(oCache);
+        auto & oNode = _pool->at(iIndex);
+        try{
+          new (oNode.value()) value_type(std::forward<_ArgTs>(oArgs)...);
+        } catch (...){
+          _pool->recycle(oCache, iIndex);
+          throw;
+        }
+        oNode._next.store(0, std::memory_order_relaxed);
+        auto iPrevious = _head.exchange(iIndex, std::memory_order_acq_rel);
+        _pool->at(iPrevious)._next.store(iIndex, std::memory_order_release);
+      }
+
+      /// pops the item at the front of the queue. must only be called by the consumer thread
+      bool try_pop(value_type& oRet){
+        auto iNext = _pool->at(_tail)._next.load(std::memory_order_acquire);
+        if (!iNext){
+          return false;
+        }
+        auto pValue = _pool->at(iNext).value();
+        oRet = std::move(*pValue);
+        pValue->~value_type();
+        _advance(_cache(), iNext);
+        return true;
+      }
+
+      /// pops the item at the front of the queue waiting until one is pushed. must only be called by the consumer thread
+      value_type pop(){
+        uint32_t iNext;
+        while (!(iNext = _pool->at(_tail)._next.load(std::memory_order_acquire))){
+          _wait_policy();
+        }
+        auto pValue = _pool->at(iNext).value();
+        value_type oRet(std::move(*pValue));
+        pValue->~value_type();
+        _advance(_cache(), iNext);
+        return oRet;
+      }
+
+      /** pops every item that is linked into the queue. must only be called by the consumer thread
+      Items whose producers have not finished linking them remain for a later pop.
+      @param oOut output iterator receiving the items from the front of the queue
+      @returns number of items popped
+      */
+      template <typename _OutputIteratorT>
+      size_t pop_all(_OutputIteratorT oOut){
+        auto & oCache = _cache();
+        size_t iRet = 0;
+        for (auto iNext = _pool->at(_tail)._next.load(std::memory_order_acquire); iNext; ++iRet){
+          auto pValue = _pool->at(iNext).value();
+          *oOut++ = std::move(*pValue);
+          pValue->~value_type();
+          _advance(oCache, iNext);
+          iNext = _pool->at(_tail)._next.load(std::memory_order_acquire);
+        }
+        return iRet;
+      }
+
+      /// true if the queue has no linked items. only exact when called by the consumer thread while no producer is pushing
+      bool empty() const{
+        return !_pool->at(_tail)._next.load(std::memory_order_acquire);
+      }
+
+      /// number of nodes allocated by the queue
+      size_t capacity() const{
+        return _pool->capacity();
+      }
+
+    private:
+
+      cache_type::entry& _cache(){
+        return cache_type::instance().get(_pool);
+      }
+
+      /// the node of the popped item becomes the stub and the previous stub is recycled
+      void _advance(cache_type::entry& oCache, uint32_t iNext){
+        auto iStub = _tail;
+        _tail = iNext;
+        _pool->recycle(oCache, iStub);
+      }
+
+      std::shared_ptr<pool_type> _pool;
+      alignas(64) std::atomic<uint32_t> _head;
+      alignas(64) uint32_t _tail;
+      wait_policy_type _wait_policy;
+    };
+
+    ///@}
+  }
+}
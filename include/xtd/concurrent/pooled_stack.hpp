@@ -0,0 +1,432 @@
+/** @file
+concurrently push and pop items in a FILO stack that recycles its nodes instead of allocating them
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+Nodes are allocated in chunks that live as long as the stack and are addressed by 32 bit indices. The head of the
+stack packs the index of the top node with a 32 bit tag that changes on every update, so a pop that read a stale head
+fails its CAS even if the same node has returned to the top (ABA). Chunks are never freed so a pop can always read
+the next index of a node that another thread popped first.
+
+Popped nodes are kept in a small per-thread cache. A full cache hands a batch of nodes to a shared free list and an
+empty cache takes a batch back, so steady state pushes and pops never touch the heap.
+*/
+
+#pragma once
+#include <xtd/xtd.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <xtd/concurrent/spin_lock.hpp>
+
+namespace xtd{
+
+  namespace concurrent{
+
+#if (!DOXY_INVOKED)
+    namespace _{
+      namespace pooled_stack{
+
+        static constexpr uint32_t first_chunk = 64; ///< nodes in the first chunk. each chunk is twice the size of the last
+        static constexpr uint32_t max_chunks = 26; ///< enough chunks to address every 32 bit index
+        static constexpr uint32_t batch_size = 32; ///< nodes moved between a thread cache and the shared free list at once
+
+        inline uint64_t pack(uint32_t iIndex, uint32_t iTag){ return (static_cast<uint64_t>(iTag) << 32) | iIndex; }
+        inline uint32_t index_of(uint64_t iHead){ return static_cast<uint32_t>(iHead); }
+        inline uint32_t tag_of(uint64_t iHead){ return static_cast<uint32_t>(iHead >> 32); }
+
+        inline uint32_t highest_bit(uint32_t x){
+          uint32_t iRet = 0;
+          if (x >> 16){ x >>= 16; iRet += 16; }
+          if (x >> 8){ x >>= 8; iRet += 8; }
+          if (x >> 4){ x >>= 4; iRet += 4; }
+          if (x >> 2){ x >>= 2; iRet += 2; }
+          if (x >> 1){ iRet += 1; }
+          return iRet;
+        }
+
+        /// nodes of a stack that threads may hold in their caches after the stack is destroyed
+        class pool_base{
+        public:
+          pool_base() : _id(next_id()){}
+          virtual ~pool_base() = default;
+          pool_base(const pool_base&) = delete;
+          pool_base& operator=(const pool_base&) = delete;
+
+          /// returns a chain of nodes linked through their next indices to the shared free list
+          virtual void release(uint32_t iFirst, uint32_t iLast) = 0;
+
+          static uint64_t next_id(){
+            static std::atomic<uint64_t> _next_id(0);
+            return ++_next_id;
+          }
+
+          const uint64_t _id;
+        };
+
+        /// the calling thread's cached nodes of every stack it has used. returned to the stacks when the thread exits
+        class thread_cache{
+        public:
+          /// a chain of free nodes of one stack linked through their next indices
+          struct entry{
+            uint64_t _id;
+            std::weak_ptr<pool_base> _pool;
+            uint32_t _first;
+            uint32_t _last;
+            uint32_t _count;
+          };
+
+          ~thread_cache(){
+            for (auto & oEntry : _entries){
+              if (!oEntry._count){
+                continue;
+              }
+              if (auto pPool = oEntry._pool.lock()){
+                pPool->release(oEntry._first, oEntry._last);
+              }
+            }
+          }
+
+          entry& get(const std::shared_ptr<pool_base>& pPool){
+            for (auto & oEntry : _entries){
+              if (oEntry._id == pPool->_id){
+                return oEntry;
+              }
+            }
+            // forget stacks that have been destroyed
+            _entries.erase(std::remove_if(_entries.begin(), _entries.end(), [](const entry& oEntry){ return oEntry._pool.expired(); }), _entries.end());
+            _entries.push_back(entry{ pPool->_id, pPool, 0, 0, 0 });
+            return _entries.back();
+          }
+
+          static thread_cache& instance(){
+            static thread_local thread_cache _instance;
+            return _instance;
+          }
+
+        private:
+          std::vector<entry> _entries;
+        };
+
+        template <typename _ValueT>
+        struct node{
+          node() : _next(0){}
+          std::atomic<uint32_t> _next;
+          typename std::aligned_storage<sizeof(_ValueT), alignof(_ValueT)>::type _value;
+
+          _ValueT * value(){ return reinterpret_cast<_ValueT*>(&_value); }
+        };
+
+        /// chunked node storage with a shared free list
+        template <typename _ValueT>
+        class pool : public pool_base{
+        public:
+          using node_type = node<_ValueT>;
+
+          pool() : _capacity(0), _free(0){
+            for (auto & oChunk : _chunks){
+              oChunk.store(nullptr);
+            }
+          }
+
+          ~pool() override{
+            for (auto & oChunk : _chunks){
+              delete[] oChunk.load();
+            }
+          }
+
+          /// the node with index iIndex. indices start at 1 so 0 can end a chain
+          node_type& at(uint32_t iIndex){
+            auto iOffset = iIndex - 1;
+            auto iChunk = highest_bit(iOffset / first_chunk + 1);
+            return _chunks[iChunk].load(std::memory_order_acquire)[iOffset - first_chunk * ((1U << iChunk) - 1)];
+          }
+
+          /// number of nodes allocated
+          size_t capacity() const{ return _capacity.load(); }
+
+          /// pushes the chain of nodes from iFirst to iLast, which is linked through next indices, onto a tagged head
+          void push_chain(std::atomic<uint64_t>& oHead, uint32_t iFirst, uint32_t iLast){
+            auto iHead = oHead.load(std::memory_order_relaxed);
+            forever{
+              at(iLast)._next.store(index_of(iHead), std::memory_order_relaxed);
+              if (oHead.compare_exchange_weak(iHead, pack(iFirst, 1 + tag_of(iHead)), std::memory_order_release, std::memory_order_relaxed)){
+                return;
+              }
+            }
+          }
+
+          /** pops up to iMax nodes from a tagged head
+          @param iLast receives the last of the popped nodes, whose next index is set to 0
+          @param iCount receives the number of nodes popped
+          @returns the first of the popped nodes, which remain linked through their next indices, or 0 if the head was empty
+          */
+          uint32_t pop_chain(std::atomic<uint64_t>& oHead, uint32_t iMax, uint32_t& iLast, uint32_t& iCount){
+            auto iHead = oHead.load(std::memory_order_acquire);
+            forever{
+              auto iFirst = index_of(iHead);
+              if (!iFirst){
+                return 0;
+              }
+              // a node popped and reused by another thread may hold any index. the CAS fails in that case but the index must not be followed
+              auto iCapacity = _capacity.load(std::memory_order_acquire);
+              iLast = iFirst;
+              auto iNext = at(iLast)._next.load(std::memory_order_relaxed);
+              iCount = 1;
+              for (; iCount < iMax && iNext && iNext <= iCapacity; ++iCount){
+                iLast = iNext;
+                iNext = at(iLast)._next.load(std::memory_order_relaxed);
+              }
+              if (iNext > iCapacity){
+                iHead = oHead.load(std::memory_order_acquire);
+                continue;
+              }
+              if (oHead.compare_exchange_weak(iHead, pack(iNext, 1 + tag_of(iHead)), std::memory_order_acquire, std::memory_order_acquire)){
+                at(iLast)._next.store(0, std::memory_order_relaxed);
+                return iFirst;
+              }
+            }
+          }
+
+          /// detaches every node from a tagged head and returns the first or 0
+          uint32_t take_all(std::atomic<uint64_t>& oHead){
+            auto iHead = oHead.load(std::memory_order_relaxed);
+            while (index_of(iHead) && !oHead.compare_exchange_weak(iHead, pack(0, 1 + tag_of(iHead)), std::memory_order_acquire, std::memory_order_relaxed)){}
+            return index_of(iHead);
+          }
+
+          /// a free node from the calling thread's cache, refilling the cache when it is empty
+          uint32_t acquire(thread_cache::entry& oCache){
+            while (!oCache._count){
+              if (!(oCache._first = pop_chain(_free, batch_size, oCache._last, oCache._count))){
+                grow();
+              }
+            }
+            auto iRet = oCache._first;
+            oCache._first = at(iRet)._next.load(std::memory_order_relaxed);
+            --oCache._count;
+            return iRet;
+          }
+
+          /// returns a node to the calling thread's cache and hands a batch to the free list when the cache is full
+          void recycle(thread_cache::entry& oCache, uint32_t iIndex){
+            at(iIndex)._next.store(oCache._first, std::memory_order_relaxed);
+            if (!oCache._count){
+              oCache._last = iIndex;
+            }
+            oCache._first = iIndex;
+            if (++oCache._count < 2 * batch_size){
+              return;
+            }
+            auto iLast = iIndex;
+            for (uint32_t i = 1; i < batch_size; ++i){
+              iLast = at(iLast)._next.load(std::memory_order_relaxed);
+            }
+            oCache._first = at(iLast)._next.load(std::memory_order_relaxed);
+            oCache._count -= batch_size;
+            push_chain(_free, iIndex, iLast);
+          }
+
+          void release(uint32_t iFirst, uint32_t iLast) override{
+            push_chain(_free, iFirst, iLast);
+          }
+
+        private:
+
+          /// allocates the next chunk and adds its nodes to the free list
+          void grow(){
+            spin_lock::scope_locker oLock(_grow_lock);
+            if (index_of(_free.load())){
+              return;
+            }
+            auto iCapacity = _capacity.load();
+            auto iChunk = highest_bit(iCapacity / first_chunk + 1);
+            if (iChunk >= max_chunks){
+              throw std::bad_alloc();
+            }
+            auto iNodes = first_chunk << iChunk;
+            auto pChunk = new node_type[iNodes];
+            for (uint32_t i = 0; i < iNodes - 1; ++i){
+              pChunk[i]._next.store(iCapacity + i + 2, std::memory_order_relaxed);
+            }
+            _chunks[iChunk].store(pChunk, std::memory_order_release);
+            _capacity.store(iCapacity + iNodes, std::memory_order_release);
+            push_chain(_free, iCapacity + 1, iCapacity + iNodes);
+          }
+
+          std::atomic<node_type*> _chunks[max_chunks];
+          std::atomic<uint32_t> _capacity;
+          std::atomic<uint64_t> _free;
+          spin_lock _grow_lock;
+        };
+
+      }
+    }
+#endif
+
+    /** @addtogroup Concurrent
+    @{*/
+
+    /** A lock-free LIFO stack that recycles its nodes
+    An alternative to stack for hot paths such as buffer free lists. Nodes are reused rather than allocated and freed
+    so steady state pushes and pops perform no heap allocations, and a tagged head makes pops ABA safe without
+    epoch_domain. Memory of the nodes is only released when the stack is destroyed.
+    Nodes cached by a thread are returned to the stack when the thread exits.
+    @tparam _ValueT type of value contained in the stack. Must be move constructible.
+    @tparam _WaitPolicyT policy invoked while pop waits for an item
+    */
+    template <typename _ValueT, typename _WaitPolicyT = null_wait_policy>
+    class pooled_stack{
+      using pool_type = _::pooled_stack::pool<_ValueT>;
+      using cache_type = _::pooled_stack::thread_cache;
+
+    public:
+      using value_type = _ValueT;
+      using wait_policy_type = _WaitPolicyT;
+
+      pooled_stack(wait_policy_type oWait = wait_policy_type()) : _pool(std::make_shared<pool_type>()), _head(0), _wait_policy(oWait){}
+
+      ~pooled_stack(){
+        for (auto iIndex = _::pooled_stack::index_of(_head.load()); iIndex;){
+          auto & oNode = _pool->at(iIndex);
+          oNode.value()->~value_type();
+          iIndex = oNode._next.load();
+        }
+      }
+
+      pooled_stack(const pooled_stack&) = delete;
+      pooled_stack& operator=(const pooled_stack&) = delete;
+
+      void push(const value_type& value){
+        emplace(value);
+      }
+
+      void push(value_type&& value){
+        emplace(std::move(value));
+      }
+
+      /// constructs an item on the top of the stack
+      template <typename ... _ArgTs>
+      void emplace(_ArgTs&&...oArgs){
+        auto & oCache = _cache();
+        auto iIndex = _construct(oCache, std::forward<_ArgTs>(oArgs)...);
+        _pool->push_chain(_head, iIndex, iIndex);
+      }
+
+      /** pushes a sequence of items with a single update of the head
+      The items are pushed in order so the last item ends on top, as with a sequence of pushes. No other thread
+      observes part of the sequence.
+      */
+      template <typename _IteratorT>
+      void push_range(_IteratorT first, _IteratorT last){
+        if (first == last){
+          return;
+        }
+        auto & oCache = _cache();
+        uint32_t iTop = 0;
+        uint32_t iBottom = 0;
+        try{
+          for (; first != last; ++first){
+            auto iIndex = _construct(oCache, *first);
+            _pool->at(iIndex)._next.store(iTop, std::memory_order_relaxed);
+            iTop = iIndex;
+            if (!iBottom){
+              iBottom = iIndex;
+            }
+          }
+        } catch (...){
+          while (iTop){
+            auto iNext = _pool->at(iTop)._next.load(std::memory_order_relaxed);
+            _destroy(oCache, iTop);
+            iTop = iNext;
+          }
+          throw;
+        }
+        _pool->push_chain(_head, iTop, iBottom);
+      }
+
+      bool try_pop(value_type& oRet){
+        uint32_t iLast = 0;
+        uint32_t iCount = 0;
+        auto iIndex = _pool->pop_chain(_head, 1, iLast, iCount);
+        if (!iIndex){
+          return false;
+        }
+        oRet = std::move(*_pool->at(iIndex).value());
+        _destroy(_cache(), iIndex);
+        return true;
+      }
+
+      value_type pop(){
+        value_type oRet;
+        while (!try_pop(oRet)){
+          _wait_policy();
+        }
+        return oRet;
+      }
+
+      /** atomically removes every item
+      @param oOut output iterator receiving the items from the top of the stack down
+      @returns number of items removed
+      */
+      template <typename _OutputIteratorT>
+      size_t pop_all(_OutputIteratorT oOut){
+        auto & oCache = _cache();
+        size_t iRet = 0;
+        for (auto iIndex = _pool->take_all(_head); iIndex; ++iRet){
+          auto & oNode = _pool->at(iIndex);
+          auto iNext = oNode._next.load(std::memory_order_relaxed);
+          *oOut++ = std::move(*oNode.value());
+          _destroy(oCache, iIndex);
+          iIndex = iNext;
+        }
+        return iRet;
+      }
+
+      /// true if the stack has no items. approximate while other threads push and pop
+      bool empty() const{
+        return !_::pooled_stack::index_of(_head.load());
+      }
+
+      /// number of nodes allocated by the stack
+      size_t capacity() const{
+        return _pool->capacity();
+      }
+
+    private:
+
+      cache_type::entry& _cache(){
+        return cache_type::instance().get(_pool);
+      }
+
+      template <typename ... _ArgTs>
+      uint32_t _construct(cache_type::entry& oCache, _ArgTs&&...oArgs){
+        auto iIndex = _pool->acquire(oCache);
+        try{
+          new (_pool->at(iIndex).value()) value_type(std::forward<_ArgTs>(oArgs)...);
+        } catch (...){
+          _pool->recycle(oCache, iIndex);
+          throw;
+        }
+        return iIndex;
+      }
+
+      void _destroy(cache_type::entry& oCache, uint32_t iIndex){
+        _pool->at(iIndex).value()->~value_type();
+        _pool->recycle(oCache, iIndex);
+      }
+
+      std::shared_ptr<pool_type> _pool;
+      std::atomic<uint64_t> _head;
+      wait_policy_type _wait_policy;
+    };
+
+    ///@}
+  }
+}
@@ -1,75 +1,306 @@
 /** @file
-concurrently push and pop items from a FIFO queue
+concurrently push and pop items from a bounded FIFO queue
 @copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
 
+The queue is a ring buffer of cells that each carry a sequence number. A cell whose sequence equals a position is free
+for the producer that claims that position, and a cell whose sequence is one past a position holds the item of that
+position for a consumer. Producers and consumers claim positions with a CAS on separate cache line padded indices
+then publish the cell by advancing its sequence, so a producer and a consumer only meet on a cell when the queue is
+empty or full.
 */
 
-#if 0
 #pragma once
 #include <xtd/xtd.hpp>
 
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <xtd/concurrent/wait_policy.hpp>
+
 namespace xtd{
+
   namespace concurrent{
-    template <typename _ty> class queue{
+
+#if (!DOXY_INVOKED)
+    namespace _{
+      namespace queue{
+
+        template <typename _ValueT>
+        struct cell{
+          std::atomic<size_t> _sequence;
+          typename std::aligned_storage<sizeof(_ValueT), alignof(_ValueT)>::type _value;
+
+          _ValueT * value(){ return reinterpret_cast<_ValueT*>(&_value); }
+        };
+
+        struct alignas(64) position{
+          position() : _value(0){}
+          std::atomic<size_t> _value;
+        };
+
+        /// smallest power of two that is at least x
+        inline size_t round_up(size_t x){
+          size_t iRet = 2;
+          while (iRet < x){
+            iRet <<= 1;
+          }
+          return iRet;
+        }
+
+      }
+    }
+#endif
+
+    /** @addtogroup Concurrent
+    @{*/
+
+    /** A lock-free bounded multi-producer multi-consumer FIFO queue
+    Items live in a ring buffer allocated when the queue is constructed, so pushes and pops never allocate. try_push
+    fails when the queue is full and try_pop fails when it is empty. push and pop invoke the wait policy until they
+    succeed.
+    @tparam _ValueT type of value contained in the queue. Must be nothrow move constructible.
+    @tparam _WaitPolicyT policy invoked while push waits for a free cell and pop waits for an item
+    */
+    template <typename _ValueT, typename _WaitPolicyT = null_wait_policy>
+    class queue{
+      using cell_type = _::queue::cell<_ValueT>;
+
     public:
-      using value_type = _ty;
+      using value_type = _ValueT;
+      using wait_policy_type = _WaitPolicyT;
+
+      static_assert(std::is_nothrow_move_constructible<_ValueT>::value, "queue items must be nothrow move constructible");
+
+      /** constructs an empty queue
+      @param iCapacity maximum number of items. rounded up to a power of two
+      @param oWait wait policy
+      */
+      explicit queue(size_t iCapacity = 1024, wait_policy_type oWait = wait_policy_type())
+        : _mask(_::queue::round_up(iCapacity) - 1), _cells(new cell_type[_mask + 1]), _wait_policy(oWait)
+      {
+        for (size_t i = 0; i <= _mask; ++i){
+          _cells[i]._sequence.store(i, std::memory_order_relaxed);
+        }
+      }
+
+      ~queue(){
+        auto iPush = _push._value.load();
+        for (auto iPosition = _pop._value.load(); iPosition != iPush; ++iPosition){
+          _cells[iPosition & _mask].value()->~value_type();
+        }
+      }
 
-      queue() : _head(nullptr), _tail(nullptr){}
       queue(const queue&) = delete;
       queue& operator=(const queue&) = delete;
-      ~queue(){
-        while(auto oNode = _head.load()){
-          _head.store(oNode->_next);
-          delete oNode;
+
+      /// maximum number of items
+      size_t capacity() const{ return _mask + 1; }
+
+      /// number of items. approximate while other threads push and pop
+      size_t size() const{
+        auto iPop = _pop._value.load(std::memory_order_relaxed);
+        auto iPush = _push._value.load(std::memory_order_relaxed);
+        return (iPush > iPop ? iPush - iPop : 0);
+      }
+
+      /// true if the queue has no items. approximate while other threads push and pop
+      bool empty() const{ return !size(); }
+
+      bool try_push(const value_type& value){
+        return try_emplace(value);
+      }
+
+      bool try_push(value_type&& value){
+        return try_emplace(std::move(value));
+      }
+
+      /** constructs an item at the back of the queue unless the queue is full
+      If constructing the item may throw it is constructed before a cell is claimed so a failed construction never
+      leaves a claimed cell unpublished.
+      */
+      template <typename ... _ArgTs>
+      bool try_emplace(_ArgTs&&...oArgs){
+        if constexpr (std::is_nothrow_constructible<value_type, _ArgTs&&...>::value){
+          size_t iPosition;
+          auto pCell = _claim_push(iPosition);
+          if (!pCell){
+            return false;
+          }
+          new (pCell->value()) value_type(std::forward<_ArgTs>(oArgs)...);
+          pCell->_sequence.store(iPosition + 1, std::memory_order_release);
+          return true;
+        } else{
+          if (full()){
+            return false;
+          }
+          return try_emplace(value_type(std::forward<_ArgTs>(oArgs)...));
         }
       }
 
-      void push(const value_type& src){
-        auto oNode = new node(src);
-        do{
-          oNode->_next = _head.load();
-        }while (!_head.compare_exchange_strong(&oNode, oNode->_next));
-        node::pointer pNull = nullptr;
-        _tail.compare_exchange_strong(&pNull, oNode);
+      void push(const value_type& value){
+        emplace(value);
+      }
+
+      void push(value_type&& value){
+        emplace(std::move(value));
       }
-      bool try_pop(value_type& ret){
-        do{
-          auto oNode = _head.load();
-          if (!oNode) return false;
 
-        }while(!_head.)
+      /// constructs an item at the back of the queue waiting while the queue is full
+      template <typename ... _ArgTs>
+      void emplace(_ArgTs&&...oArgs){
+        value_type oValue(std::forward<_ArgTs>(oArgs)...);
+        while (!try_emplace(std::move(oValue))){
+          _wait_policy();
+        }
+      }
+
+      bool try_pop(value_type& oRet){
+        size_t iPosition;
+        auto pCell = _claim_pop(iPosition);
+        if (!pCell){
+          return false;
+        }
+        oRet = std::move(*pCell->value());
+        _release(pCell, iPosition);
+        return true;
       }
+
       value_type pop(){
-        auto oNode = _head.load();
-        if (!oNode){
+        size_t iPosition;
+        cell_type * pCell;
+        while (!(pCell = _claim_pop(iPosition))){
+          _wait_policy();
+        }
+        value_type oRet(std::move(*pCell->value()));
+        _release(pCell, iPosition);
+        return oRet;
+      }
 
+      /** moves up to iCount items into the queue with a single claim of the back of the queue
+      Does not wait. The pushed items are contiguous in the queue so consumers see them in order.
+      @param first input iterator to the items. items that are pushed are moved from
+      @param iCount number of items to push
+      @returns number of items pushed, fewer than iCount if the queue filled
+      */
+      template <typename _IteratorT>
+      size_t push_n(_IteratorT first, size_t iCount){
+        static_assert(std::is_nothrow_constructible<value_type, decltype(std::move(*first))>::value, "push_n items must be nothrow movable into the queue");
+        size_t iPosition;
+        auto iClaimed = _claim_n(_push, 0, iCount, iPosition);
+        for (size_t i = 0; i < iClaimed; ++i, ++first){
+          auto & oCell = _cells[(iPosition + i) & _mask];
+          new (oCell.value()) value_type(std::move(*first));
+          oCell._sequence.store(iPosition + i + 1, std::memory_order_release);
         }
+        return iClaimed;
       }
 
-    protected:
+      /** pops up to iMax items with a single claim of the front of the queue
+      Does not wait.
+      @param oOut output iterator receiving the items from the front of the queue
+      @param iMax maximum number of items to pop
+      @returns number of items popped
+      */
+      template <typename _OutputIteratorT>
+      size_t pop_n(_OutputIteratorT oOut, size_t iMax){
+        size_t iPosition;
+        auto iClaimed = _claim_n(_pop, 1, iMax, iPosition);
+        for (size_t i = 0; i < iClaimed; ++i){
+          auto & oCell = _cells[(iPosition + i) & _mask];
+          *oOut++ = std::move(*oCell.value());
+          _release(&oCell, iPosition + i);
+        }
+        return iClaimed;
+      }
+
+    private:
+
+      bool full() const{ return size() > _mask; }
+
+      /// claims the cell of the next push position or returns nullptr if the queue is full
+      cell_type * _claim_push(size_t& iPosition){
+        iPosition = _push._value.load(std::memory_order_relaxed);
+        forever{
+          auto pCell = &_cells[iPosition & _mask];
+          auto iSequence = pCell->_sequence.load(std::memory_order_acquire);
+          auto iDiff = static_cast<intptr_t>(iSequence) - static_cast<intptr_t>(iPosition);
+          if (0 == iDiff){
+            if (_push._value.compare_exchange_weak(iPosition, iPosition + 1, std::memory_order_relaxed)){
+              return pCell;
+            }
+          } else if (iDiff < 0){
+            return nullptr;
+          } else{
+            iPosition = _push._value.load(std::memory_order_relaxed);
+          }
+        }
+      }
 
-      struct node{
-        using pointer = node *;
-        using atomic_ptr = std::atomic<pointer>;
-        value_type _value;
-        node * _next;
-        node(const value_type& data) : _data(data), _next(nullptr){}
-        node(value_type&& data) : _data(std::move(data)), _next(nullptr){}
-      };
+      /// claims the cell of the next pop position or returns nullptr if the queue is empty
+      cell_type * _claim_pop(size_t& iPosition){
+        iPosition = _pop._value.load(std::memory_order_relaxed);
+        forever{
+          auto pCell = &_cells[iPosition & _mask];
+          auto iSequence = pCell->_sequence.load(std::memory_order_acquire);
+          auto iDiff = static_cast<intptr_t>(iSequence) - static_cast<intptr_t>(iPosition + 1);
+          if (0 == iDiff){
+            if (_pop._value.compare_exchange_weak(iPosition, iPosition + 1, std::memory_order_relaxed)){
+              return pCell;
+            }
+          } else if (iDiff < 0){
+            return nullptr;
+          } else{
+            iPosition = _pop._value.load(std::memory_order_relaxed);
+          }
+        }
+      }
 
-      node::pointer pop_head(){
-        auto ori = _head.load();
-        if (ori == _tail.load()){
-          return nullptr;
+      /** claims up to iMax consecutive cells that are ready at an index
+      A cell at position p is ready when its sequence is p + iReady. Only the thread that claims a position changes
+      the sequence of its cell, so cells seen ready before the CAS are still ready after it.
+      @returns number of cells claimed starting at iPosition
+      */
+      size_t _claim_n(_::queue::position& oIndex, size_t iReady, size_t iMax, size_t& iPosition){
+        iPosition = oIndex._value.load(std::memory_order_relaxed);
+        forever{
+          size_t iCount = 0;
+          for (; iCount < iMax && iCount <= _mask; ++iCount){
+            auto iSequence = _cells[(iPosition + iCount) & _mask]._sequence.load(std::memory_order_acquire);
+            if (iSequence != iPosition + iCount + iReady){
+              break;
+            }
+          }
+          if (!iCount){
+            auto iCurrent = oIndex._value.load(std::memory_order_relaxed);
+            if (iCurrent == iPosition){
+              return 0;
+            }
+            iPosition = iCurrent;
+            continue;
+          }
+          if (oIndex._value.compare_exchange_weak(iPosition, iPosition + iCount, std::memory_order_relaxed)){
+            return iCount;
+          }
         }
-        _head.store(ori->_next);
-        return ori;
       }
 
-      node::atomic_ptr _head;
-      node::atomic_ptr _tail;
+      /// destroys the item of a popped cell and frees the cell for the push one lap later
+      void _release(cell_type * pCell, size_t iPosition){
+        pCell->value()->~value_type();
+        pCell->_sequence.store(iPosition + _mask + 1, std::memory_order_release);
+      }
+
+      const size_t _mask;
+      std::unique_ptr<cell_type[]> _cells;
+      _::queue::position _push;
+      _::queue::position _pop;
+      wait_policy_type _wait_policy;
     };
+
+    ///@}
   }
 }
-
-#endif
@@ -0,0 +1,567 @@
+/** @file
+concurrently insert, query and delete items in an adaptive radix tree
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+An adaptive radix tree (ART) indexes a key one byte at a time like a 256-way trie but sizes each inner node to the
+number of children it actually has (4, 16, 48 or 256 slots). Common key bytes are stored once in a node prefix (path
+compression) and a leaf is hung at the shallowest level where it is unique (lazy expansion) so a 64-bit key is
+resolved in a handful of node visits instead of one per nibble.
+
+Readers never lock. Writers lock only the node they modify, plus its parent when the node must be replaced because
+it is full or its prefix must be split. Replaced nodes are marked obsolete and retired to the epoch_domain rather
+than deleted so concurrent readers can finish walking them.
+*/
+
+#pragma once
+#include <xtd/concurrent/concurrent.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include <xtd/meta.hpp>
+#include <xtd/concurrent/spin_lock.hpp>
+#include <xtd/concurrent/epoch_domain.hpp>
+
+namespace xtd{
+
+  namespace concurrent{
+
+#if (!DOXY_INVOKED)
+    namespace _{
+      namespace radix_map{
+
+        enum class node_kind : uint8_t{
+          node4,
+          node16,
+          node48,
+          node256,
+        };
+
+        /// tagged child pointer: bit 0 set for leaves, 0 for an empty slot
+        using child_ptr = uintptr_t;
+        static constexpr child_ptr leaf_bit = 1;
+        static constexpr size_t max_prefix = 8;
+
+        /// common header of all inner nodes. everything except the child slots is immutable once published
+        struct node_base{
+          node_base(node_kind kind, const uint8_t * pPrefix, uint8_t iPrefixLen) : _kind(kind), _prefix_len(iPrefixLen), _obsolete(false){
+            for (uint8_t i = 0; i < iPrefixLen; ++i){
+              _prefix[i] = pPrefix[i];
+            }
+          }
+          node_base(const node_base&) = delete;
+          node_base& operator=(const node_base&) = delete;
+
+          const node_kind _kind;
+          const uint8_t _prefix_len;
+          uint8_t _prefix[max_prefix];
+          std::atomic<bool> _obsolete;
+          spin_lock _lock;
+        };
+
+        /// Node4 and Node16: parallel arrays of key bytes and children searched linearly
+        template <node_kind _KindV, uint8_t _CapacityV>
+        struct small_node : node_base{
+          static constexpr uint8_t capacity = _CapacityV;
+          small_node(const uint8_t * pPrefix, uint8_t iPrefixLen) : node_base(_KindV, pPrefix, iPrefixLen), _count(0){
+            for (uint8_t i = 0; i < capacity; ++i){
+              _keys[i].store(0, std::memory_order_relaxed);
+              _children[i].store(0, std::memory_order_relaxed);
+            }
+          }
+          std::atomic<uint8_t> _count;
+          std::atomic<uint8_t> _keys[capacity];
+          std::atomic<child_ptr> _children[capacity];
+        };
+
+        using node4 = small_node<node_kind::node4, 4>;
+        using node16 = small_node<node_kind::node16, 16>;
+
+        /// Node48: a 256 entry byte index into 48 child slots
+        struct node48 : node_base{
+          static constexpr uint8_t capacity = 48;
+          node48(const uint8_t * pPrefix, uint8_t iPrefixLen) : node_base(node_kind::node48, pPrefix, iPrefixLen), _count(0){
+            for (auto & oItem : _index){
+              oItem.store(0, std::memory_order_relaxed);
+            }
+            for (auto & oItem : _children){
+              oItem.store(0, std::memory_order_relaxed);
+            }
+          }
+          std::atomic<uint8_t> _count;
+          std::atomic<uint8_t> _index[256]; ///< 1 based slot number, 0 when the byte is unused
+          std::atomic<child_ptr> _children[capacity];
+        };
+
+        /// Node256: direct indexed
+        struct node256 : node_base{
+          node256(const uint8_t * pPrefix, uint8_t iPrefixLen) : node_base(node_kind::node256, pPrefix, iPrefixLen){
+            for (auto & oItem : _children){
+              oItem.store(0, std::memory_order_relaxed);
+            }
+          }
+          std::atomic<child_ptr> _children[256];
+        };
+
+        inline bool is_leaf(child_ptr p){ return 0 != (p & leaf_bit); }
+        inline node_base * as_node(child_ptr p){ return reinterpret_cast<node_base*>(p); }
+        inline child_ptr from_node(const node_base * p){ return reinterpret_cast<child_ptr>(p); }
+
+        inline void delete_node(node_base * pNode){
+          switch (pNode->_kind){
+            case node_kind::node4: delete static_cast<node4*>(pNode); break;
+            case node_kind::node16: delete static_cast<node16*>(pNode); break;
+            case node_kind::node48: delete static_cast<node48*>(pNode); break;
+            case node_kind::node256: delete static_cast<node256*>(pNode); break;
+          }
+        }
+
+        template <typename _NodeT>
+        inline child_ptr small_find(const _NodeT * pNode, uint8_t key){
+          auto iCount = pNode->_count.load(std::memory_order_acquire);
+          for (uint8_t i = 0; i < iCount; ++i){
+            if (key == pNode->_keys[i].load(std::memory_order_relaxed)){
+              return pNode->_children[i].load(std::memory_order_acquire);
+            }
+          }
+          return 0;
+        }
+
+        /// lock-free lookup of the child associated with a key byte
+        inline child_ptr find_child(const node_base * pNode, uint8_t key){
+          switch (pNode->_kind){
+            case node_kind::node4: return small_find(static_cast<const node4*>(pNode), key);
+            case node_kind::node16: return small_find(static_cast<const node16*>(pNode), key);
+            case node_kind::node48:{
+              auto pNode48 = static_cast<const node48*>(pNode);
+              auto iSlot = pNode48->_index[key].load(std::memory_order_acquire);
+              return (iSlot ? pNode48->_children[iSlot - 1].load(std::memory_order_acquire) : 0);
+            }
+            case node_kind::node256: return static_cast<const node256*>(pNode)->_children[key].load(std::memory_order_acquire);
+          }
+          return 0;
+        }
+
+        /* Slots of node4/16/48 are never reassigned to a different key byte while the node is published because a
+        reader may have already matched the old byte. A removed child leaves an empty slot that can only be reused by
+        the same byte; the slots are compacted when the node is copied. */
+        template <typename _NodeT>
+        inline bool small_add(_NodeT * pNode, uint8_t key, child_ptr child){
+          auto iCount = pNode->_count.load(std::memory_order_relaxed);
+          for (uint8_t i = 0; i < iCount; ++i){
+            if (key == pNode->_keys[i].load(std::memory_order_relaxed)){
+              pNode->_children[i].store(child, std::memory_order_release);
+              return true;
+            }
+          }
+          if (iCount >= _NodeT::capacity){
+            return false;
+          }
+          pNode->_keys[iCount].store(key, std::memory_order_relaxed);
+          pNode->_children[iCount].store(child, std::memory_order_release);
+          pNode->_count.store(static_cast<uint8_t>(1 + iCount), std::memory_order_release);
+          return true;
+        }
+
+        /** associates a child with a key byte or replaces the existing child. the node lock must be held
+        @returns false if the node is full
+        */
+        inline bool set_child(node_base * pNode, uint8_t key, child_ptr child){
+          switch (pNode->_kind){
+            case node_kind::node4: return small_add(static_cast<node4*>(pNode), key, child);
+            case node_kind::node16: return small_add(static_cast<node16*>(pNode), key, child);
+            case node_kind::node48:{
+              auto pNode48 = static_cast<node48*>(pNode);
+              auto iSlot = pNode48->_index[key].load(std::memory_order_relaxed);
+              if (iSlot){
+                pNode48->_children[iSlot - 1].store(child, std::memory_order_release);
+                return true;
+              }
+              auto iCount = pNode48->_count.load(std::memory_order_relaxed);
+              if (iCount >= node48::capacity){
+                return false;
+              }
+              pNode48->_children[iCount].store(child, std::memory_order_release);
+              pNode48->_index[key].store(static_cast<uint8_t>(1 + iCount), std::memory_order_release);
+              pNode48->_count.store(static_cast<uint8_t>(1 + iCount), std::memory_order_relaxed);
+              return true;
+            }
+            case node_kind::node256:
+              static_cast<node256*>(pNode)->_children[key].store(child, std::memory_order_release);
+              return true;
+          }
+          return false;
+        }
+
+        /// visits every non-empty child slot
+        template <typename _FnT>
+        inline void for_each_child(const node_base * pNode, _FnT&& fn){
+          switch (pNode->_kind){
+            case node_kind::node4:
+            case node_kind::node16:{
+              auto iCount = (node_kind::node4 == pNode->_kind ? static_cast<const node4*>(pNode)->_count.load(std::memory_order_acquire) : static_cast<const node16*>(pNode)->_count.load(std::memory_order_acquire));
+              for (uint8_t i = 0; i < iCount; ++i){
+                uint8_t key;
+                child_ptr child;
+                if (node_kind::node4 == pNode->_kind){
+                  key = static_cast<const node4*>(pNode)->_keys[i].load(std::memory_order_relaxed);
+                  child = static_cast<const node4*>(pNode)->_children[i].load(std::memory_order_acquire);
+                } else{
+                  key = static_cast<const node16*>(pNode)->_keys[i].load(std::memory_order_relaxed);
+                  child = static_cast<const node16*>(pNode)->_children[i].load(std::memory_order_acquire);
+                }
+                if (child){
+                  fn(key, child);
+                }
+              }
+              break;
+            }
+            case node_kind::node48:{
+              auto pNode48 = static_cast<const node48*>(pNode);
+              for (int i = 0; i < 256; ++i){
+                auto iSlot = pNode48->_index[i].load(std::memory_order_acquire);
+                if (iSlot){
+                  auto child = pNode48->_children[iSlot - 1].load(std::memory_order_acquire);
+                  if (child){
+                    fn(static_cast<uint8_t>(i), child);
+                  }
+                }
+              }
+              break;
+            }
+            case node_kind::node256:{
+              auto pNode256 = static_cast<const node256*>(pNode);
+              for (int i = 0; i < 256; ++i){
+                auto child = pNode256->_children[i].load(std::memory_order_acquire);
+                if (child){
+                  fn(static_cast<uint8_t>(i), child);
+                }
+              }
+              break;
+            }
+          }
+        }
+
+        /// creates an unpublished node of the smallest kind able to hold iChildren
+        inline node_base * new_node(size_t iChildren, const uint8_t * pPrefix, uint8_t iPrefixLen){
+          if (iChildren <= node4::capacity) return new node4(pPrefix, iPrefixLen);
+          if (iChildren <= node16::capacity) return new node16(pPrefix, iPrefixLen);
+          if (iChildren <= node48::capacity) return new node48(pPrefix, iPrefixLen);
+          return new node256(pPrefix, iPrefixLen);
+        }
+
+        /** copies the live children of a node into a new unpublished node. the node lock must be held
+        @param pNode source node
+        @param iExtra number of additional children the copy must have room for
+        @param pPrefix prefix of the copy
+        @param iPrefixLen prefix length of the copy
+        */
+        inline node_base * copy_node(const node_base * pNode, size_t iExtra, const uint8_t * pPrefix, uint8_t iPrefixLen){
+          size_t iLive = 0;
+          for_each_child(pNode, [&](uint8_t, child_ptr){ ++iLive; });
+          auto pRet = new_node(iLive + iExtra, pPrefix, iPrefixLen);
+          for_each_child(pNode, [&](uint8_t key, child_ptr child){ set_child(pRet, key, child); });
+          return pRet;
+        }
+
+      }
+    }
+#endif
+
+    /** @addtogroup Concurrent
+    @{*/
+
+    /** thread-safe key-value container indexed by an adaptive radix tree
+    An alternative to hash_map for large, densely populated maps. Inner nodes grow from 4 to 256 slots as they fill
+    and common key bytes are path compressed so a lookup visits a few nodes rather than one per nibble.
+    Lookups are lock-free. Insertion and removal lock the single node being modified.
+    Nodes and leaves that are replaced or removed are retired to epoch_domain::global() and deleted once no reader can reach them.
+    @tparam _KeyT The key type. Must be an integral type of at most 64 bits
+    @tparam _ValueT The value type
+    */
+    template<typename _KeyT, typename _ValueT>
+    class radix_map{
+      using intrinsic_type = typename processor_intrinsic<_KeyT>::type;
+      using node_base = _::radix_map::node_base;
+      using child_ptr = _::radix_map::child_ptr;
+      static constexpr size_t key_bytes = sizeof(intrinsic_type);
+      static_assert(key_bytes <= _::radix_map::max_prefix, "radix_map keys must be at most 64 bits");
+
+      struct alignas(8) leaf{
+        leaf(intrinsic_type key, _ValueT&& value) : _key(key), _value(std::move(value)){}
+        const intrinsic_type _key;
+        _ValueT _value;
+      };
+
+      enum class result{
+        success,
+        failure,
+        retry,
+      };
+
+    public:
+      using value_type = _ValueT;
+      using key_type = _KeyT;
+
+      radix_map() : _root(new _::radix_map::node256(nullptr, 0)){}
+
+      ~radix_map(){
+        _destroy(_::radix_map::from_node(_root));
+      }
+
+      radix_map(const radix_map&) = delete;
+
+      radix_map& operator=(const radix_map&) = delete;
+
+      /** concurrently insert a new value associated with a key
+      @param Key key to use for indexing
+      @param Value the value to insert
+      @returns true if insert was successful
+      */
+      bool insert(const key_type& Key, value_type&& Value){
+        auto x = intrinsic_cast(Key);
+        leaf * pLeaf = nullptr;
+        epoch_domain::guard oGuard;
+        forever{
+          auto eRet = _insert(x, pLeaf, Value);
+          if (result::success == eRet){
+            return true;
+          }
+          if (result::failure == eRet){
+            delete pLeaf;
+            return false;
+          }
+        }
+      }
+
+      /** concurrently search for an existing key
+      @param Key the key to search for
+      @returns true if the item exists in the map
+      */
+      bool exists(const key_type& Key) const{
+        epoch_domain::guard oGuard;
+        return nullptr != _find(intrinsic_cast(Key));
+      }
+
+      /** concurrently search for an existing value
+      The returned pointer remains valid while the caller holds an epoch_domain::guard taken before the call.
+      @param Key the key to search for
+      @returns pointer to the value or nullptr if the key does not exist
+      */
+      value_type * find(const key_type& Key) const{
+        epoch_domain::guard oGuard;
+        auto pLeaf = _find(intrinsic_cast(Key));
+        return (pLeaf ? &pLeaf->_value : nullptr);
+      }
+
+      /** concurrently remove a value
+      @param Key key of the item to remove
+      @returns true if the item was removed
+      */
+      bool remove(const key_type& Key){
+        auto x = intrinsic_cast(Key);
+        epoch_domain::guard oGuard;
+        forever{
+          auto eRet = _remove(x);
+          if (result::retry != eRet){
+            return result::success == eRet;
+          }
+        }
+      }
+
+      /** unsafe access an item by key
+      If they value does not exist a default is created with the specified key
+      @param Key key of the item
+      @returns reference to the value
+      */
+      value_type& operator[](const key_type& Key){
+        auto x = intrinsic_cast(Key);
+        epoch_domain::guard oGuard;
+        forever{
+          if (auto pLeaf = _find(x)){
+            return pLeaf->_value;
+          }
+          insert(Key, value_type());
+        }
+      }
+
+    private:
+
+      static uint8_t _key_byte(intrinsic_type x, size_t depth){
+        return static_cast<uint8_t>(x >> (8 * (key_bytes - 1 - depth)));
+      }
+
+      static leaf * _as_leaf(child_ptr p){ return reinterpret_cast<leaf*>(p & ~_::radix_map::leaf_bit); }
+
+      static child_ptr _from_leaf(const leaf * p){ return reinterpret_cast<child_ptr>(p) | _::radix_map::leaf_bit; }
+
+      static void _retire(node_base * pNode){
+        epoch_domain::global().retire(pNode, [](void * p){ _::radix_map::delete_node(static_cast<node_base*>(p)); });
+      }
+
+      static void _retire(leaf * pLeaf){
+        epoch_domain::global().retire(pLeaf);
+      }
+
+      void _destroy(child_ptr p){
+        if (_::radix_map::is_leaf(p)){
+          delete _as_leaf(p);
+          return;
+        }
+        auto pNode = _::radix_map::as_node(p);
+        _::radix_map::for_each_child(pNode, [this](uint8_t, child_ptr child){ _destroy(child); });
+        _::radix_map::delete_node(pNode);
+      }
+
+      leaf * _find(intrinsic_type x) const{
+        const node_base * pNode = _root;
+        size_t depth = 0;
+        forever{
+          for (uint8_t i = 0; i < pNode->_prefix_len; ++i, ++depth){
+            if (pNode->_prefix[i] != _key_byte(x, depth)){
+              return nullptr;
+            }
+          }
+          auto child = _::radix_map::find_child(pNode, _key_byte(x, depth));
+          if (!child){
+            return nullptr;
+          }
+          if (_::radix_map::is_leaf(child)){
+            auto pLeaf = _as_leaf(child);
+            return (x == pLeaf->_key ? pLeaf : nullptr);
+          }
+          pNode = _::radix_map::as_node(child);
+          ++depth;
+        }
+      }
+
+      result _insert(intrinsic_type x, leaf *& pLeaf, value_type& Value){
+        using namespace _::radix_map;
+        node_base * pParent = nullptr;
+        uint8_t ParentKey = 0;
+        node_base * pNode = _root;
+        size_t depth = 0;
+        forever{
+          uint8_t iMatch = 0;
+          while (iMatch < pNode->_prefix_len && pNode->_prefix[iMatch] == _key_byte(x, depth + iMatch)){
+            ++iMatch;
+          }
+          if (iMatch < pNode->_prefix_len){
+            // the key diverges inside the prefix: hang a new node4 above a copy of this node with a shorter prefix
+            spin_lock::scope_locker oParentLock(pParent->_lock);
+            spin_lock::scope_locker oNodeLock(pNode->_lock);
+            if (pParent->_obsolete.load() || pNode->_obsolete.load() || find_child(pParent, ParentKey) != from_node(pNode)){
+              return result::retry;
+            }
+            if (!pLeaf){
+              pLeaf = new leaf(x, std::move(Value));
+            }
+            auto pSplit = new node4(pNode->_prefix, iMatch);
+            auto pCopy = copy_node(pNode, 0, pNode->_prefix + iMatch + 1, static_cast<uint8_t>(pNode->_prefix_len - iMatch - 1));
+            set_child(pSplit, pNode->_prefix[iMatch], from_node(pCopy));
+            set_child(pSplit, _key_byte(x, depth + iMatch), _from_leaf(pLeaf));
+            set_child(pParent, ParentKey, from_node(pSplit));
+            pNode->_obsolete.store(true);
+            _retire(pNode);
+            return result::success;
+          }
+          depth += pNode->_prefix_len;
+          auto Key = _key_byte(x, depth);
+          auto child = find_child(pNode, Key);
+          if (!child){
+            spin_lock::scope_locker oNodeLock(pNode->_lock);
+            if (pNode->_obsolete.load() || find_child(pNode, Key)){
+              return result::retry;
+            }
+            if (!pLeaf){
+              pLeaf = new leaf(x, std::move(Value));
+            }
+            if (set_child(pNode, Key, _from_leaf(pLeaf))){
+              return result::success;
+            }
+            // full: replace with a larger node. locks are taken top-down so the parent may only be tried here
+            if (!pParent->_lock.try_lock()){
+              return result::retry;
+            }
+            bool bValid = (!pParent->_obsolete.load() && find_child(pParent, ParentKey) == from_node(pNode));
+            if (bValid){
+              auto pGrown = copy_node(pNode, 1, pNode->_prefix, pNode->_prefix_len);
+              set_child(pGrown, Key, _from_leaf(pLeaf));
+              set_child(pParent, ParentKey, from_node(pGrown));
+              pNode->_obsolete.store(true);
+              _retire(pNode);
+            }
+            pParent->_lock.unlock();
+            return (bValid ? result::success : result::retry);
+          }
+          if (is_leaf(child)){
+            auto pOther = _as_leaf(child);
+            if (x == pOther->_key){
+              return result::failure;
+            }
+            // lazy expansion: push both leaves one level down below a node holding their common prefix
+            spin_lock::scope_locker oNodeLock(pNode->_lock);
+            if (pNode->_obsolete.load() || find_child(pNode, Key) != child){
+              return result::retry;
+            }
+            if (!pLeaf){
+              pLeaf = new leaf(x, std::move(Value));
+            }
+            uint8_t Prefix[max_prefix];
+            uint8_t iPrefixLen = 0;
+            while (_key_byte(x, depth + 1 + iPrefixLen) == _key_byte(pOther->_key, depth + 1 + iPrefixLen)){
+              Prefix[iPrefixLen] = _key_byte(x, depth + 1 + iPrefixLen);
+              ++iPrefixLen;
+            }
+            auto pExpanded = new node4(Prefix, iPrefixLen);
+            set_child(pExpanded, _key_byte(x, depth + 1 + iPrefixLen), _from_leaf(pLeaf));
+            set_child(pExpanded, _key_byte(pOther->_key, depth + 1 + iPrefixLen), child);
+            set_child(pNode, Key, from_node(pExpanded));
+            return result::success;
+          }
+          pParent = pNode;
+          ParentKey = Key;
+          pNode = as_node(child);
+          ++depth;
+        }
+      }
+
+      result _remove(intrinsic_type x){
+        using namespace _::radix_map;
+        node_base * pNode = _root;
+        size_t depth = 0;
+        forever{
+          for (uint8_t i = 0; i < pNode->_prefix_len; ++i, ++depth){
+            if (pNode->_prefix[i] != _key_byte(x, depth)){
+              return result::failure;
+            }
+          }
+          auto Key = _key_byte(x, depth);
+          auto child = find_child(pNode, Key);
+          if (!child){
+            return result::failure;
+          }
+          if (is_leaf(child)){
+            if (x != _as_leaf(child)->_key){
+              return result::failure;
+            }
+            spin_lock::scope_locker oNodeLock(pNode->_lock);
+            if (pNode->_obsolete.load() || find_child(pNode, Key) != child){
+              return result::retry;
+            }
+            set_child(pNode, Key, 0);
+            _retire(_as_leaf(child));
+            return result::success;
+          }
+          pNode = as_node(child);
+          ++depth;
+        }
+      }
+
+      node_base * const _root;
+    };
+
+    ///@}
+  }
+}
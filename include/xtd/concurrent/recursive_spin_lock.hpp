@@ -5,21 +5,26 @@ Recursive spin lock
 
 #pragma once
 
-#include <xtd/concurrent/concurrent.hpp>
+#include <xtd/concurrent/lock_profile.hpp>
+#include <xtd/concurrent/wait_policy.hpp>
+
+#include <atomic>
 
 namespace xtd{
   namespace concurrent {
     namespace _ {
-      template<typename _wait_policy_t = null_wait_policy>
+      template<typename _wait_policy_t = null_wait_policy, typename _profile_policy_t = null_lock_profile>
       class recursive_spin_lock_base{
         using wait_policy_type = _wait_policy_t;
+        using profile_policy_type = _profile_policy_t;
         using hash_type = std::hash<std::thread::id>;
         std::atomic<size_t> _lock;
         hash_type _hash;
         uint32_t _lock_count;
         wait_policy_type _wait_policy;
+        profile_policy_type _profile;
       public:
-        using scope_locker = xtd::concurrent::scope_locker<recursive_spin_lock_base<_wait_policy_t>>;
+        using scope_locker = xtd::concurrent::scope_locker<recursive_spin_lock_base<_wait_policy_t, _profile_policy_t>>;
 
         ~recursive_spin_lock_base() = default;
 
@@ -29,29 +34,49 @@ namespace xtd{
 
         recursive_spin_lock_base(recursive_spin_lock_base &&) = delete;
 
-        bool try_lock() {
-          size_t bad_id = -1;
-          auto ThisID = _hash(std::this_thread::get_id());
-          if (!_lock.compare_exchange_strong(bad_id, ThisID) && !(_lock.compare_exchange_strong(ThisID, ThisID))) {
+        bool try_lock(const source_location& oWhere = source_location::current()) {
+          auto oToken = _profile.begin_wait();
+          if (!_try_lock()) {
             return false;
           }
-          ++_lock_count;
+          _profile.acquired(oToken, oWhere);
           return true;
         }
 
-        void lock() {
-          while (!try_lock()) {
+        void lock(const source_location& oWhere = source_location::current()) {
+          auto oToken = _profile.begin_wait();
+          while (!_try_lock()) {
+            _profile.spin(oToken);
             _wait_policy();
           }
+          _profile.acquired(oToken, oWhere);
         }
 
         void unlock() {
+          _profile.released();
           if (0 == --_lock_count) {
             _lock.store(-1);
           }
         }
+
+        /// contention profile of the lock
+        profile_policy_type& profile(){ return _profile; }
+
+      private:
+        bool _try_lock() {
+          size_t bad_id = -1;
+          auto ThisID = _hash(std::this_thread::get_id());
+          if (!_lock.compare_exchange_strong(bad_id, ThisID) && !(_lock.compare_exchange_strong(ThisID, ThisID))) {
+            return false;
+          }
+          ++_lock_count;
+          return true;
+        }
       };
     }
     using recursive_spin_lock = _::recursive_spin_lock_base<null_wait_policy>;
+    /// recursive spin lock with a chosen wait and profile policy
+    template <typename _WaitPolicyT = null_wait_policy, typename _ProfilePolicyT = null_lock_profile>
+    using recursive_spin_lock_base = _::recursive_spin_lock_base<_WaitPolicyT, _ProfilePolicyT>;
   }
 }
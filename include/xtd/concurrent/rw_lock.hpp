@@ -4,30 +4,39 @@ Simple multi reader/single writer spin lock
 */
 #pragma once
 
-#include <xtd/concurrent/concurrent.hpp>
+#include <xtd/concurrent/lock_profile.hpp>
+#include <xtd/concurrent/wait_policy.hpp>
+
+#include <atomic>
 
 namespace xtd{
   namespace concurrent{
     /** A multiple reader/single writer spin lock
     supports 2^31 simultaneous readers
     @tparam _WaitPolicyT behavior when spinning
+    @tparam _ProfilePolicyT null_lock_profile or lock_profile to record contention
     */
-    template <typename _WaitPolicyT>
+    template <typename _WaitPolicyT, typename _ProfilePolicyT = null_lock_profile>
     class rw_lock_base{
       std::atomic<uint32_t> _lock;
       static constexpr uint32_t write_lock_bit = 0x80000000;
       static constexpr uint32_t read_bits_mask = ~write_lock_bit;
       _WaitPolicyT _WaitPolicy;
+      _ProfilePolicyT _Profile;
     public:
       using wait_policy_type = _WaitPolicyT;
+      using profile_policy_type = _ProfilePolicyT;
       rw_lock_base(wait_policy_type oWait = wait_policy_type()) : _lock(0), _WaitPolicy(oWait){}
       ///Returns the number of active read locks
       uint32_t readers() const{
         return _lock.load() & read_bits_mask;
       }
 
-      ///Frees the write lock or decrements the reader count
+      /** Frees the write lock or decrements the reader count
+      Threads parked by the wait policy are woken when the lock becomes free.
+      */
       void unlock(){
+        _Profile.released();
         forever{
           auto iOriginal = _lock.load();
           if (write_lock_bit == iOriginal){
@@ -35,49 +44,78 @@ namespace xtd{
             break;
           } else{
             if (_lock.compare_exchange_strong(iOriginal, iOriginal - 1)){
+              if (1 != iOriginal){
+                return;
+              }
               break;
             }
           }
           _WaitPolicy();
         }
+        _::wait::notify(_WaitPolicy, _lock, true);
       }
       /// Acquires a shared read lock
-      void lock_read(){
+      void lock_read(const source_location& oWhere = source_location::current()){
+        auto oToken = _Profile.begin_wait();
         forever{
           auto iOriginal = _lock.load() & read_bits_mask;
           if (_lock.compare_exchange_strong(iOriginal, 1 + iOriginal)){
             break;
           }
-          _WaitPolicy();
+          _Profile.spin(oToken);
+          if (iOriginal & write_lock_bit){
+            _::wait::wait(_WaitPolicy, _lock, iOriginal);
+          } else{
+            _WaitPolicy();
+          }
         }
+        _Profile.acquired(oToken, oWhere);
       }
       /** tries to acquire a shared read lock
       @return true if the lock was acquired
       */
-      bool try_lock_read(){
+      bool try_lock_read(const source_location& oWhere = source_location::current()){
+        auto oToken = _Profile.begin_wait();
         auto iOriginal = _lock.load() & read_bits_mask;
-        return _lock.compare_exchange_strong(iOriginal, 1 + iOriginal);
+        if (!_lock.compare_exchange_strong(iOriginal, 1 + iOriginal)){
+          return false;
+        }
+        _Profile.acquired(oToken, oWhere);
+        return true;
       }
       ///acquires a write lock for exclusive access
-      void lock_write(){
-        uint32_t iOriginal = 0;
-        while (!_lock.compare_exchange_strong(iOriginal, write_lock_bit)){
-          _WaitPolicy();
+      void lock_write(const source_location& oWhere = source_location::current()){
+        auto oToken = _Profile.begin_wait();
+        forever{
+          uint32_t iOriginal = 0;
+          if (_lock.compare_exchange_strong(iOriginal, write_lock_bit)){
+            break;
+          }
+          _Profile.spin(oToken);
+          _::wait::wait(_WaitPolicy, _lock, iOriginal);
         }
+        _Profile.acquired(oToken, oWhere);
       }
       /** attempts to acquire a write lock for exclusive access
       @returns true if the lock was acquired
       */
-      bool try_lock_write(){
+      bool try_lock_write(const source_location& oWhere = source_location::current()){
+        auto oToken = _Profile.begin_wait();
         uint32_t iOriginal = 0;
-        return _lock.compare_exchange_strong(iOriginal, write_lock_bit);
+        if (!_lock.compare_exchange_strong(iOriginal, write_lock_bit)){
+          return false;
+        }
+        _Profile.acquired(oToken, oWhere);
+        return true;
       }
+      /// contention profile of the lock
+      profile_policy_type& profile(){ return _Profile; }
       /// RAII pattern to acquire and release a read lock
       class scope_read{
         rw_lock_base& _Lock;
       public:
-        explicit scope_read(rw_lock_base& oLock) : _Lock(oLock){
-          _Lock.lock_read();
+        explicit scope_read(rw_lock_base& oLock, const source_location& oWhere = source_location::current()) : _Lock(oLock){
+          _Lock.lock_read(oWhere);
         }
         ~scope_read(){
           _Lock.unlock();
@@ -87,8 +125,8 @@ namespace xtd{
       class scope_write{
         rw_lock_base& _Lock;
       public:
-        explicit scope_write(rw_lock_base& oLock) : _Lock(oLock){
-          _Lock.lock_write();
+        explicit scope_write(rw_lock_base& oLock, const source_location& oWhere = source_location::current()) : _Lock(oLock){
+          _Lock.lock_write(oWhere);
         }
         ~scope_write(){
           _Lock.unlock();
@@ -4,49 +4,67 @@ simple user mode spin lock based on std::atomic
 */
 #pragma once
 
-#include <xtd/concurrent/concurrent.hpp>
+#include <xtd/concurrent/lock_profile.hpp>
+#include <xtd/concurrent/wait_policy.hpp>
 
 #include <atomic>
 
 namespace xtd{
   namespace concurrent{
-    ///A single owner spinning lock
-    template <typename _WaitPolicyT = null_wait_policy>
+    /** A single owner spinning lock
+    @tparam _WaitPolicyT behavior when spinning
+    @tparam _ProfilePolicyT null_lock_profile or lock_profile to record contention
+    */
+    template <typename _WaitPolicyT = null_wait_policy, typename _ProfilePolicyT = null_lock_profile>
     class spin_lock_base {
       std::atomic < uint32_t > _lock;
     public:
       using wait_policy_type = _WaitPolicyT;
+      using profile_policy_type = _ProfilePolicyT;
       static constexpr uint32_t LockedValue = 0x80000000;
-      using scope_locker = xtd::concurrent::scope_locker<spin_lock_base<_WaitPolicyT>>;
+      using scope_locker = xtd::concurrent::scope_locker<spin_lock_base<_WaitPolicyT, _ProfilePolicyT>>;
 
       ~spin_lock_base() = default;
       spin_lock_base(wait_policy_type oWait = wait_policy_type()) : _lock(0), _WaitPolicy(oWait){};
       spin_lock_base(const spin_lock_base&) = delete;
       spin_lock_base(spin_lock_base&&) = delete;
       ///Acquires the lock
-      void lock(){
+      void lock(const source_location& oWhere = source_location::current()){
+        auto oToken = _Profile.begin_wait();
         forever{
           uint32_t compare = 0;
           if (_lock.compare_exchange_strong(compare, LockedValue)){
             break;
           }
-          _WaitPolicy();
+          _Profile.spin(oToken);
+          _::wait::wait(_WaitPolicy, _lock, compare);
         }
+        _Profile.acquired(oToken, oWhere);
       }
-      /// Releases the lock
+      /// Releases the lock and wakes a waiter parked by the wait policy
       void unlock(){
+        _Profile.released();
         _lock.store(0);
+        _::wait::notify(_WaitPolicy, _lock, false);
       }
       /** Attempts to acquire the lock
       @return true if the lock was acquired
       */
-      bool try_lock(){
+      bool try_lock(const source_location& oWhere = source_location::current()){
+        auto oToken = _Profile.begin_wait();
         uint32_t compare = 0;
-        return (_lock.compare_exchange_strong(compare, LockedValue));
+        if (!_lock.compare_exchange_strong(compare, LockedValue)){
+          return false;
+        }
+        _Profile.acquired(oToken, oWhere);
+        return true;
       }
+      /// contention profile of the lock
+      profile_policy_type& profile(){ return _Profile; }
 
     private:
       wait_policy_type _WaitPolicy;
+      profile_policy_type _Profile;
     };
 
     using spin_lock = spin_lock_base<null_wait_policy>;
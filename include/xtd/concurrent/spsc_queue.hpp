@@ -0,0 +1,215 @@
+/** @file
+one thread pushes and another pops items from a fixed capacity FIFO ring
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+The producer owns the back index and the consumer owns the front index, each on its own cache line. Each side keeps a
+cached copy of the other side's index and only reloads it when the ring looks full or empty, so in steady state
+neither side reads a cache line the other is writing. Items staged by the producer become visible to the consumer
+with a single release store of the back index, and the consumer frees any number of consumed items with a single
+release store of the front index.
+*/
+
+#pragma once
+#include <xtd/xtd.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include <xtd/concurrent/wait_policy.hpp>
+
+namespace xtd{
+
+  namespace concurrent{
+    /** @addtogroup Concurrent
+    @{*/
+
+    /** A wait-free single-producer single-consumer FIFO ring
+    Only one thread at a time may push and only one thread at a time may pop. Items are constructed in place in the
+    ring and may be consumed in place so large items are never copied.
+    @tparam _ValueT type of value contained in the queue
+    @tparam _Capacity maximum number of items. Must be a power of two.
+    @tparam _WaitPolicyT policy invoked while push waits for a free slot and pop waits for an item
+    */
+    template <typename _ValueT, size_t _Capacity, typename _WaitPolicyT = null_wait_policy>
+    class spsc_queue{
+      static_assert(_Capacity && !(_Capacity & (_Capacity - 1)), "spsc_queue capacity must be a power of two");
+      static constexpr size_t mask = _Capacity - 1;
+      using storage_type = typename std::aligned_storage<sizeof(_ValueT), alignof(_ValueT)>::type;
+
+    public:
+      using value_type = _ValueT;
+      using wait_policy_type = _WaitPolicyT;
+
+      static constexpr size_t capacity = _Capacity;
+
+      spsc_queue(wait_policy_type oWait = wait_policy_type()) : _wait_policy(oWait){}
+
+      ~spsc_queue(){
+        for (auto iPosition = _front.load(); iPosition != _staged; ++iPosition){
+          _at(iPosition)->~value_type();
+        }
+      }
+
+      spsc_queue(const spsc_queue&) = delete;
+      spsc_queue& operator=(const spsc_queue&) = delete;
+
+      /// number of published items. approximate unless called by the producer or consumer
+      size_t size() const{
+        return _back.load(std::memory_order_acquire) - _front.load(std::memory_order_acquire);
+      }
+
+      /// true if no items are published. approximate unless called by the producer or consumer
+      bool empty() const{ return !size(); }
+
+      /** constructs an item in the next free slot without publishing it. producer only
+      Staged items become visible to the consumer on the next commit_batch or publishing push.
+      @returns false if the ring is full
+      */
+      template <typename ... _ArgTs>
+      bool try_stage(_ArgTs&&...oArgs){
+        if (_staged - _front_cache == _Capacity){
+          _front_cache = _front.load(std::memory_order_acquire);
+          if (_staged - _front_cache == _Capacity){
+            return false;
+          }
+        }
+        new (_at(_staged)) value_type(std::forward<_ArgTs>(oArgs)...);
+        ++_staged;
+        return true;
+      }
+
+      /** publishes every staged item with a single release store. producer only
+      @returns number of items published
+      */
+      size_t commit_batch(){
+        auto iBack = _back.load(std::memory_order_relaxed);
+        if (iBack != _staged){
+          _back.store(_staged, std::memory_order_release);
+        }
+        return _staged - iBack;
+      }
+
+      /// constructs and publishes an item unless the ring is full. producer only
+      template <typename ... _ArgTs>
+      bool try_emplace(_ArgTs&&...oArgs){
+        if (!try_stage(std::forward<_ArgTs>(oArgs)...)){
+          return false;
+        }
+        commit_batch();
+        return true;
+      }
+
+      bool try_push(const value_type& value){
+        return try_emplace(value);
+      }
+
+      bool try_push(value_type&& value){
+        return try_emplace(std::move(value));
+      }
+
+      /// constructs and publishes an item waiting while the ring is full. producer only
+      template <typename ... _ArgTs>
+      void emplace(_ArgTs&&...oArgs){
+        while (_staged - _front_cache == _Capacity){
+          _front_cache = _front.load(std::memory_order_acquire);
+          if (_staged - _front_cache == _Capacity){
+            commit_batch();
+            _wait_policy();
+          }
+        }
+        try_emplace(std::forward<_ArgTs>(oArgs)...);
+      }
+
+      void push(const value_type& value){
+        emplace(value);
+      }
+
+      void push(value_type&& value){
+        emplace(std::move(value));
+      }
+
+      /// pops the item at the front. consumer only
+      bool try_pop(value_type& oRet){
+        auto iFront = _front.load(std::memory_order_relaxed);
+        if (!_available(iFront)){
+          return false;
+        }
+        auto pValue = _at(iFront);
+        oRet = std::move(*pValue);
+        pValue->~value_type();
+        _front.store(1 + iFront, std::memory_order_release);
+        return true;
+      }
+
+      /// pops the item at the front waiting until one is published. consumer only
+      value_type pop(){
+        auto iFront = _front.load(std::memory_order_relaxed);
+        while (!_available(iFront)){
+          _wait_policy();
+        }
+        auto pValue = _at(iFront);
+        value_type oRet(std::move(*pValue));
+        pValue->~value_type();
+        _front.store(1 + iFront, std::memory_order_release);
+        return oRet;
+      }
+
+      /** passes up to iMax published items to fn in place then frees their slots with a single release store. consumer only
+      If fn throws, the items already consumed are freed and the item fn threw on remains at the front.
+      @param fn callable invoked as fn(value_type&) for each item from the front
+      @param iMax maximum number of items to consume
+      @returns number of items consumed
+      */
+      template <typename _FnT>
+      size_t consume(_FnT&& fn, size_t iMax = _Capacity){
+        auto iFront = _front.load(std::memory_order_relaxed);
+        auto iCount = std::min(_available(iFront), iMax);
+        size_t i = 0;
+        try{
+          for (; i < iCount; ++i){
+            auto pValue = _at(iFront + i);
+            fn(*pValue);
+            pValue->~value_type();
+          }
+        } catch (...){
+          _front.store(iFront + i, std::memory_order_release);
+          throw;
+        }
+        if (iCount){
+          _front.store(iFront + iCount, std::memory_order_release);
+        }
+        return iCount;
+      }
+
+    private:
+
+      value_type * _at(size_t iPosition){
+        return reinterpret_cast<value_type*>(&_slots[iPosition & mask]);
+      }
+
+      /// number of published items from the front, reloading the producer's index only when the cached copy shows none
+      size_t _available(size_t iFront){
+        if (iFront == _back_cache){
+          _back_cache = _back.load(std::memory_order_acquire);
+        }
+        return _back_cache - iFront;
+      }
+
+      // producer
+      alignas(64) std::atomic<size_t> _back{0};
+      size_t _staged = 0;
+      size_t _front_cache = 0;
+      wait_policy_type _wait_policy;
+      // consumer
+      alignas(64) std::atomic<size_t> _front{0};
+      size_t _back_cache = 0;
+      alignas(64) storage_type _slots[_Capacity];
+    };
+
+    ///@}
+  }
+}
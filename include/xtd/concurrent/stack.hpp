@@ -7,21 +7,110 @@ concurrently push and pop items in a FILO stack
 #include <xtd/concurrent/concurrent.hpp>
 
 #include <atomic>
+#include <cstdint>
+
+#include <xtd/concurrent/epoch_domain.hpp>
+#include <xtd/concurrent/striped_counter.hpp>
 
 namespace xtd{
  
   namespace concurrent{
     /** @addtogroup Concurrent
     @{*/
+
+    /** memory and contention of a stack
+    The node count is measured by walking the stack so it is approximate while other threads push and pop. The
+    contention counters accumulate from the construction of the stack.
+    */
+    struct stack_stats{
+      size_t nodes = 0; ///< items in the stack
+      size_t bytes = 0; ///< memory of the nodes. excludes memory the values own
+      uint64_t push_retries = 0; ///< pushes that lost a race to change the top of the stack
+      uint64_t pop_retries = 0; ///< pops that lost a race to change the top of the stack
+      uint64_t eliminations = 0; ///< pushes handed directly to a pop by the elimination policy
+    };
+
+    /// elimination policy of a stack that never eliminates
+    struct null_elimination_policy{
+      bool offer(void *){ return false; }
+      void * take(){ return nullptr; }
+    };
+
+    /** elimination policy that pairs colliding pushes and pops in a side array
+    A push that loses the race for the top of the stack offers its node in a random slot and waits briefly. A pop that
+    loses the race takes a node offered in a random slot. Paired operations cancel out without touching the top of the
+    stack, so throughput rises with contention instead of falling.
+    @tparam _SlotCount number of slots. each slot occupies its own cache line
+    @tparam _Spins number of times an offering push checks its slot before withdrawing the node
+    */
+    template <size_t _SlotCount = 16, size_t _Spins = 128>
+    class elimination_array{
+      static constexpr uintptr_t taken = 1; ///< left in a slot by a pop so the address of the taken node cannot reappear until its push has seen it
+
+      struct alignas(64) slot{
+        slot() : _node(0){}
+        std::atomic<uintptr_t> _node;
+      };
+      slot _slots[_SlotCount];
+
+      static size_t _random(){
+        static thread_local uint32_t _state = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&_state) >> 4) | 1;
+        _state ^= _state << 13;
+        _state ^= _state >> 17;
+        _state ^= _state << 5;
+        return _state % _SlotCount;
+      }
+
+    public:
+      elimination_array() = default;
+      elimination_array(const elimination_array&) = delete;
+      elimination_array& operator=(const elimination_array&) = delete;
+
+      /// offers a node to a pop. returns true if a pop took it
+      bool offer(void * pNode){
+        auto & oSlot = _slots[_random()];
+        uintptr_t iEmpty = 0;
+        auto iNode = reinterpret_cast<uintptr_t>(pNode);
+        if (!oSlot._node.compare_exchange_strong(iEmpty, iNode, std::memory_order_release, std::memory_order_relaxed)){
+          return false;
+        }
+        for (size_t i = 0; i < _Spins; ++i){
+          if (taken == oSlot._node.load(std::memory_order_acquire)){
+            oSlot._node.store(0, std::memory_order_relaxed);
+            return true;
+          }
+        }
+        if (oSlot._node.compare_exchange_strong(iNode, 0, std::memory_order_relaxed)){
+          return false;
+        }
+        oSlot._node.store(0, std::memory_order_relaxed);
+        return true;
+      }
+
+      /// takes a node offered by a push or returns nullptr
+      void * take(){
+        auto & oSlot = _slots[_random()];
+        auto iNode = oSlot._node.load(std::memory_order_acquire);
+        if (iNode <= taken || !oSlot._node.compare_exchange_strong(iNode, taken, std::memory_order_acquire, std::memory_order_relaxed)){
+          return nullptr;
+        }
+        return reinterpret_cast<void*>(iNode);
+      }
+    };
+
     /** A lock-free LIFO stack
-    multiple threads can push and pop items concurrently
+    multiple threads can push and pop items concurrently. popped nodes are retired to epoch_domain::global() so a
+    concurrent pop never reads a deleted node and a node address cannot be reused while another pop holds it (ABA).
     @tparam _value_t type of value contained in the stack. Must be copy constructible.
+    @tparam _wait_policy_t policy invoked after a push loses a race and while pop waits for an item
+    @tparam _elimination_policy_t policy pairing pushes and pops that lose a race. null_elimination_policy or elimination_array
     */
-    template <typename _value_t, typename _wait_policy_t = null_wait_policy> class stack{
+    template <typename _value_t, typename _wait_policy_t = null_wait_policy, typename _elimination_policy_t = null_elimination_policy> class stack{
     public:
 
       using value_type = _value_t;
       using wait_policy_type = _wait_policy_t;
+      using elimination_policy_type = _elimination_policy_t;
 
       stack(wait_policy_type oWait = wait_policy_type()) : _root(nullptr), _wait_policy(oWait){}
 
@@ -46,14 +135,23 @@ namespace xtd{
 
       stack& operator=(const stack&) = delete;
 
-      bool try_pop(value_type& oRet){        
+      bool try_pop(value_type& oRet){
+        epoch_domain::guard oGuard;
         auto oTmp = _root.load();
         if (!oTmp) return false;
         if (!_root.compare_exchange_strong(oTmp, oTmp->_next)){
+          _counters.add(pop_failures);
+          // a node taken from a push was never in the stack so no other thread can reference it
+          if (auto pNode = static_cast<node*>(_elimination_policy.take())){
+            _counters.add(eliminations);
+            oRet = std::move(pNode->_value);
+            delete pNode;
+            return true;
+          }
           return false;
         }
-        oRet = oTmp->_value;
-        delete oTmp;
+        oRet = std::move(oTmp->_value);
+        epoch_domain::global().retire(oTmp);
         return true;
       }
       
@@ -64,6 +162,10 @@ namespace xtd{
           if (_root.compare_exchange_strong(pNode->_next, pNode)){
             break;
           }
+          _counters.add(push_failures);
+          if (_elimination_policy.offer(pNode)){
+            return;
+          }
           _wait_policy();
         }
       }
@@ -76,7 +178,30 @@ namespace xtd{
         return oRet;
       }
 
+      /** measures the memory of the stack and reads its contention counters
+      @returns the measurements
+      */
+      stack_stats stats() const{
+        epoch_domain::guard oGuard;
+        stack_stats oRet;
+        for (auto pNode = _root.load(); pNode; pNode = pNode->_next){
+          ++oRet.nodes;
+        }
+        oRet.bytes = oRet.nodes * sizeof(node);
+        oRet.push_retries = _counters.get(push_failures);
+        oRet.pop_retries = _counters.get(pop_failures);
+        oRet.eliminations = _counters.get(eliminations);
+        return oRet;
+      }
+
     private:
+      enum counter{
+        push_failures,
+        pop_failures,
+        eliminations,
+        counter_count,
+      };
+
       struct node{
         using pointer = node *;
         using atomic_ptr = std::atomic<pointer>;
@@ -91,6 +216,8 @@ namespace xtd{
       };
       typename node::atomic_ptr _root;
       _wait_policy_t _wait_policy;
+      _elimination_policy_t _elimination_policy;
+      striped_counter<counter_count> _counters;
     };
     ///@}
   }
@@ -0,0 +1,83 @@
+/** @file
+counters incremented by many threads and summed only when read
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+
+#pragma once
+#include <xtd/xtd.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace xtd{
+
+  namespace concurrent{
+
+#if (!DOXY_INVOKED)
+    namespace _{
+      namespace striped_counter{
+
+        /// stripe of the calling thread. threads are assigned stripes round robin as they first count
+        inline size_t thread_stripe(){
+          static std::atomic<size_t> _next(0);
+          static thread_local size_t _stripe = _next++;
+          return _stripe;
+        }
+
+      }
+    }
+#endif
+
+    /** @addtogroup Concurrent
+    @{*/
+
+    /** a set of counters split into cache line sized stripes
+    Each thread increments the counters of its own stripe so counting threads rarely share a cache line. A read sums
+    every stripe and is approximate while other threads are counting.
+    @tparam _CounterCount number of counters in the set
+    @tparam _StripeCount number of stripes the threads are spread over
+    */
+    template <size_t _CounterCount, size_t _StripeCount = 16>
+    class striped_counter{
+      struct alignas(64) stripe{
+        std::atomic<uint64_t> _values[_CounterCount];
+      };
+      stripe _stripes[_StripeCount];
+
+    public:
+      static constexpr size_t counter_count = _CounterCount;
+
+      striped_counter(){
+        reset();
+      }
+      striped_counter(const striped_counter&) = delete;
+      striped_counter& operator=(const striped_counter&) = delete;
+
+      /// adds to a counter in the calling thread's stripe
+      void add(size_t iCounter, uint64_t iValue = 1){
+        _stripes[_::striped_counter::thread_stripe() % _StripeCount]._values[iCounter].fetch_add(iValue, std::memory_order_relaxed);
+      }
+
+      /// sum of a counter over all stripes
+      uint64_t get(size_t iCounter) const{
+        uint64_t iRet = 0;
+        for (auto & oStripe : _stripes){
+          iRet += oStripe._values[iCounter].load(std::memory_order_relaxed);
+        }
+        return iRet;
+      }
+
+      /// zeroes every counter. counts added concurrently may be lost
+      void reset(){
+        for (auto & oStripe : _stripes){
+          for (auto & oValue : oStripe._values){
+            oValue.store(0, std::memory_order_relaxed);
+          }
+        }
+      }
+    };
+
+    ///@}
+  }
+}
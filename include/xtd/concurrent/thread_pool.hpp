@@ -0,0 +1,454 @@
+/** @file
+work stealing thread pool
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+Each worker owns a Chase-Lev deque. Tasks submitted by a worker are pushed onto the bottom of its own deque and the
+worker pops them from the bottom, so recently spawned tasks run while their data is still in cache. An idle worker
+steals from the top of another worker's deque, taking the oldest and usually largest piece of work. Tasks submitted
+by threads outside the pool go to a shared injection queue. Workers that find no work sleep on a condition variable
+and are woken by the next submission.
+*/
+#pragma once
+#include <xtd/xtd.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+  #include <pthread.h>
+  #include <sched.h>
+#endif
+
+#include <xtd/concurrent/wait_policy.hpp>
+
+namespace xtd{
+  namespace concurrent{
+
+    class thread_pool;
+
+#if (!DOXY_INVOKED)
+    namespace _{
+      namespace thread_pool{
+
+        struct task{
+          virtual ~task() = default;
+          virtual void run() = 0;
+        };
+
+        template <typename _FnT>
+        struct task_impl : task{
+          explicit task_impl(_FnT&& fn) : _fn(std::move(fn)){}
+          void run() override{ _fn(); }
+          _FnT _fn;
+        };
+
+        template <typename _FnT>
+        task * make_task(_FnT&& fn){
+          return new task_impl<typename std::decay<_FnT>::type>(typename std::decay<_FnT>::type(std::forward<_FnT>(fn)));
+        }
+
+        /** Chase-Lev work stealing deque of tasks
+        The owning worker pushes and takes at the bottom and other workers steal from the top. A full ring is replaced by
+        one twice the size. Replaced rings are kept until the deque is destroyed since a thief may still be reading one.
+        */
+        class deque{
+          struct ring{
+            explicit ring(int64_t iSize) : _size(iSize), _items(new std::atomic<task*>[iSize]){}
+            task * get(int64_t i) const{ return _items[i & (_size - 1)].load(std::memory_order_relaxed); }
+            void put(int64_t i, task * pTask){ _items[i & (_size - 1)].store(pTask, std::memory_order_relaxed); }
+            const int64_t _size;
+            std::unique_ptr<std::atomic<task*>[]> _items;
+          };
+
+          alignas(64) std::atomic<int64_t> _top;
+          alignas(64) std::atomic<int64_t> _bottom;
+          std::atomic<ring*> _ring;
+          std::vector<std::unique_ptr<ring>> _rings;
+
+        public:
+          deque() : _top(0), _bottom(0){
+            _rings.emplace_back(new ring(256));
+            _ring.store(_rings.back().get());
+          }
+          deque(const deque&) = delete;
+          deque& operator=(const deque&) = delete;
+
+          /// owner only
+          void push(task * pTask){
+            auto iBottom = _bottom.load(std::memory_order_relaxed);
+            auto iTop = _top.load(std::memory_order_acquire);
+            auto pRing = _ring.load(std::memory_order_relaxed);
+            if (iBottom - iTop > pRing->_size - 1){
+              pRing = _grow(pRing, iTop, iBottom);
+            }
+            pRing->put(iBottom, pTask);
+            std::atomic_thread_fence(std::memory_order_release);
+            _bottom.store(1 + iBottom, std::memory_order_relaxed);
+          }
+
+          /// owner only. returns nullptr if the deque is empty
+          task * take(){
+            auto iBottom = _bottom.load(std::memory_order_relaxed) - 1;
+            auto pRing = _ring.load(std::memory_order_relaxed);
+            _bottom.store(iBottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto iTop = _top.load(std::memory_order_relaxed);
+            if (iTop > iBottom){
+              _bottom.store(1 + iBottom, std::memory_order_relaxed);
+              return nullptr;
+            }
+            auto pRet = pRing->get(iBottom);
+            if (iTop == iBottom){
+              // the last task may be stolen concurrently
+              if (!_top.compare_exchange_strong(iTop, 1 + iTop, std::memory_order_seq_cst, std::memory_order_relaxed)){
+                pRet = nullptr;
+              }
+              _bottom.store(1 + iBottom, std::memory_order_relaxed);
+            }
+            return pRet;
+          }
+
+          /// any thread. returns nullptr if the deque is empty or another thread won the race for the top task
+          task * steal(){
+            auto iTop = _top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto iBottom = _bottom.load(std::memory_order_acquire);
+            if (iTop >= iBottom){
+              return nullptr;
+            }
+            auto pRet = _ring.load(std::memory_order_acquire)->get(iTop);
+            if (!_top.compare_exchange_strong(iTop, 1 + iTop, std::memory_order_seq_cst, std::memory_order_relaxed)){
+              return nullptr;
+            }
+            return pRet;
+          }
+
+          /// approximate number of tasks
+          size_t size() const{
+            auto iSize = _bottom.load(std::memory_order_relaxed) - _top.load(std::memory_order_relaxed);
+            return static_cast<size_t>(iSize > 0 ? iSize : 0);
+          }
+
+        private:
+          ring * _grow(ring * pRing, int64_t iTop, int64_t iBottom){
+            _rings.emplace_back(new ring(2 * pRing->_size));
+            auto pRet = _rings.back().get();
+            for (auto i = iTop; i < iBottom; ++i){
+              pRet->put(i, pRing->get(i));
+            }
+            _ring.store(pRet, std::memory_order_release);
+            return pRet;
+          }
+        };
+
+        struct worker{
+          deque _tasks;
+          std::thread _thread;
+          uint32_t _random;
+        };
+
+        /// the pool and worker index of the calling thread or nullptr if it is not a worker
+        struct current_worker{
+          xtd::concurrent::thread_pool * _pool = nullptr;
+          size_t _index = 0;
+
+          static current_worker& instance(){
+            static thread_local current_worker _instance;
+            return _instance;
+          }
+        };
+
+        /// pins the calling thread to a processor. returns false where pinning is unsupported
+        inline bool pin_thread(size_t iProcessor){
+#if defined(__linux__)
+          cpu_set_t oSet;
+          CPU_ZERO(&oSet);
+          CPU_SET(iProcessor % CPU_SETSIZE, &oSet);
+          return 0 == pthread_setaffinity_np(pthread_self(), sizeof(oSet), &oSet);
+#elif (XTD_OS_WINDOWS & XTD_OS)
+          return 0 != SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << (iProcessor % (8 * sizeof(DWORD_PTR))));
+#else
+          (void)iProcessor;
+          return false;
+#endif
+        }
+
+      }
+    }
+#endif
+
+    /** @addtogroup Concurrent
+    @{*/
+
+    /** A work stealing thread pool
+    Tasks submitted from a worker run on the same worker unless an idle worker steals them, so recursive and fork-join
+    work stays local. The destructor runs every task that was submitted before it returns.
+    */
+    class thread_pool{
+      using task = _::thread_pool::task;
+      using worker = _::thread_pool::worker;
+      using current_worker = _::thread_pool::current_worker;
+
+    public:
+      /** starts the workers
+      @param iThreads number of workers. defaults to the number of hardware threads
+      @param bPin pins worker i to processor i modulo the number of processors
+      */
+      explicit thread_pool(size_t iThreads = std::max<size_t>(1, std::thread::hardware_concurrency()), bool bPin = false)
+        : _workers(std::max<size_t>(1, iThreads)), _pending(0), _sleeping(0), _stop(false)
+      {
+        for (size_t i = 0; i < _workers.size(); ++i){
+          _workers[i]._random = static_cast<uint32_t>(i * 2654435761U) | 1;
+        }
+        for (size_t i = 0; i < _workers.size(); ++i){
+          _workers[i]._thread = std::thread([this, i, bPin](){
+            if (bPin){
+              _::thread_pool::pin_thread(i);
+            }
+            _run_worker(i);
+          });
+        }
+      }
+
+      ~thread_pool(){
+        {
+          std::lock_guard<std::mutex> oLock(_lock);
+          _stop = true;
+        }
+        _wake.notify_all();
+        for (auto & oWorker : _workers){
+          oWorker._thread.join();
+        }
+      }
+
+      thread_pool(const thread_pool&) = delete;
+      thread_pool& operator=(const thread_pool&) = delete;
+
+      /// process wide pool shared by the library. created on first use with one worker per hardware thread
+      static thread_pool& global(){
+        static thread_pool _global;
+        return _global;
+      }
+
+      /// number of workers
+      size_t size() const{ return _workers.size(); }
+
+      /// index of the calling worker in this pool or size() if the calling thread is not one of its workers
+      size_t worker_index() const{
+        auto & oCurrent = current_worker::instance();
+        return (this == oCurrent._pool ? oCurrent._index : size());
+      }
+
+      /// number of tasks waiting to run. approximate while tasks are submitted and run
+      size_t pending() const{ return _pending.load(std::memory_order_relaxed); }
+
+      /** queues a task without a result
+      Exceptions escaping the task are discarded.
+      */
+      template <typename _FnT>
+      void post(_FnT&& fn){
+        _push(_::thread_pool::make_task([oFn = std::forward<_FnT>(fn)]() mutable{
+          try{
+            oFn();
+          } catch (...){}
+        }));
+      }
+
+      /** queues a task
+      @returns future receiving the result or exception of fn(oArgs...)
+      */
+      template <typename _FnT, typename ... _ArgTs>
+      auto submit(_FnT&& fn, _ArgTs&&...oArgs) -> std::future<typename std::result_of<typename std::decay<_FnT>::type(typename std::decay<_ArgTs>::type...)>::type>{
+        using result_type = typename std::result_of<typename std::decay<_FnT>::type(typename std::decay<_ArgTs>::type...)>::type;
+        std::packaged_task<result_type()> oTask(std::bind(std::forward<_FnT>(fn), std::forward<_ArgTs>(oArgs)...));
+        auto oRet = oTask.get_future();
+        _push(_::thread_pool::make_task(std::move(oTask)));
+        return oRet;
+      }
+
+      /** runs one queued task on the calling thread
+      Threads waiting for tasks of the pool call this to help instead of blocking a worker.
+      @returns false if no task was found
+      */
+      bool try_run_one(){
+        auto pTask = _find(worker_index());
+        if (!pTask){
+          return false;
+        }
+        _execute(pTask);
+        return true;
+      }
+
+    private:
+      friend class task_group;
+
+      void _push(task * pTask){
+        auto iIndex = worker_index();
+        if (iIndex < size()){
+          _workers[iIndex]._tasks.push(pTask);
+        } else{
+          std::lock_guard<std::mutex> oLock(_lock);
+          _injected.push_back(pTask);
+        }
+        // a worker going to sleep increments the sleeping count before it checks the pending count
+        _pending.fetch_add(1);
+        if (_sleeping.load()){
+          std::lock_guard<std::mutex> oLock(_lock);
+          _wake.notify_one();
+        }
+      }
+
+      /// the next task for a worker, or for a thread outside the pool when iIndex is size()
+      task * _find(size_t iIndex){
+        task * pRet = nullptr;
+        if (iIndex < size() && (pRet = _workers[iIndex]._tasks.take())){
+          return pRet;
+        }
+        if (_pending.load(std::memory_order_relaxed)){
+          {
+            std::lock_guard<std::mutex> oLock(_lock);
+            if (!_injected.empty()){
+              pRet = _injected.front();
+              _injected.pop_front();
+              return pRet;
+            }
+          }
+          // start at a random victim so thieves spread over the workers
+          auto iStart = (iIndex < size() ? _next_random(_workers[iIndex]._random) : std::hash<std::thread::id>()(std::this_thread::get_id()));
+          for (size_t i = 0; i < size(); ++i){
+            auto iVictim = (iStart + i) % size();
+            if (iVictim != iIndex && (pRet = _workers[iVictim]._tasks.steal())){
+              return pRet;
+            }
+          }
+        }
+        return nullptr;
+      }
+
+      void _execute(task * pTask){
+        _pending.fetch_sub(1, std::memory_order_relaxed);
+        std::unique_ptr<task> oTask(pTask);
+        oTask->run();
+      }
+
+      void _run_worker(size_t iIndex){
+        auto & oCurrent = current_worker::instance();
+        oCurrent._pool = this;
+        oCurrent._index = iIndex;
+        forever{
+          task * pTask = nullptr;
+          // spin briefly before sleeping since new work often follows shortly
+          for (uint32_t iPauses = 1; !pTask && iPauses <= adaptive_wait_policy::max_pauses; iPauses <<= 1){
+            if ((pTask = _find(iIndex))){
+              break;
+            }
+            for (uint32_t i = 0; i < iPauses; ++i){
+              _::wait::pause();
+            }
+          }
+          if (pTask){
+            _execute(pTask);
+            continue;
+          }
+          std::unique_lock<std::mutex> oLock(_lock);
+          _sleeping.fetch_add(1);
+          _wake.wait(oLock, [this](){ return _stop || _pending.load(); });
+          _sleeping.fetch_sub(1);
+          if (_stop && !_pending.load()){
+            break;
+          }
+        }
+        oCurrent._pool = nullptr;
+      }
+
+      static size_t _next_random(uint32_t& iState){
+        iState ^= iState << 13;
+        iState ^= iState >> 17;
+        iState ^= iState << 5;
+        return iState;
+      }
+
+      std::vector<worker> _workers;
+      std::deque<task*> _injected;
+      alignas(64) std::atomic<size_t> _pending;
+      std::atomic<size_t> _sleeping;
+      std::mutex _lock;
+      std::condition_variable _wake;
+      bool _stop;
+    };
+
+    /** a set of tasks that can be waited on together
+    wait() runs queued tasks of the pool while the group is incomplete, so a task may create and wait for a group of
+    subtasks without tying up its worker. The first exception thrown by a task of the group is rethrown by wait().
+    */
+    class task_group{
+    public:
+      explicit task_group(thread_pool& oPool = thread_pool::global()) : _pool(oPool), _state(std::make_shared<state>()){}
+      ~task_group(){
+        try{
+          wait();
+        } catch (...){}
+      }
+      task_group(const task_group&) = delete;
+      task_group& operator=(const task_group&) = delete;
+
+      /// queues a task in the group
+      template <typename _FnT>
+      void run(_FnT&& fn){
+        _state->_outstanding.fetch_add(1);
+        auto pState = _state;
+        _pool._push(_::thread_pool::make_task([pState, oFn = std::forward<_FnT>(fn)]() mutable{
+          try{
+            oFn();
+          } catch (...){
+            std::lock_guard<std::mutex> oLock(pState->_lock);
+            if (!pState->_exception){
+              pState->_exception = std::current_exception();
+            }
+          }
+          pState->_outstanding.fetch_sub(1, std::memory_order_release);
+        }));
+      }
+
+      /// runs tasks of the pool until every task of the group has completed then rethrows the first exception
+      void wait(){
+        while (_state->_outstanding.load(std::memory_order_acquire)){
+          if (!_pool.try_run_one()){
+            std::this_thread::yield();
+          }
+        }
+        std::exception_ptr oException;
+        {
+          std::lock_guard<std::mutex> oLock(_state->_lock);
+          std::swap(oException, _state->_exception);
+        }
+        if (oException){
+          std::rethrow_exception(oException);
+        }
+      }
+
+    private:
+      struct state{
+        std::atomic<size_t> _outstanding{0};
+        std::mutex _lock;
+        std::exception_ptr _exception;
+      };
+      thread_pool& _pool;
+      std::shared_ptr<state> _state;
+    };
+
+    ///@}
+  }
+}
@@ -0,0 +1,64 @@
+/** @file
+fair first come first served spin lock
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+#pragma once
+
+#include <xtd/concurrent/wait_policy.hpp>
+
+#include <atomic>
+#include <cstdint>
+
+namespace xtd{
+  namespace concurrent{
+    /** A single owner spinning lock granted in arrival order
+    Each thread takes a ticket with one fetch_add then waits until the ticket is served, so no thread can lose the
+    race for the lock repeatedly. Waiters only read the served counter, which changes once per release.
+    @tparam _WaitPolicyT behavior while waiting for the ticket to be served
+    */
+    template <typename _WaitPolicyT = null_wait_policy>
+    class ticket_lock_base{
+      alignas(64) std::atomic<uint32_t> _next;
+      alignas(64) std::atomic<uint32_t> _serving;
+      _WaitPolicyT _WaitPolicy;
+    public:
+      using wait_policy_type = _WaitPolicyT;
+      using scope_locker = xtd::concurrent::scope_locker<ticket_lock_base<_WaitPolicyT>>;
+
+      ~ticket_lock_base() = default;
+      ticket_lock_base(wait_policy_type oWait = wait_policy_type()) : _next(0), _serving(0), _WaitPolicy(oWait){}
+      ticket_lock_base(const ticket_lock_base&) = delete;
+      ticket_lock_base(ticket_lock_base&&) = delete;
+
+      ///Acquires the lock
+      void lock(){
+        auto iTicket = _next.fetch_add(1, std::memory_order_relaxed);
+        forever{
+          auto iServing = _serving.load(std::memory_order_acquire);
+          if (iServing == iTicket){
+            break;
+          }
+          _::wait::wait(_WaitPolicy, _serving, iServing);
+        }
+      }
+      /// Releases the lock to the next ticket
+      void unlock(){
+        _serving.store(1 + _serving.load(std::memory_order_relaxed), std::memory_order_release);
+        _::wait::notify(_WaitPolicy, _serving, true);
+      }
+      /** Attempts to acquire the lock
+      @return true if the lock was acquired
+      */
+      bool try_lock(){
+        auto iServing = _serving.load(std::memory_order_acquire);
+        return _next.compare_exchange_strong(iServing, 1 + iServing, std::memory_order_acquire, std::memory_order_relaxed);
+      }
+      /// number of threads holding or waiting for the lock. approximate while other threads lock and unlock
+      uint32_t queued() const{
+        return _next.load(std::memory_order_relaxed) - _serving.load(std::memory_order_relaxed);
+      }
+    };
+
+    using ticket_lock = ticket_lock_base<null_wait_policy>;
+  }
+}
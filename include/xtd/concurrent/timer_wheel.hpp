@@ -0,0 +1,399 @@
+/** @file
+hierarchical timer wheel
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+Time is counted in ticks. Each level of the wheel has 256 slots and each slot of level n spans 256^n ticks, so four
+levels cover 2^32 ticks. A timer is linked into the slot of the lowest level that reaches its expiry. When the ticks
+pass the start of a higher level slot the timers in it are re-inserted into the lower levels, and the timers in the
+level 0 slot of a tick expire on that tick. Timers are nodes of a pooled array linked by index, so scheduling and
+cancelling take constant time and allocate nothing once the pool has grown to the number of pending timers.
+*/
+#pragma once
+#include <xtd/xtd.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#if (XTD_COMPILER_MSVC & XTD_COMPILER)
+  #include <intrin.h>
+#endif
+
+#include <xtd/concurrent/spin_lock.hpp>
+#include <xtd/concurrent/thread_pool.hpp>
+#include <xtd/concurrent/wait_policy.hpp>
+
+namespace xtd{
+  namespace concurrent{
+
+#if (!DOXY_INVOKED)
+    namespace _{
+      namespace timer_wheel{
+
+        static constexpr uint32_t npos = 0xffffffff;
+
+        struct node{
+          uint64_t _expires = 0; ///< tick the timer expires on
+          uint32_t _next = npos;
+          uint32_t _prev = npos;
+          uint32_t _slot = npos; ///< slot the node is linked in or npos while the node is free
+          uint32_t _generation = 1; ///< incremented when the node is freed so stale ids are rejected
+          std::function<void()> _fn;
+        };
+
+        /// index of the lowest set bit of a non-zero value
+        inline size_t lowest_bit(uint64_t iValue){
+#if (XTD_COMPILER_MSVC & XTD_COMPILER)
+          unsigned long iRet;
+          _BitScanForward64(&iRet, iValue);
+          return iRet;
+#else
+          return static_cast<size_t>(__builtin_ctzll(iValue));
+#endif
+        }
+
+      }
+    }
+#endif
+
+    /** @addtogroup Concurrent
+    @{*/
+
+    /** Schedules callbacks to run after a delay
+    The wheel does not own a thread. A driver thread calls advance() to expire the timers that are due, typically from
+    a poll or select loop that waits for time_until_next(). Expired callbacks run on the thread calling advance() or are
+    posted to a thread_pool when one is given to the constructor. Timers may be scheduled, rescheduled and cancelled
+    from any thread, including from expiring callbacks.
+    @tparam _Levels number of levels. the wheel spans 256^_Levels ticks and longer delays are re-inserted as they near
+    */
+    template <size_t _Levels = 4>
+    class timer_wheel_base{
+      static_assert(_Levels >= 1 && _Levels <= 7, "timer_wheel supports 1 to 7 levels");
+      using node = _::timer_wheel::node;
+      static constexpr uint32_t npos = _::timer_wheel::npos;
+
+    public:
+      using clock = std::chrono::steady_clock;
+      using timer_id = uint64_t;
+      static constexpr size_t levels = _Levels;
+      static constexpr size_t slot_count = 256;
+      /// id that never names a timer
+      static constexpr timer_id invalid_timer = 0;
+
+      /**
+      @param oTick resolution of the wheel. delays are rounded up to whole ticks
+      @param pExecutor pool that runs expired callbacks or nullptr to run them in advance()
+      @param oStart time of tick 0
+      */
+      explicit timer_wheel_base(clock::duration oTick = std::chrono::milliseconds(1), thread_pool * pExecutor = nullptr, clock::time_point oStart = clock::now())
+        : _tick(oTick > clock::duration::zero() ? oTick : clock::duration(1)), _start(oStart), _executor(pExecutor), _current(0), _count(0), _free(npos)
+      {
+        for (auto & iHead : _heads){
+          iHead = npos;
+        }
+        for (auto & oLevel : _occupied){
+          for (auto & iWord : oLevel){
+            iWord = 0;
+          }
+        }
+      }
+      timer_wheel_base(const timer_wheel_base&) = delete;
+      timer_wheel_base& operator=(const timer_wheel_base&) = delete;
+
+      /// resolution of the wheel
+      clock::duration tick() const{ return _tick; }
+
+      /// number of pending timers
+      size_t size() const{
+        scope_locker oLock(_lock);
+        return _count;
+      }
+
+      /** schedules fn to run once after a delay
+      @returns id used to cancel or reschedule the timer
+      */
+      template <typename _FnT>
+      timer_id schedule(clock::duration oDelay, _FnT&& fn){
+        return schedule_at(clock::now() + oDelay, std::forward<_FnT>(fn));
+      }
+
+      /// schedules fn to run once at or after a point in time
+      template <typename _FnT>
+      timer_id schedule_at(clock::time_point oWhen, _FnT&& fn){
+        scope_locker oLock(_lock);
+        auto iNode = _allocate();
+        auto & oNode = _nodes[iNode];
+        oNode._fn = std::forward<_FnT>(fn);
+        oNode._expires = _expiry(oWhen);
+        _insert(iNode);
+        ++_count;
+        return _id(iNode);
+      }
+
+      /** moves a pending timer to expire after a new delay
+      @returns false if the timer has expired or been cancelled
+      */
+      bool reschedule(timer_id iTimer, clock::duration oDelay){
+        auto oWhen = clock::now() + oDelay;
+        scope_locker oLock(_lock);
+        auto iNode = _find(iTimer);
+        if (npos == iNode){
+          return false;
+        }
+        _unlink(iNode);
+        _nodes[iNode]._expires = _expiry(oWhen);
+        _insert(iNode);
+        return true;
+      }
+
+      /** cancels a pending timer
+      @returns false if the timer has expired or was already cancelled
+      */
+      bool cancel(timer_id iTimer){
+        std::function<void()> oFn;
+        {
+          scope_locker oLock(_lock);
+          auto iNode = _find(iTimer);
+          if (npos == iNode){
+            return false;
+          }
+          _unlink(iNode);
+          // destroyed after the lock is released in case its captures cancel other timers
+          oFn = std::move(_nodes[iNode]._fn);
+          _release(iNode);
+          --_count;
+        }
+        return true;
+      }
+
+      /** time until the next timer may expire
+      The result is exact for timers within 256 ticks and a lower bound for later timers, which are re-inserted closer
+      to their expiry first. A poll loop waits for this long then calls advance().
+      @returns clock::duration::max() when no timer is pending
+      */
+      clock::duration time_until_next(clock::time_point oNow = clock::now()) const{
+        uint64_t iNext = 0;
+        {
+          scope_locker oLock(_lock);
+          if (!_count){
+            return clock::duration::max();
+          }
+          iNext = ~static_cast<uint64_t>(0);
+          for (size_t iLevel = 0; iLevel < _Levels; ++iLevel){
+            auto iShift = 8 * iLevel;
+            auto iBlock = _current >> iShift;
+            auto iDistance = _next_occupied(iLevel, static_cast<size_t>(1 + iBlock) & 0xff);
+            if (npos != iDistance){
+              // level 0 slots expire on their tick and higher level slots are re-inserted when their block starts
+              auto iTick = (1 + iBlock + iDistance) << iShift;
+              iNext = (iTick < iNext ? iTick : iNext);
+            }
+          }
+        }
+        auto oDue = _start + _tick * static_cast<clock::rep>(iNext);
+        return (oDue > oNow ? oDue - oNow : clock::duration::zero());
+      }
+
+      /** expires the timers due at a point in time
+      Callbacks run after the wheel is unlocked. If a callback run by advance() throws, the remaining callbacks still
+      run and the first exception is rethrown.
+      @returns number of expired timers
+      */
+      size_t advance(clock::time_point oNow = clock::now()){
+        std::vector<std::function<void()>> oExpired;
+        {
+          scope_locker oLock(_lock);
+          auto iTarget = _ticks(oNow);
+          while (_current < iTarget && _count){
+            _advance_tick(oExpired);
+          }
+          if (_current < iTarget){
+            _current = iTarget;
+          }
+        }
+        if (_executor){
+          for (auto & oFn : oExpired){
+            _executor->post(std::move(oFn));
+          }
+          return oExpired.size();
+        }
+        std::exception_ptr oException;
+        for (auto & oFn : oExpired){
+          try{
+            oFn();
+          } catch (...){
+            if (!oException){
+              oException = std::current_exception();
+            }
+          }
+        }
+        if (oException){
+          std::rethrow_exception(oException);
+        }
+        return oExpired.size();
+      }
+
+    private:
+      using lock_type = spin_lock_base<adaptive_wait_policy>;
+      using scope_locker = typename lock_type::scope_locker;
+
+      uint64_t _ticks(clock::time_point oWhen) const{
+        return (oWhen > _start ? static_cast<uint64_t>((oWhen - _start) / _tick) : 0);
+      }
+
+      /// first tick at or after oWhen that has not been processed
+      uint64_t _expiry(clock::time_point oWhen) const{
+        auto iRet = _ticks(oWhen);
+        if (oWhen > _start + _tick * static_cast<clock::rep>(iRet)){
+          ++iRet;
+        }
+        return (iRet > _current ? iRet : 1 + _current);
+      }
+
+      timer_id _id(uint32_t iNode) const{
+        return (static_cast<timer_id>(_nodes[iNode]._generation) << 32) | iNode;
+      }
+
+      uint32_t _find(timer_id iTimer) const{
+        auto iNode = static_cast<uint32_t>(iTimer & 0xffffffff);
+        if (iNode >= _nodes.size() || npos == _nodes[iNode]._slot || _nodes[iNode]._generation != static_cast<uint32_t>(iTimer >> 32)){
+          return npos;
+        }
+        return iNode;
+      }
+
+      uint32_t _allocate(){
+        if (npos == _free){
+          _nodes.emplace_back();
+          return static_cast<uint32_t>(_nodes.size() - 1);
+        }
+        auto iRet = _free;
+        _free = _nodes[iRet]._next;
+        return iRet;
+      }
+
+      void _release(uint32_t iNode){
+        auto & oNode = _nodes[iNode];
+        oNode._fn = nullptr;
+        oNode._slot = npos;
+        if (!++oNode._generation){
+          oNode._generation = 1;
+        }
+        oNode._next = _free;
+        _free = iNode;
+      }
+
+      /// links a node into the slot of the lowest level that reaches its expiry
+      void _insert(uint32_t iNode){
+        auto iExpires = _nodes[iNode]._expires;
+        auto iDelta = iExpires - _current;
+        size_t iLevel = 0;
+        while (iLevel + 1 < _Levels && iDelta >= (static_cast<uint64_t>(1) << (8 * (iLevel + 1)))){
+          ++iLevel;
+        }
+        auto iRange = static_cast<uint64_t>(1) << (8 * _Levels);
+        if (iDelta >= iRange){
+          // beyond the wheel. parked in the furthest slot and re-inserted when that slot is reached
+          iExpires = _current + iRange - 1;
+        }
+        auto iSlot = static_cast<uint32_t>(iLevel * slot_count + ((iExpires >> (8 * iLevel)) & 0xff));
+        auto & oNode = _nodes[iNode];
+        oNode._slot = iSlot;
+        oNode._prev = npos;
+        oNode._next = _heads[iSlot];
+        if (npos != oNode._next){
+          _nodes[oNode._next]._prev = iNode;
+        }
+        _heads[iSlot] = iNode;
+        _occupied[iLevel][(iSlot & 0xff) >> 6] |= (static_cast<uint64_t>(1) << (iSlot & 63));
+      }
+
+      void _unlink(uint32_t iNode){
+        auto & oNode = _nodes[iNode];
+        if (npos != oNode._prev){
+          _nodes[oNode._prev]._next = oNode._next;
+        } else{
+          _heads[oNode._slot] = oNode._next;
+          if (npos == oNode._next){
+            _occupied[oNode._slot / slot_count][(oNode._slot & 0xff) >> 6] &= ~(static_cast<uint64_t>(1) << (oNode._slot & 63));
+          }
+        }
+        if (npos != oNode._next){
+          _nodes[oNode._next]._prev = oNode._prev;
+        }
+      }
+
+      /// unlinks every node of a slot and returns the first
+      uint32_t _detach(size_t iLevel, size_t iIndex){
+        auto iSlot = iLevel * slot_count + iIndex;
+        auto iRet = _heads[iSlot];
+        _heads[iSlot] = npos;
+        _occupied[iLevel][iIndex >> 6] &= ~(static_cast<uint64_t>(1) << (iIndex & 63));
+        return iRet;
+      }
+
+      void _advance_tick(std::vector<std::function<void()>>& oExpired){
+        auto iTick = ++_current;
+        // re-insert the higher level slots whose blocks start on this tick, highest first
+        size_t iLevel = 1;
+        while (iLevel < _Levels && !(iTick & ((static_cast<uint64_t>(1) << (8 * iLevel)) - 1))){
+          ++iLevel;
+        }
+        while (--iLevel){
+          for (auto iNode = _detach(iLevel, (iTick >> (8 * iLevel)) & 0xff); npos != iNode;){
+            auto iNext = _nodes[iNode]._next;
+            _insert(iNode);
+            iNode = iNext;
+          }
+        }
+        for (auto iNode = _detach(0, iTick & 0xff); npos != iNode;){
+          auto iNext = _nodes[iNode]._next;
+          if (_nodes[iNode]._expires > iTick){
+            // parked beyond a single level wheel
+            _insert(iNode);
+            iNode = iNext;
+            continue;
+          }
+          oExpired.push_back(std::move(_nodes[iNode]._fn));
+          _release(iNode);
+          --_count;
+          iNode = iNext;
+        }
+      }
+
+      /// distance from iFrom to the next occupied slot of a level searching circularly or npos if the level is empty
+      uint32_t _next_occupied(size_t iLevel, size_t iFrom) const{
+        size_t iDistance = 0;
+        auto iPosition = iFrom;
+        while (iDistance < slot_count){
+          auto iWord = _occupied[iLevel][iPosition >> 6] >> (iPosition & 63);
+          if (iWord){
+            return static_cast<uint32_t>(iDistance + _::timer_wheel::lowest_bit(iWord));
+          }
+          auto iStep = 64 - (iPosition & 63);
+          iDistance += iStep;
+          iPosition = (iPosition + iStep) & 0xff;
+        }
+        return npos;
+      }
+
+      const clock::duration _tick;
+      const clock::time_point _start;
+      thread_pool * const _executor;
+      mutable lock_type _lock;
+      uint64_t _current; ///< last processed tick
+      size_t _count;
+      uint32_t _free; ///< head of the free node list
+      std::vector<node> _nodes;
+      uint32_t _heads[_Levels * slot_count];
+      uint64_t _occupied[_Levels][slot_count / 64];
+    };
+
+    using timer_wheel = timer_wheel_base<>;
+
+    ///@}
+  }
+}
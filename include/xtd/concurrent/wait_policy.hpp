@@ -0,0 +1,221 @@
+/** @file
+wait policies and scope_locker shared by the lock and container templates
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+
+#pragma once
+#include <xtd/xtd.hpp>
+#include <xtd/source_location.hpp>
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// WaitOnAddress requires Windows 8. earlier targets park by yielding
+#if (XTD_OS_WINDOWS & XTD_OS) && defined(_WIN32_WINNT) && (_WIN32_WINNT >= 0x0602)
+  #define XTD_WAIT_ON_ADDRESS 1
+  #pragma comment(lib, "synchronization")
+#elif defined(__linux__)
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+  #include <immintrin.h>
+#endif
+
+namespace xtd{
+
+  namespace concurrent{
+
+#if (!DOXY_INVOKED)
+    namespace _{
+      namespace wait{
+
+        /// hints to the processor that the thread is spinning
+        inline void pause(){
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+          _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+          __asm__ __volatile__("yield");
+#else
+          std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+        }
+
+        /// blocks the calling thread while oWord holds iValue. may return spuriously
+        inline void park(std::atomic<uint32_t>& oWord, uint32_t iValue){
+          static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "lock words must be plain 32 bit integers");
+#if defined(XTD_WAIT_ON_ADDRESS)
+          WaitOnAddress(&oWord, &iValue, sizeof(iValue), INFINITE);
+#elif defined(__linux__)
+          syscall(SYS_futex, reinterpret_cast<uint32_t*>(&oWord), FUTEX_WAIT_PRIVATE, iValue, nullptr, nullptr, 0);
+#else
+          if (oWord.load(std::memory_order_relaxed) == iValue){
+            std::this_thread::yield();
+          }
+#endif
+        }
+
+        /// wakes one or all threads parked on oWord
+        inline void wake(std::atomic<uint32_t>& oWord, bool bAll){
+#if defined(XTD_WAIT_ON_ADDRESS)
+          if (bAll){
+            WakeByAddressAll(&oWord);
+          } else{
+            WakeByAddressSingle(&oWord);
+          }
+#elif defined(__linux__)
+          syscall(SYS_futex, reinterpret_cast<uint32_t*>(&oWord), FUTEX_WAKE_PRIVATE, (bAll ? INT_MAX : 1), nullptr, nullptr, 0);
+#else
+          (void)oWord;
+          (void)bAll;
+#endif
+        }
+
+        template <typename _PolicyT, typename = void>
+        struct can_park : std::false_type{};
+
+        template <typename _PolicyT>
+        struct can_park<_PolicyT, decltype(std::declval<_PolicyT&>().wait(std::declval<std::atomic<uint32_t>&>(), uint32_t()))> : std::true_type{};
+
+        template <typename _LockT, typename = void>
+        struct takes_location : std::false_type{};
+
+        template <typename _LockT>
+        struct takes_location<_LockT, decltype(std::declval<_LockT&>().lock(std::declval<const source_location&>()))> : std::true_type{};
+
+        /** waits for a lock word to change from iValue
+        Policies that can park a thread on the lock word do so. Other policies are invoked as before.
+        */
+        template <typename _PolicyT>
+        inline void wait(_PolicyT& oPolicy, std::atomic<uint32_t>& oWord, uint32_t iValue){
+          if constexpr (can_park<_PolicyT>::value){
+            oPolicy.wait(oWord, iValue);
+          } else{
+            (void)oWord;
+            (void)iValue;
+            oPolicy();
+          }
+        }
+
+        /// wakes threads parked on a lock word after the word changed. does nothing for policies that cannot park
+        template <typename _PolicyT>
+        inline void notify(_PolicyT& oPolicy, std::atomic<uint32_t>& oWord, bool bAll){
+          if constexpr (can_park<_PolicyT>::value){
+            oPolicy.notify(oWord, bAll);
+          } else{
+            (void)oPolicy;
+            (void)oWord;
+            (void)bAll;
+          }
+        }
+
+      }
+    }
+#endif
+
+    /** @addtogroup Concurrent
+    @{*/
+    ///Wait policy that does nothing. This is the default behavior.
+    class null_wait_policy{
+    public:
+      FORCEINLINE void operator ()(){/*nothing*/}
+    };
+    ///Wait policy that yields the current thread.
+    class yield_wait_policy{
+    public:
+      FORCEINLINE void operator ()(){ std::this_thread::yield(); }
+    };
+
+    /** Wait policy that spins with exponential backoff then sleeps in the kernel
+    A lock waiting for its lock word to change pauses for doubling intervals then parks the thread on the word with a
+    futex on Linux or WaitOnAddress on Windows, and the lock wakes parked threads when it is released. The policy
+    counts its parked threads so releasing an uncontended lock makes no system call. Oversubscribed waiters therefore
+    leave the CPU to the lock holder instead of spinning through its time slice.
+    Waits without a lock word, such as a pop waiting for an item, back off with doubling pauses and yield once the
+    backoff is exhausted.
+    */
+    class adaptive_wait_policy{
+    public:
+      static constexpr uint32_t max_pauses = 1024; ///< longest run of pause instructions before a waiter parks or yields
+
+      adaptive_wait_policy() : _parked(0){}
+      adaptive_wait_policy(const adaptive_wait_policy&) : _parked(0){}
+      adaptive_wait_policy& operator=(const adaptive_wait_policy&){ return *this; }
+
+      void operator ()(){
+        static thread_local uint32_t _pauses = 1;
+        for (uint32_t i = 0; i < _pauses; ++i){
+          _::wait::pause();
+        }
+        if (_pauses < max_pauses){
+          _pauses <<= 1;
+        } else{
+          _pauses = 1;
+          std::this_thread::yield();
+        }
+      }
+
+      /// waits for oWord to change from iValue
+      void wait(std::atomic<uint32_t>& oWord, uint32_t iValue){
+        for (uint32_t iPauses = 1; iPauses <= max_pauses; iPauses <<= 1){
+          for (uint32_t i = 0; i < iPauses; ++i){
+            _::wait::pause();
+          }
+          if (oWord.load(std::memory_order_relaxed) != iValue){
+            return;
+          }
+        }
+        // notify changes the word before it reads the parked count so one of them always sees the other
+        _parked.fetch_add(1);
+        _::wait::park(oWord, iValue);
+        _parked.fetch_sub(1);
+      }
+
+      /// wakes one or all threads parked on oWord. called after the word is changed
+      void notify(std::atomic<uint32_t>& oWord, bool bAll){
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_parked.load()){
+          _::wait::wake(oWord, bAll);
+        }
+      }
+
+      /// number of threads parked by the policy
+      uint32_t parked() const{ return _parked.load(std::memory_order_relaxed); }
+
+    private:
+      std::atomic<uint32_t> _parked;
+    };
+
+    /** RAII pattern to automatically acquire and release the spin lock
+    Locks that record call sites are passed the location that constructed the scope_locker.
+    */
+    template <typename _Ty>
+    class scope_locker{
+    public:
+      using spin_lock_type = _Ty;
+      ~scope_locker(){ _Lock.unlock(); }
+      explicit scope_locker(spin_lock_type& oLock, const source_location& oWhere = source_location::current()) : _Lock(oLock){
+        if constexpr (_::wait::takes_location<spin_lock_type>::value){
+          _Lock.lock(oWhere);
+        } else{
+          (void)oWhere;
+          _Lock.lock();
+        }
+      }
+      scope_locker(const scope_locker&) = delete;
+      scope_locker& operator=(const scope_locker&) = delete;
+
+    private:
+      spin_lock_type& _Lock;
+    };
+
+    ///@}
+  }
+
+}
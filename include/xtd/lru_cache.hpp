@@ -1,50 +1,602 @@
 /** @file
 lru cache
 @copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+Entries live in the nodes of a hash table and the eviction policy links them into its own lists through a hook
+embedded in each entry. A hit updates the hook and a miss constructs the loaded value in place in a new node and
+evicts the entry chosen by the policy, so lookups, misses and evictions take constant time and never copy or move a
+cached value.
+
+lru_policy evicts the least recently used entry. clock_policy approximates it without relinking anything on a hit.
+slru_policy and tinylfu_policy keep entries that were hit more than once out of reach of a sequential scan: slru_policy
+by protecting them in a second segment and tinylfu_policy by only admitting an entry into the main cache if it was
+accessed more often than the entry it would replace.
 */
 #pragma once
 
 #include <xtd/xtd.hpp>
 
-#include <deque>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace xtd{
 
-  template <typename _key_t, typename _value_t, size_t _cache_size, typename _loader_t = _value_t(*)(const _key_t&)>
-  class lru_cache : protected std::deque<std::pair<_key_t, _value_t>>{
-    using _super_t = std::deque<std::pair<_key_t, _value_t>>;
+#if (!DOXY_INVOKED)
+  namespace _{
+    namespace lru_cache{
+
+      /// links of an entry in a circular recency list
+      struct link{
+        link * _prev;
+        link * _next;
+
+        link() : _prev(this), _next(this){}
+
+        void unlink(){
+          _prev->_next = _next;
+          _next->_prev = _prev;
+        }
+
+        void link_after(link& oPrev){
+          _prev = &oPrev;
+          _next = oPrev._next;
+          _next->_prev = this;
+          oPrev._next = this;
+        }
+      };
+
+      /// links of an entry that also carry its weight
+      struct weighted_link : link{
+        size_t _weight = 1;
+      };
+
+      /// a circular list of weighted links with a sentinel. front() is the most recently pushed link
+      class list{
+        link _head;
+        size_t _size = 0;
+        size_t _weight = 0;
+      public:
+        list() = default;
+        list(const list&) = delete;
+        list(list&& src) : _size(src._size), _weight(src._weight){
+          // the links keep their addresses so only the sentinel changes hands
+          if (src._size){
+            _head._next = src._head._next;
+            _head._prev = src._head._prev;
+            _head._next->_prev = &_head;
+            _head._prev->_next = &_head;
+          }
+          src.clear();
+        }
+
+        size_t size() const{ return _size; }
+        /// sum of the weights of the links
+        size_t weight() const{ return _weight; }
+        bool empty() const{ return 0 == _size; }
+        link * end(){ return &_head; }
+        weighted_link * front(){ return static_cast<weighted_link*>(_size ? _head._next : nullptr); }
+        weighted_link * back(){ return static_cast<weighted_link*>(_size ? _head._prev : nullptr); }
+
+        void push_front(weighted_link& oLink){ insert_before(*_head._next, oLink); }
+        void insert_before(link& oPos, weighted_link& oLink){
+          oLink.link_after(*oPos._prev);
+          ++_size;
+          _weight += oLink._weight;
+        }
+        void erase(weighted_link& oLink){
+          oLink.unlink();
+          --_size;
+          _weight -= oLink._weight;
+        }
+        /// forgets every link without touching them
+        void clear(){
+          _head._next = _head._prev = &_head;
+          _size = 0;
+          _weight = 0;
+        }
+      };
+
+      /** count-min sketch estimating how often a hash was seen recently
+      Four rows of counters saturate at 15 and are all halved once enough increments were recorded, so the estimates
+      follow changes in popularity instead of favoring whatever was hot long ago.
+      */
+      class frequency_sketch{
+        std::vector<uint8_t> _counters;
+        size_t _mask;
+        size_t _additions = 0;
+        size_t _sample_size;
+
+        size_t _index(size_t iHash, size_t iRow) const{
+          static const uint64_t seeds[] = { 0x9E3779B97F4A7C15ULL, 0xC2B2AE3D27D4EB4FULL, 0x165667B19E3779F9ULL, 0xD6E8FEB86659FD93ULL };
+          auto iMixed = static_cast<uint64_t>(iHash) * seeds[iRow];
+          iMixed ^= iMixed >> 32;
+          return iRow * (1 + _mask) + static_cast<size_t>(iMixed & _mask);
+        }
+
+      public:
+        static const size_t rows = 4;
+        static const uint8_t max_count = 15;
+
+        explicit frequency_sketch(size_t iCapacity){
+          _resize(iCapacity);
+        }
+
+        /// widens the sketch when it tracks more entries than it has counters per row. the counts start over
+        void ensure_capacity(size_t iCapacity){
+          if (iCapacity > 1 + _mask){
+            _resize(iCapacity);
+          }
+        }
+
+        void increment(size_t iHash){
+          bool bAdded = false;
+          for (size_t i = 0; i < rows; ++i){
+            auto & iCount = _counters[_index(iHash, i)];
+            if (iCount < max_count){
+              ++iCount;
+              bAdded = true;
+            }
+          }
+          if (bAdded && ++_additions >= _sample_size){
+            for (auto & iCount : _counters){
+              iCount >>= 1;
+            }
+            _additions /= 2;
+          }
+        }
+
+        uint8_t estimate(size_t iHash) const{
+          uint8_t iRet = max_count;
+          for (size_t i = 0; i < rows; ++i){
+            iRet = std::min(iRet, _counters[_index(iHash, i)]);
+          }
+          return iRet;
+        }
+
+      private:
+        void _resize(size_t iCapacity){
+          size_t iWidth = 16;
+          while (iWidth < iCapacity){
+            iWidth <<= 1;
+          }
+          _counters.assign(rows * iWidth, 0);
+          _mask = iWidth - 1;
+          _sample_size = 10 * iWidth;
+          _additions = 0;
+        }
+      };
+
+      /// selects the entry constructor that loads the value
+      struct load_tag{};
+
+    }
+  }
+#endif
+
+  /** hit, miss and load counters of a cache
+  The counters accumulate from the construction of the cache.
+  */
+  struct cache_stats{
+    uint64_t hits = 0; ///< lookups that found a cached value
+    uint64_t misses = 0; ///< lookups that did not find a cached value
+    uint64_t evictions = 0; ///< values removed to make room for another. excludes erased values
+    uint64_t loads = 0; ///< values the loader returned
+    uint64_t load_failures = 0; ///< loader calls that threw
+    std::chrono::nanoseconds load_time{0}; ///< total time spent loading values including failed loads
+
+    double hit_ratio() const{ return (hits + misses) ? static_cast<double>(hits) / (hits + misses) : 0; }
+    std::chrono::nanoseconds mean_load_time() const{
+      auto iCalls = loads + load_failures;
+      return iCalls ? load_time / static_cast<std::chrono::nanoseconds::rep>(iCalls) : std::chrono::nanoseconds(0);
+    }
+  };
+
+  /** @name lru_cache eviction policies
+  A policy tracks the entries of a cache through a hook each entry derives from. The cache calls insert when an entry is
+  added, touch on every hit and erase when an entry is removed, and asks for victims while the entries outweigh its
+  capacity. The entry being added joins the policy after the victims are evicted so it is never chosen itself. The
+  capacity and the sizes of segments are measured in the weights the cache assigns to the hooks.
+  @{*/
+
+  /// evicts the least recently used entry
+  class lru_policy{
+    _::lru_cache::list _recent;
+  public:
+    struct hook : _::lru_cache::weighted_link{};
+
+    explicit lru_policy(size_t){}
+
+    void resize(size_t){}
+    void insert(hook& oHook, size_t){ _recent.push_front(oHook); }
+    void touch(hook& oHook){
+      _recent.erase(oHook);
+      _recent.push_front(oHook);
+    }
+    void erase(hook& oHook){ _recent.erase(oHook); }
+    hook * victim(){ return static_cast<hook*>(_recent.back()); }
+    void clear(){ _recent.clear(); }
+  };
+
+  /** second chance approximation of lru_policy
+  A hit only sets a flag on the entry. The clock hand sweeps the entries in insertion order clearing flags and evicts
+  the first entry that was not hit since the hand last passed it.
+  */
+  class clock_policy{
+    _::lru_cache::list _ring;
+    _::lru_cache::link * _hand; ///< the next entry examined or the sentinel of the ring
+  public:
+    struct hook : _::lru_cache::weighted_link{
+      bool _referenced = false;
+    };
+
+    explicit clock_policy(size_t) : _hand(_ring.end()){}
+    clock_policy(clock_policy&& src) : _ring(std::move(src._ring)), _hand(src._ring.end() == src._hand ? _ring.end() : src._hand){
+      src._hand = src._ring.end();
+    }
+
+    void resize(size_t){}
+    /// new entries are placed behind the hand so they are examined last
+    void insert(hook& oHook, size_t){
+      oHook._referenced = false;
+      _ring.insert_before(*_hand, oHook);
+    }
+    void touch(hook& oHook){ oHook._referenced = true; }
+    void erase(hook& oHook){
+      if (&oHook == _hand){
+        _hand = oHook._next;
+      }
+      _ring.erase(oHook);
+    }
+    hook * victim(){
+      if (_ring.empty()){
+        return nullptr;
+      }
+      forever{
+        if (_ring.end() == _hand){
+          _hand = _hand->_next;
+        }
+        auto pHook = static_cast<hook*>(_hand);
+        if (!pHook->_referenced){
+          return pHook;
+        }
+        pHook->_referenced = false;
+        _hand = _hand->_next;
+      }
+    }
+    void clear(){
+      _ring.clear();
+      _hand = _ring.end();
+    }
+  };
+
+  /** segmented lru resistant to scans
+  New entries start in a probationary segment and move to a protected segment holding 80% of the capacity when they
+  are hit. Entries pushed out of the protected segment get another chance in probation. Victims come from probation
+  so a scan of entries that are each read once only displaces other entries that were read once.
+  */
+  class slru_policy{
+    _::lru_cache::list _probation;
+    _::lru_cache::list _protected;
+    size_t _protected_capacity;
+  public:
+    struct hook : _::lru_cache::weighted_link{
+      bool _protected = false;
+    };
+
+    explicit slru_policy(size_t iCapacity){ resize(iCapacity); }
+
+    void resize(size_t iCapacity){ _protected_capacity = std::max<size_t>(1, iCapacity * 4 / 5); }
+    void insert(hook& oHook, size_t){
+      oHook._protected = false;
+      _probation.push_front(oHook);
+    }
+    void touch(hook& oHook){
+      if (oHook._protected){
+        _protected.erase(oHook);
+        _protected.push_front(oHook);
+        return;
+      }
+      _probation.erase(oHook);
+      oHook._protected = true;
+      _protected.push_front(oHook);
+      while (_protected.weight() > _protected_capacity && _protected.size() > 1){
+        auto pDemoted = static_cast<hook*>(_protected.back());
+        _protected.erase(*pDemoted);
+        pDemoted->_protected = false;
+        _probation.push_front(*pDemoted);
+      }
+    }
+    void erase(hook& oHook){ (oHook._protected ? _protected : _probation).erase(oHook); }
+    hook * victim(){ return static_cast<hook*>(_probation.empty() ? _protected.back() : _probation.back()); }
+    void clear(){
+      _probation.clear();
+      _protected.clear();
+    }
+  };
+
+  /** window tinylfu
+  New entries enter a small lru window holding 1% of the capacity. The entry leaving the window is only admitted into
+  a segmented lru main cache if a frequency sketch of recent accesses shows it is more popular than the entry main
+  cache would evict for it, otherwise it is evicted itself. The window lets bursts of new keys build up a frequency
+  before they compete with established entries and the sketch keeps one off scans from evicting anything but each other.
+  The sketch starts with a counter per unit of capacity, up to 64K, and widens as the number of entries grows past it.
+  */
+  class tinylfu_policy{
+    enum segment : uint8_t{ window, probation, protected_segment };
+  public:
+    struct hook : _::lru_cache::weighted_link{
+      size_t _hash = 0;
+      uint8_t _segment = window;
+    };
+
+    explicit tinylfu_policy(size_t iCapacity) : _sketch(std::min<size_t>(iCapacity, 1 << 16)){ resize(iCapacity); }
+
+    void resize(size_t iCapacity){
+      _window_capacity = std::max<size_t>(1, iCapacity / 100);
+      _protected_capacity = std::max<size_t>(1, (iCapacity - std::min(iCapacity, _window_capacity)) * 4 / 5);
+    }
+    void insert(hook& oHook, size_t iHash){
+      oHook._hash = iHash;
+      _sketch.ensure_capacity(1 + _window.size() + _probation.size() + _protected.size());
+      _sketch.increment(iHash);
+      _move(oHook, window);
+      while (_window.weight() > _window_capacity && _window.size() > 1){
+        auto & oOldest = static_cast<hook&>(*_window.back());
+        _window.erase(oOldest);
+        _move(oOldest, probation);
+      }
+    }
+    void touch(hook& oHook){
+      _sketch.increment(oHook._hash);
+      auto eSegment = static_cast<segment>(oHook._segment);
+      _segment(eSegment).erase(oHook);
+      if (probation != eSegment){
+        _move(oHook, eSegment);
+        return;
+      }
+      _move(oHook, protected_segment);
+      while (_protected.weight() > _protected_capacity && _protected.size() > 1){
+        auto & oDemoted = static_cast<hook&>(*_protected.back());
+        _protected.erase(oDemoted);
+        _move(oDemoted, probation);
+      }
+    }
+    void erase(hook& oHook){ _segment(static_cast<segment>(oHook._segment)).erase(oHook); }
+    hook * victim(){
+      auto pVictim = static_cast<hook*>(_probation.empty() ? _protected.back() : _probation.back());
+      if (_window.weight() < _window_capacity || _window.empty()){
+        return pVictim ? pVictim : static_cast<hook*>(_window.back());
+      }
+      auto pCandidate = static_cast<hook*>(_window.back());
+      if (!pVictim || _sketch.estimate(pCandidate->_hash) <= _sketch.estimate(pVictim->_hash)){
+        return pCandidate;
+      }
+      // the candidate is admitted to main in place of the victim
+      _window.erase(*pCandidate);
+      _move(*pCandidate, probation);
+      return pVictim;
+    }
+    void clear(){
+      _window.clear();
+      _probation.clear();
+      _protected.clear();
+    }
+
+  private:
+    _::lru_cache::list& _segment(segment eSegment){
+      return (window == eSegment ? _window : probation == eSegment ? _probation : _protected);
+    }
+    void _move(hook& oHook, segment eSegment){
+      oHook._segment = eSegment;
+      _segment(eSegment).push_front(oHook);
+    }
+
+    _::lru_cache::frequency_sketch _sketch;
+    size_t _window_capacity;
+    size_t _protected_capacity;
+    _::lru_cache::list _window;
+    _::lru_cache::list _probation;
+    _::lru_cache::list _protected;
+  };
+
+  ///@}
+
+  /// weighs every entry as 1 so the capacity of a cache counts entries
+  struct unit_weigher{
+    template <typename _key_t, typename _value_t>
+    size_t operator()(const _key_t&, const _value_t&) const{ return 1; }
+  };
+
+  /** least recently used cache that loads missing values on demand
+  @tparam _key_t key type
+  @tparam _value_t cached value type
+  @tparam _cache_size default capacity
+  @tparam _loader_t function object returning the value of a key
+  @tparam _hash_t hash of the keys
+  @tparam _policy_t eviction policy: lru_policy, clock_policy, slru_policy or tinylfu_policy
+  @tparam _weigher_t function object returning the weight of a key and value such as its size in bytes. must not throw
+
+  The capacity limits the total weight of the cached values. With the default unit_weigher it is the number of values.
+  A value heavier than the capacity is still cached until the next value is added.
+  */
+  template <typename _key_t, typename _value_t, size_t _cache_size, typename _loader_t = _value_t(*)(const _key_t&), typename _hash_t = std::hash<_key_t>,
+    typename _policy_t = lru_policy, typename _weigher_t = unit_weigher>
+  class lru_cache{
+    static_assert(_cache_size > 0, "lru_cache must hold at least one value");
+
+    struct entry : _policy_t::hook{
+      template <typename ... _arg_ts>
+      explicit entry(_arg_ts&&...oArgs) : _value(std::forward<_arg_ts>(oArgs)...){}
+      template <typename _fn_t>
+      entry(_::lru_cache::load_tag, _fn_t& oLoader, const _key_t& key) : _value(oLoader(key)){}
+      _value_t _value;
+      const _key_t * _key = nullptr; ///< key of the table node holding the entry
+    };
+
+    using map_type = std::unordered_map<_key_t, entry, _hash_t>;
+
   public:
     using key_type = _key_t;
     using value_type = _value_t;
     using pair_type = std::pair<_key_t, _value_t>;
     using loader_type = _loader_t;
+    using policy_type = _policy_t;
+    using weigher_type = _weigher_t;
 
     static const size_t cache_size = _cache_size;
+    /// entries a cache over its capacity evicts on each insert besides those making room for the inserted value
+    static const size_t eviction_batch = 16;
 
-    explicit lru_cache(const loader_type& oLoader) : _loader(oLoader){}
-    explicit lru_cache(loader_type&& oLoader) : _loader(std::move(oLoader)){}
+    explicit lru_cache(loader_type oLoader, size_t iCapacity = _cache_size, weigher_type oWeigher = weigher_type())
+      : _loader(std::move(oLoader)), _weigher(std::move(oWeigher)), _capacity(iCapacity), _policy(iCapacity)
+    {
+      if (std::is_same<_weigher_t, unit_weigher>::value){
+        _entries.reserve(iCapacity + 1);
+      }
+    }
     lru_cache() = delete;
     lru_cache(const lru_cache&) = delete;
-    lru_cache(lru_cache&& src) : _super_t(std::move(src)), _loader(std::move(src._loader)){}
+    // table nodes keep their addresses when the table moves so the policy lists stay valid
+    lru_cache(lru_cache&& src) : _loader(std::move(src._loader)), _weigher(std::move(src._weigher)), _capacity(src._capacity), _weight(src._weight),
+      _entries(std::move(src._entries)), _policy(std::move(src._policy)), _stats(src._stats)
+    {
+      src._entries.clear();
+      src._weight = 0;
+    }
     ~lru_cache(){}
 
+    /// returns the value of key, loading it and evicting a value chosen by the policy if it is not cached
     _value_t& operator[](const _key_t& key){
-      for (typename _super_t::iterator oItem = _super_t::begin(); _super_t::end() != oItem; ++oItem){
-        if (key == oItem->first){
-          value_type oRet = oItem->second;
-          _super_t::erase(oItem);
-          _super_t::push_front(std::make_pair(key, oRet));
-          return _super_t::front().second;
-        }
+      auto oItem = _entries.find(key);
+      if (_entries.end() != oItem){
+        ++_stats.hits;
+        _policy.touch(oItem->second);
+        return oItem->second._value;
+      }
+      ++_stats.misses;
+      auto oStart = std::chrono::steady_clock::now();
+      try{
+        auto & oRet = _insert(key, _::lru_cache::load_tag(), _loader, key);
+        ++_stats.loads;
+        _stats.load_time += std::chrono::steady_clock::now() - oStart;
+        return oRet;
+      } catch (...){
+        ++_stats.load_failures;
+        _stats.load_time += std::chrono::steady_clock::now() - oStart;
+        throw;
+      }
+    }
+
+    /// returns the cached value of key without loading it or nullptr if it is not cached
+    _value_t * find(const _key_t& key){
+      auto oItem = _entries.find(key);
+      if (_entries.end() == oItem){
+        ++_stats.misses;
+        return nullptr;
       }
-      if (_super_t::size() >= cache_size){
-        _super_t::pop_back();
+      ++_stats.hits;
+      _policy.touch(oItem->second);
+      return &oItem->second._value;
+    }
+
+    /// caches a value constructed from oArgs, replacing any cached value of key
+    template <typename ... _arg_ts>
+    _value_t& emplace(const _key_t& key, _arg_ts&&...oArgs){
+      erase(key);
+      return _insert(key, std::forward<_arg_ts>(oArgs)...);
+    }
+
+    /// removes key from the cache. returns false if it was not cached
+    bool erase(const _key_t& key){
+      auto oItem = _entries.find(key);
+      if (_entries.end() == oItem){
+        return false;
       }
-      _super_t::push_front(std::make_pair(key, _loader(key)));
-      return _super_t::front().second;
+      _policy.erase(oItem->second);
+      _weight -= oItem->second._weight;
+      _entries.erase(oItem);
+      return true;
+    }
+
+    /// removes every cached value
+    void clear(){
+      _policy.clear();
+      _entries.clear();
+      _weight = 0;
     }
 
+    /** changes the capacity
+    A cache shrunk below its weight evicts at most iMaxEvictions values immediately and then eviction_batch values on
+    every insert until it fits, so a large shrink doesn't stall one caller.
+    @returns true if the cache fits in the new capacity
+    */
+    bool resize(size_t iCapacity, size_t iMaxEvictions = static_cast<size_t>(-1)){
+      _capacity = iCapacity;
+      _policy.resize(iCapacity);
+      _evict(_capacity, iMaxEvictions);
+      return _weight <= _capacity;
+    }
+
+    /// maximum total weight of the cached values
+    size_t capacity() const{ return _capacity; }
+
+    /// total weight of the cached values
+    size_t weight() const{ return _weight; }
+
+    /// number of cached values
+    size_t size() const{ return _entries.size(); }
+
+    bool empty() const{ return _entries.empty(); }
+
+    /// hit, miss and load counters
+    const cache_stats& stats() const{ return _stats; }
+
   protected:
     loader_type _loader;
+
+  private:
+
+    /// evicts values chosen by the policy until their weight is at most iLimit
+    void _evict(size_t iLimit, size_t iMaxEvictions){
+      for (; _weight > iLimit && iMaxEvictions; --iMaxEvictions){
+        auto pVictim = static_cast<entry*>(_policy.victim());
+        if (!pVictim){
+          break;
+        }
+        _policy.erase(*pVictim);
+        _weight -= pVictim->_weight;
+        _entries.erase(_entries.find(*pVictim->_key));
+        ++_stats.evictions;
+      }
+    }
+
+    template <typename ... _arg_ts>
+    _value_t& _insert(const _key_t& key, _arg_ts&&...oArgs){
+      auto oItem = _entries.emplace(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<_arg_ts>(oArgs)...)).first;
+      auto & oEntry = oItem->second;
+      oEntry._key = &oItem->first;
+      oEntry._weight = _weigher(key, static_cast<const _value_t&>(oEntry._value));
+      // evicted after the value is loaded so a failed load leaves the cache unchanged. an insert never makes a cache
+      // that is over its capacity heavier and sheds part of the excess
+      auto iLimit = std::max(_capacity, _weight);
+      _weight += oEntry._weight;
+      _evict(iLimit, static_cast<size_t>(-1));
+      _evict(_capacity, eviction_batch);
+      _policy.insert(oEntry, _entries.hash_function()(key));
+      return oEntry._value;
+    }
+
+    _weigher_t _weigher;
+    size_t _capacity;
+    size_t _weight = 0;
+    map_type _entries;
+    _policy_t _policy;
+    cache_stats _stats;
   };
 }
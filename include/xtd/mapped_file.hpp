@@ -95,18 +95,11 @@ namespace xtd{
     }
 
     template <typename _ty> mapped_page<_ty> append(size_t& newpage){
-      auto iPageSize = _super_t::page_size();
       struct stat oStat;
       xtd::crt_exception::throw_if(fstat(_file_num, &oStat), [](int i){ return -1 == i; });
-      newpage = oStat.st_size / iPageSize;
-      xtd::crt_exception::throw_if(lseek(_file_num, oStat.st_size + iPageSize, SEEK_SET), [](long l){ return -1==l;});
-      xtd::crt_exception::throw_if(write(_file_num, "", 1), [](int i){ return 1 != i;});
-
-      return mapped_page<_ty>(
-          xtd::crt_exception::throw_if(
-              mmap(nullptr, iPageSize, PROT_READ|PROT_WRITE, MAP_SHARED,  _file_num, oStat.st_size),
-              [](void*addr){ return nullptr==addr || MAP_FAILED==addr; }), 
-        [](_ty*addr){ munmap(addr, _::mapped_file_base<_page_size>::page_size()); });
+      // get() leaves the file one byte past the end of the last page it mapped so the next page starts on a page boundary
+      newpage = static_cast<size_t>(oStat.st_size) / _super_t::page_size();
+      return get<_ty>(newpage);
     }
   };
 #elif (XTD_OS_WINDOWS & XTD_OS)
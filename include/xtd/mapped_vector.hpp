@@ -8,6 +8,10 @@ memory mapped vector
 #include <xtd/mapped_file.hpp>
 #include <xtd/lru_cache.hpp>
 
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+
 namespace xtd{
 
   /**
@@ -54,10 +58,17 @@ namespace xtd{
       }
     };
 
-    using cache_type = lru_cache<size_t, typename page::pointer, 3, page_loader>;
+    using cache_type = lru_cache<size_t, typename page::pointer, 64, page_loader>;
 
     mutable mapped_file<_page_size> _file;
     mutable cache_type _cache;
+    mutable std::mutex _cache_lock; ///< the page cache is shared by iterators on different threads
+
+    template <typename _other_t>
+    mapped_page<_other_t> _get_page(size_t iPage) const {
+      std::lock_guard<std::mutex> oLock(_cache_lock);
+      return xtd::static_page_cast<_other_t>(_cache[iPage]);
+    }
 
   public:
     using value_type = _ty;
@@ -67,20 +78,50 @@ namespace xtd{
       : _file(oPath),
       _cache(page_loader(_file)){}
 
+    /** random access iterator
+    An iterator keeps the page of its current item mapped, so separate threads may read and write distinct items
+    through their own iterators while the vector does not grow.
+    */
     class iterator{
       template <typename,size_t, template <typename> class> friend class mapped_vector;
+    public:
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = _ty;
+      using difference_type = std::ptrdiff_t;
+      using pointer = _ty*;
+      using reference = _ty&;
+
+    private:
       size_t _current_index;
-      mapped_vector& _vector;
+      mapped_vector* _vector;
+      mutable size_t _page_index; ///< index of the page in _page or 0 when none is held
+      mutable mapped_page<data_page> _page;
 
-      iterator(size_t index, mapped_vector& oVector) : _current_index(index), _vector(oVector){}
+      iterator(size_t index, mapped_vector& oVector) : _current_index(index), _vector(&oVector), _page_index(0){}
+
+      value_type* _get() const {
+        XTD_ASSERT(npos != _current_index);
+        auto iPage = 1 + (_current_index / data_page::items_per_page());
+        if (iPage != _page_index){
+          _page = _vector->template _get_page<data_page>(iPage);
+          _page_index = iPage;
+        }
+        return &_page->_values[_current_index % data_page::items_per_page()];
+      }
 
     public:
+      iterator() : _current_index(npos), _vector(nullptr), _page_index(0){}
 
+      bool operator == (const iterator& rhs) const { return _current_index == rhs._current_index; }
       bool operator != (const iterator& rhs) const { return _current_index != rhs._current_index; }
+      bool operator < (const iterator& rhs) const { return _current_index < rhs._current_index; }
+      bool operator > (const iterator& rhs) const { return _current_index > rhs._current_index; }
+      bool operator <= (const iterator& rhs) const { return _current_index <= rhs._current_index; }
+      bool operator >= (const iterator& rhs) const { return _current_index >= rhs._current_index; }
 
       iterator operator++(int){
         iterator oRet(*this);
-        this->operator++(0);
+        this->operator++();
         return oRet;
       }
 
@@ -89,18 +130,49 @@ namespace xtd{
         return *this;
       }
 
+      iterator operator--(int){
+        iterator oRet(*this);
+        this->operator--();
+        return oRet;
+      }
+
+      iterator& operator--(){
+        _current_index--;
+        return *this;
+      }
+
+      iterator& operator+=(difference_type n){
+        _current_index += n;
+        return *this;
+      }
+
+      iterator& operator-=(difference_type n){
+        _current_index -= n;
+        return *this;
+      }
+
+      iterator operator+(difference_type n) const {
+        iterator oRet(*this);
+        return oRet += n;
+      }
+
+      friend iterator operator+(difference_type n, const iterator& rhs){ return rhs + n; }
+
+      iterator operator-(difference_type n) const {
+        iterator oRet(*this);
+        return oRet -= n;
+      }
+
+      difference_type operator-(const iterator& rhs) const {
+        return static_cast<difference_type>(_current_index) - static_cast<difference_type>(rhs._current_index);
+      }
+
       value_type* get(){
-        XTD_ASSERT(npos != _current_index);
-        auto iPage = 1 + (_current_index / data_page::items_per_page());
-        auto oPage = xtd::static_page_cast<data_page>(_vector._cache[iPage]);
-        return &oPage->_values[_current_index % data_page::items_per_page()];
+        return _get();
       }
 
       const value_type* get() const {
-        XTD_ASSERT(npos != _current_index);
-        auto iPage = 1 + (_current_index / data_page::items_per_page());
-        auto oPage = xtd::static_page_cast<data_page>(_vector._cache[iPage]);
-        return &oPage->_values[_current_index % data_page::items_per_page()];
+        return _get();
       }
             
       value_type* operator->(){
@@ -118,28 +190,31 @@ namespace xtd{
         return *get();
       }
 
+      /// the item stays mapped while the vector's page cache or another iterator holds its page
+      value_type& operator[](difference_type n) const {
+        return *(*this + n)._get();
+      }
 
     };
 
     void push_back(const value_type& value){
-      auto oRoot = xtd::static_page_cast<file_header_page>(_cache[0]);
+      auto oRoot = _get_page<file_header_page>(0);
       auto iPage = 1 + (oRoot->_count / data_page::items_per_page());
-      auto oPage = xtd::static_page_cast<data_page>(_cache[iPage]);
+      auto oPage = _get_page<data_page>(iPage);
       oPage->_values[ oRoot->_count % data_page::items_per_page() ] = value;
       oRoot->_count++;
     }
 
     size_t size() const {
-      auto oRoot = xtd::static_page_cast<file_header_page>(_cache[0]);
+      auto oRoot = _get_page<file_header_page>(0);
       return oRoot->_count;
     }
     iterator end() { 
-      auto oRoot = xtd::static_page_cast<file_header_page>(_cache[0]);
-      return iterator(oRoot->_count, *this);
+      return iterator(size(), *this);
     }
     iterator begin(){
-      auto oRoot = xtd::static_page_cast<file_header_page>(_cache[0]);
-      return iterator( (oRoot->_count ? 0 : -1), *this); }
+      return iterator(0, *this);
+    }
 
   };
 }
@@ -0,0 +1,193 @@
+/** @file
+parallel algorithms over random access ranges and b-trees
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+
+The algorithms split a range in halves until the pieces hold no more than a grain size of items and run the halves
+as tasks of a concurrent::thread_pool, so idle workers steal the largest pieces left. They only need C++17 and the
+library's thread pool, unlike the standard execution policies which depend on TBB with some standard libraries.
+A grain size of 0 picks one that gives every worker several pieces. Functions passed to the algorithms are called
+concurrently from several threads.
+
+Any random access iterator is supported, including the iterators of xtd::mapped_vector. A xtd::btree is split into
+runs of whole leaves which are read by the workers without the tree's page cache.
+*/
+#pragma once
+#include <xtd/xtd.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <xtd/concurrent/thread_pool.hpp>
+
+namespace xtd{
+
+  template <typename _key_t, typename _value_t, size_t _order, size_t _page_size, size_t _cache_size> class btree;
+
+  namespace parallel{
+
+#if (!DOXY_INVOKED)
+    namespace _{
+
+      /// the grain to use for iCount items
+      inline size_t grain(size_t iCount, size_t iGrain, const concurrent::thread_pool& oPool, size_t iMinimum = 1){
+        if (iGrain){
+          return iGrain;
+        }
+        return std::max(iMinimum, iCount / (8 * oPool.size()));
+      }
+
+      template <typename _IteratorT, typename _FnT>
+      void for_each(_IteratorT first, _IteratorT last, _FnT& fn, size_t iGrain, concurrent::thread_pool& oPool){
+        auto iCount = static_cast<size_t>(last - first);
+        if (iCount <= iGrain){
+          for (; first != last; ++first){
+            fn(*first);
+          }
+          return;
+        }
+        auto middle = first + (iCount / 2);
+        concurrent::task_group oGroup(oPool);
+        oGroup.run([&](){ for_each(first, middle, fn, iGrain, oPool); });
+        for_each(middle, last, fn, iGrain, oPool);
+        oGroup.wait();
+      }
+
+      /// reduction of a non-empty range. the left half is always reduced before the right half
+      template <typename _ValueT, typename _IteratorT, typename _ReduceT, typename _TransformT>
+      _ValueT transform_reduce(_IteratorT first, _IteratorT last, _ReduceT& reduce, _TransformT& transform, size_t iGrain, concurrent::thread_pool& oPool){
+        auto iCount = static_cast<size_t>(last - first);
+        if (iCount <= iGrain){
+          _ValueT oRet = transform(*first);
+          for (++first; first != last; ++first){
+            oRet = reduce(std::move(oRet), transform(*first));
+          }
+          return oRet;
+        }
+        auto middle = first + (iCount / 2);
+        std::optional<_ValueT> oLeft;
+        concurrent::task_group oGroup(oPool);
+        oGroup.run([&](){ oLeft.emplace(transform_reduce<_ValueT>(first, middle, reduce, transform, iGrain, oPool)); });
+        auto oRight = transform_reduce<_ValueT>(middle, last, reduce, transform, iGrain, oPool);
+        oGroup.wait();
+        return reduce(std::move(*oLeft), std::move(oRight));
+      }
+
+      /** quick sort that sorts the two partitions concurrently
+      Items equal to the pivot are partitioned out so duplicates cannot unbalance the recursion. Pieces within the
+      grain and pieces past the depth limit are handed to std::sort. No memory beyond the range is needed, which
+      suits ranges that are larger than memory such as a mapped_vector.
+      */
+      template <typename _IteratorT, typename _CompareT>
+      void sort(_IteratorT first, _IteratorT last, _CompareT& comp, size_t iGrain, size_t iDepth, concurrent::thread_pool& oPool){
+        using value_type = typename std::iterator_traits<_IteratorT>::value_type;
+        auto iCount = static_cast<size_t>(last - first);
+        if (iCount <= iGrain || !iDepth){
+          std::sort(first, last, comp);
+          return;
+        }
+        value_type a = *first;
+        value_type b = *(first + (iCount / 2));
+        value_type c = *(last - 1);
+        const value_type& oPivot = (comp(a, b) ? (comp(b, c) ? b : (comp(a, c) ? c : a)) : (comp(a, c) ? a : (comp(b, c) ? c : b)));
+        auto oLess = std::partition(first, last, [&](const value_type& oItem){ return comp(oItem, oPivot); });
+        auto oGreater = std::partition(oLess, last, [&](const value_type& oItem){ return !comp(oPivot, oItem); });
+        concurrent::task_group oGroup(oPool);
+        oGroup.run([&](){ sort(first, oLess, comp, iGrain, iDepth - 1, oPool); });
+        sort(oGreater, last, comp, iGrain, iDepth - 1, oPool);
+        oGroup.wait();
+      }
+
+    }
+#endif
+
+    /** calls fn with each item of [first, last)
+    @param first first item of a random access range
+    @param last end of the range
+    @param fn function called with each item
+    @param iGrain largest number of items processed by one task or 0 to choose one
+    @param oPool pool running the tasks
+    */
+    template <typename _IteratorT, typename _FnT>
+    void for_each(_IteratorT first, _IteratorT last, _FnT fn, size_t iGrain = 0, concurrent::thread_pool& oPool = concurrent::thread_pool::global()){
+      auto iCount = static_cast<size_t>(last - first);
+      _::for_each(first, last, fn, _::grain(iCount, iGrain, oPool), oPool);
+    }
+
+    /** combines init and the transformed items of [first, last) with reduce
+    reduce must be associative. The transformed items are combined in the order of the range.
+    @returns init when the range is empty
+    */
+    template <typename _IteratorT, typename _ValueT, typename _ReduceT, typename _TransformT>
+    _ValueT transform_reduce(_IteratorT first, _IteratorT last, _ValueT init, _ReduceT reduce, _TransformT transform, size_t iGrain = 0, concurrent::thread_pool& oPool = concurrent::thread_pool::global()){
+      auto iCount = static_cast<size_t>(last - first);
+      if (!iCount){
+        return init;
+      }
+      return reduce(std::move(init), _::transform_reduce<_ValueT>(first, last, reduce, transform, _::grain(iCount, iGrain, oPool), oPool));
+    }
+
+    /** sorts [first, last) in place. the sort is not stable
+    @param iGrain largest number of items sorted by std::sort in one task or 0 to choose one
+    */
+    template <typename _IteratorT, typename _CompareT = std::less<>>
+    void sort(_IteratorT first, _IteratorT last, _CompareT comp = _CompareT(), size_t iGrain = 0, concurrent::thread_pool& oPool = concurrent::thread_pool::global()){
+      auto iCount = static_cast<size_t>(last - first);
+      size_t iDepth = 0;
+      for (auto i = iCount; i; i >>= 1){
+        iDepth += 2;
+      }
+      _::sort(first, last, comp, _::grain(iCount, iGrain, oPool, 1024), iDepth, oPool);
+    }
+
+    /** calls fn(key, value) for each record of a btree
+    The tree must not be modified until the call returns.
+    @param iGrain smallest number of records processed by one task or 0 to choose one. records are split at leaf boundaries
+    */
+    template <typename _KeyT, typename _MappedT, size_t _Order, size_t _PageSize, size_t _CacheSize, typename _FnT>
+    void for_each(const btree<_KeyT, _MappedT, _Order, _PageSize, _CacheSize>& oTree, _FnT fn, size_t iGrain = 0, concurrent::thread_pool& oPool = concurrent::thread_pool::global()){
+      using leaf_range = typename btree<_KeyT, _MappedT, _Order, _PageSize, _CacheSize>::leaf_range;
+      concurrent::task_group oGroup(oPool);
+      oTree.for_each_leaf_range(_::grain(oTree.size(), iGrain, oPool), [&](leaf_range&& oRange){
+        oGroup.run([&fn, oRange = std::move(oRange)](){ oRange.for_each(fn); });
+      });
+      oGroup.wait();
+    }
+
+    /** combines init and the transformed records of a btree with reduce
+    transform is called as transform(key, value). reduce must be associative and the records are combined in key order.
+    The tree must not be modified until the call returns.
+    */
+    template <typename _KeyT, typename _MappedT, size_t _Order, size_t _PageSize, size_t _CacheSize, typename _ValueT, typename _ReduceT, typename _TransformT>
+    _ValueT transform_reduce(const btree<_KeyT, _MappedT, _Order, _PageSize, _CacheSize>& oTree, _ValueT init, _ReduceT reduce, _TransformT transform, size_t iGrain = 0, concurrent::thread_pool& oPool = concurrent::thread_pool::global()){
+      using leaf_range = typename btree<_KeyT, _MappedT, _Order, _PageSize, _CacheSize>::leaf_range;
+      std::vector<std::unique_ptr<std::optional<_ValueT>>> oPartials;
+      {
+        concurrent::task_group oGroup(oPool);
+        oTree.for_each_leaf_range(_::grain(oTree.size(), iGrain, oPool), [&](leaf_range&& oRange){
+          oPartials.emplace_back(new std::optional<_ValueT>);
+          auto pPartial = oPartials.back().get();
+          oGroup.run([&reduce, &transform, pPartial, oRange = std::move(oRange)](){
+            oRange.for_each([&](const _KeyT& oKey, const _MappedT& oValue){
+              if (*pPartial){
+                *pPartial = reduce(std::move(**pPartial), transform(oKey, oValue));
+              } else{
+                pPartial->emplace(transform(oKey, oValue));
+              }
+            });
+          });
+        });
+        oGroup.wait();
+      }
+      for (auto & oPartial : oPartials){
+        init = reduce(std::move(init), std::move(**oPartial));
+      }
+      return init;
+    }
+
+  }
+}
@@ -11,6 +11,14 @@ namespace xtd{
 /// @def here() creates an xtd::source_location at the definition site
 #define here() xtd::source_location(__FILE__,__LINE__)
 
+#if (defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1926))
+  #define XTD_CALLER_FILE __builtin_FILE()
+  #define XTD_CALLER_LINE __builtin_LINE()
+#else
+  #define XTD_CALLER_FILE "unknown"
+  #define XTD_CALLER_LINE 0
+#endif
+
   /** Contains information about the location of source code
   Used in error reporting and logging
   */
@@ -26,6 +34,13 @@ namespace xtd{
       _line = src._line;
       return *this;
     }
+    /** location of the caller when used as a default argument
+    Compilers without the __builtin_FILE and __builtin_LINE intrinsics report an unknown location.
+    */
+    static source_location current(const char * File = XTD_CALLER_FILE, int Line = XTD_CALLER_LINE){
+      return source_location(File, Line);
+    }
+
     const char * file() const{ return _file; }
     void file(const char * newval) { _file = newval; }
 
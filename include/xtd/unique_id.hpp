@@ -7,6 +7,8 @@
 #pragma once
 #include <xtd/xtd.hpp>
 #include <xtd/string.hpp>
+#include <cstdint>
+#include <functional>
 #include <ios>
 #include <fstream>
 #include <cstring>
@@ -61,6 +63,12 @@ namespace xtd{
     bool operator<(const unique_id& rhs) const{
       return *this < static_cast<const uuid_t&>(rhs);
     }
+    bool operator==(const unique_id& rhs) const{
+      return 0 == std::memcmp(this, &rhs, sizeof(uuid_t));
+    }
+    bool operator!=(const unique_id& rhs) const{
+      return !(*this == rhs);
+    }
     static unique_id nullid(){
       uuid_t oRet{ 0, 0, 0,{ 0, 0, 0, 0, 0, 0, 0, 0 } };
       return oRet;
@@ -107,6 +115,12 @@ namespace xtd{
     bool operator<(const uuid_t& rhs) const {
       return -1 == uuid_compare(_uuid, rhs);
     }
+    bool operator==(const unique_id& rhs) const {
+      return 0 == uuid_compare(_uuid, rhs._uuid);
+    }
+    bool operator!=(const unique_id& rhs) const {
+      return !(*this == rhs);
+    }
     static const unique_id& nullid() {
       static uuid_t null_id = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
       static unique_id oRet(null_id);
@@ -148,6 +162,12 @@ namespace xtd{
     bool operator<(const unique_id& rhs) const {
       return -1 == memcmp(_uuid, rhs._uuid, sizeof(uuid_t));
     }
+    bool operator==(const unique_id& rhs) const {
+      return 0 == memcmp(_uuid, rhs._uuid, sizeof(uuid_t));
+    }
+    bool operator!=(const unique_id& rhs) const {
+      return !(*this == rhs);
+    }
     static const unique_id& nullid() {
       static uuid_t null_id = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
       static unique_id oRet(null_id);
@@ -175,3 +195,15 @@ namespace xtd{
 
 
 }
+
+namespace std{
+  /// hashes an xtd::unique_id so it can key unordered and concurrent containers
+  template <> struct hash<xtd::unique_id>{
+    size_t operator()(const xtd::unique_id& value) const{
+      static_assert(16 == sizeof(xtd::unique_id), "unexpected unique_id layout");
+      uint64_t x[2];
+      std::memcpy(x, &value, sizeof(x));
+      return std::hash<uint64_t>()(x[0] ^ (x[1] * 0x9E3779B97F4A7C15ULL));
+    }
+  };
+}
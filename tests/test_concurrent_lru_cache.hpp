@@ -0,0 +1,172 @@
+/** @file
+xtd::concurrent::lru_cache system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <xtd/concurrent/lru_cache.hpp>
+
+TEST(test_concurrent_lru_cache, find_insert_erase){
+  xtd::concurrent::lru_cache<int, std::string> oCache(64);
+  EXPECT_EQ(64U, oCache.capacity());
+  EXPECT_FALSE(oCache.find(1));
+  EXPECT_TRUE(oCache.insert(1, "one"));
+  EXPECT_FALSE(oCache.insert(1, "uno"));
+  EXPECT_EQ("one", *oCache.find(1));
+  EXPECT_FALSE(oCache.insert_or_assign(1, "uno"));
+  EXPECT_EQ("uno", *oCache.find(1));
+  EXPECT_TRUE(oCache.insert_or_assign(2, "two"));
+  EXPECT_EQ(2U, oCache.size());
+  size_t iLength = 0;
+  EXPECT_TRUE(oCache.visit(2, [&](const std::string& sValue){ iLength = sValue.size(); }));
+  EXPECT_EQ(3U, iLength);
+  EXPECT_TRUE(oCache.erase(1));
+  EXPECT_FALSE(oCache.erase(1));
+  EXPECT_FALSE(oCache.find(1));
+  oCache.clear();
+  EXPECT_EQ(0U, oCache.size());
+  EXPECT_FALSE(oCache.find(2));
+}
+
+TEST(test_concurrent_lru_cache, evicts_least_recently_used){
+  xtd::concurrent::lru_cache<int, int, std::hash<int>, 1> oCache(3);
+  oCache.insert(1, 10);
+  oCache.insert(2, 20);
+  oCache.insert(3, 30);
+  // the buffered hit is applied before the insert evicts
+  EXPECT_EQ(10, *oCache.find(1));
+  oCache.insert(4, 40);
+  EXPECT_EQ(3U, oCache.size());
+  EXPECT_TRUE(oCache.find(1));
+  EXPECT_FALSE(oCache.find(2));
+  EXPECT_TRUE(oCache.find(3));
+  EXPECT_TRUE(oCache.find(4));
+}
+
+TEST(test_concurrent_lru_cache, get_or_load){
+  xtd::concurrent::lru_cache<int, int> oCache(16);
+  int iLoads = 0;
+  auto oLoader = [&](const int& key){ ++iLoads; return key * 2; };
+  EXPECT_EQ(8, oCache.get_or_load(4, oLoader));
+  EXPECT_EQ(8, oCache.get_or_load(4, oLoader));
+  EXPECT_EQ(1, iLoads);
+  EXPECT_THROW(oCache.get_or_load(5, [](const int&) -> int { throw std::runtime_error("failed"); }), std::runtime_error);
+  EXPECT_FALSE(oCache.find(5));
+}
+
+TEST(test_concurrent_lru_cache, churn){
+  // many more keys than the capacity so entries and tables are constantly retired and reused
+  xtd::concurrent::lru_cache<int, int, std::hash<int>, 4> oCache(40);
+  for (int i = 0; i < 100000; ++i){
+    oCache.insert_or_assign(i % 1000, i);
+    if (0 == i % 7){
+      oCache.erase((i * 13) % 1000);
+    }
+    ASSERT_LE(oCache.size(), oCache.capacity());
+  }
+  EXPECT_EQ(99999, *oCache.find(999));
+}
+
+TEST(test_concurrent_lru_cache, concurrent){
+  xtd::concurrent::lru_cache<int, std::string> oCache(256);
+  std::atomic<size_t> iErrors(0);
+  std::vector<std::thread> oThreads;
+  for (int t = 0; t < 4; ++t){
+    oThreads.emplace_back([&, t](){
+      std::mt19937 oRandom(t);
+      for (int i = 0; i < 20000; ++i){
+        // skewed so some keys stay hot
+        int key = static_cast<int>(oRandom() % 1024) & static_cast<int>(oRandom() % 1024);
+        switch (oRandom() % 8){
+          case 0:
+            oCache.insert_or_assign(key, std::to_string(key));
+            break;
+          case 1:
+            oCache.erase(key);
+            break;
+          default:
+            if (std::to_string(key) != oCache.get_or_load(key, [](const int& k){ return std::to_string(k); })){
+              ++iErrors;
+            }
+            if (auto oValue = oCache.find(key)){
+              if (std::to_string(key) != *oValue){
+                ++iErrors;
+              }
+            }
+        }
+      }
+    });
+  }
+  for (auto & oThread : oThreads){
+    oThread.join();
+  }
+  EXPECT_EQ(0U, iErrors.load());
+  EXPECT_LE(oCache.size(), oCache.capacity());
+}
+
+TEST(test_concurrent_lru_cache, coalesces_loads){
+  xtd::concurrent::lru_cache<int, int> oCache(16);
+  std::atomic<int> iLoads(0);
+  std::atomic<bool> bFail(true);
+  auto oLoader = [&](const int& key){
+    ++iLoads;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    if (bFail.load()){
+      throw std::runtime_error("failed");
+    }
+    return key * 2;
+  };
+  std::atomic<int> iFailures(0);
+  std::atomic<int> iSum(0);
+  auto fnRun = [&](){
+    std::vector<std::thread> oThreads;
+    for (int t = 0; t < 8; ++t){
+      oThreads.emplace_back([&](){
+        try{
+          iSum += oCache.get_or_load(21, oLoader);
+        } catch (const std::runtime_error&){
+          ++iFailures;
+        }
+      });
+    }
+    for (auto & oThread : oThreads){
+      oThread.join();
+    }
+  };
+  // the waiters receive the exception of the load and the next miss loads again
+  fnRun();
+  EXPECT_EQ(8, iFailures.load());
+  EXPECT_LE(1, iLoads.load());
+  EXPECT_GT(8, iLoads.load());
+  bFail = false;
+  iLoads = 0;
+  fnRun();
+  EXPECT_EQ(8 * 42, iSum.load());
+  EXPECT_LE(1, iLoads.load());
+  EXPECT_GT(8, iLoads.load());
+}
+
+TEST(test_concurrent_lru_cache, stats){
+  xtd::concurrent::lru_cache<int, int, std::hash<int>, 1> oCache(2);
+  auto oLoader = [](const int& key){ return key; };
+  oCache.get_or_load(1, oLoader);
+  oCache.get_or_load(1, oLoader);
+  oCache.get_or_load(2, oLoader);
+  oCache.get_or_load(3, oLoader);
+  EXPECT_FALSE(oCache.find(4));
+  EXPECT_THROW(oCache.get_or_load(5, [](const int&) -> int { throw std::runtime_error("failed"); }), std::runtime_error);
+  auto oStats = oCache.stats();
+  EXPECT_EQ(1U, oStats.hits);
+  EXPECT_EQ(5U, oStats.misses);
+  EXPECT_EQ(3U, oStats.loads);
+  EXPECT_EQ(1U, oStats.load_failures);
+  EXPECT_EQ(1U, oStats.evictions);
+  EXPECT_LT(0, oStats.load_time.count());
+}
@@ -0,0 +1,99 @@
+/** @file
+xtd::concurrent::distributed_rw_lock system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <xtd/concurrent/distributed_rw_lock.hpp>
+
+TEST(test_distributed_rw_lock, readers){
+  xtd::concurrent::distributed_rw_lock oLock;
+  oLock.lock_read();
+  ASSERT_EQ(1, oLock.readers());
+  ASSERT_TRUE(oLock.try_lock_read());
+  ASSERT_EQ(2, oLock.readers());
+  ASSERT_FALSE(oLock.try_lock_write());
+  oLock.unlock_read();
+  oLock.unlock_read();
+  ASSERT_EQ(0, oLock.readers());
+  ASSERT_TRUE(oLock.try_lock_write());
+  ASSERT_FALSE(oLock.try_lock_read());
+  ASSERT_FALSE(oLock.try_lock_write());
+  oLock.unlock_write();
+  ASSERT_TRUE(oLock.try_lock_read());
+  oLock.unlock_read();
+}
+
+TEST(test_distributed_rw_lock, scope){
+  xtd::concurrent::distributed_rw_lock rw;
+  {
+    xtd::concurrent::distributed_rw_lock::scope_read oLock(rw);
+    ASSERT_EQ(1, rw.readers());
+  }
+  {
+    xtd::concurrent::distributed_rw_lock::scope_write oLock(rw);
+    ASSERT_FALSE(rw.try_lock_read());
+  }
+  ASSERT_EQ(0, rw.readers());
+  ASSERT_TRUE(rw.try_lock_write());
+}
+
+TEST(test_distributed_rw_lock, writer_preference){
+  xtd::concurrent::distributed_rw_lock_base<xtd::concurrent::yield_wait_policy> rw;
+  std::atomic<bool> bWritten(false);
+  rw.lock_read();
+  std::thread oWriter([&](){
+    rw.lock_write();
+    bWritten = true;
+    rw.unlock_write();
+  });
+  // the announced writer turns away new readers while it waits for the existing one
+  while (rw.try_lock_read()){
+    rw.unlock_read();
+    std::this_thread::yield();
+  }
+  ASSERT_FALSE(bWritten);
+  rw.unlock_read();
+  oWriter.join();
+  ASSERT_TRUE(bWritten);
+}
+
+template <typename _LockT>
+void distributed_rw_lock_contention(){
+  _LockT rw;
+  size_t iValue = 0;
+  std::atomic<bool> bTorn(false);
+  std::vector<std::thread> oThreads;
+  for (int t = 0; t < 8; ++t){
+    oThreads.emplace_back([&, t](){
+      for (int i = 0; i < 5000; ++i){
+        if (0 == t % 4){
+          typename _LockT::scope_write oLock(rw);
+          // a reader observing the odd value would have overlapped a writer
+          ++iValue;
+          ++iValue;
+        } else{
+          typename _LockT::scope_read oLock(rw);
+          if (iValue % 2) bTorn = true;
+        }
+      }
+    });
+  }
+  for (auto & oThread : oThreads){
+    oThread.join();
+  }
+  ASSERT_FALSE(bTorn);
+  ASSERT_EQ(2 * 5000 * 2, iValue);
+  ASSERT_EQ(0, rw.readers());
+}
+
+TEST(test_distributed_rw_lock, contention){
+  distributed_rw_lock_contention<xtd::concurrent::distributed_rw_lock_base<xtd::concurrent::yield_wait_policy>>();
+}
+
+TEST(test_distributed_rw_lock, adaptive_wait_policy){
+  distributed_rw_lock_contention<xtd::concurrent::distributed_rw_lock_base<xtd::concurrent::adaptive_wait_policy>>();
+}
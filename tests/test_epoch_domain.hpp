@@ -0,0 +1,112 @@
+/** @file
+xtd::concurrent::epoch_domain system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+#pragma once
+
+#include <future>
+
+#include <xtd/concurrent/epoch_domain.hpp>
+
+namespace{
+  struct epoch_counted{
+    explicit epoch_counted(std::atomic<int>& oCount) : _count(oCount){ ++_count; }
+    ~epoch_counted(){ --_count; }
+    std::atomic<int>& _count;
+  };
+
+  void epoch_drain(xtd::concurrent::epoch_domain& oDomain){
+    for (int i = 0; i < 10 && oDomain.pending(); ++i){
+      oDomain.collect();
+    }
+  }
+}
+
+TEST(test_epoch_domain, initialization){
+  EXPECT_NO_THROW(xtd::concurrent::epoch_domain oDomain);
+  EXPECT_NO_THROW(xtd::concurrent::epoch_domain::guard oGuard);
+}
+
+TEST(test_epoch_domain, retire){
+  std::atomic<int> iCount(0);
+  xtd::concurrent::epoch_domain oDomain;
+  oDomain.retire(new epoch_counted(iCount));
+  ASSERT_EQ(1, iCount);
+  ASSERT_EQ(1, oDomain.pending());
+  epoch_drain(oDomain);
+  ASSERT_EQ(0, iCount);
+  ASSERT_EQ(0, oDomain.pending());
+}
+
+TEST(test_epoch_domain, guard_blocks_reclamation){
+  std::atomic<int> iCount(0);
+  xtd::concurrent::epoch_domain oDomain;
+  std::promise<void> oEntered, oRelease;
+  auto oReader = std::async(std::launch::async, [&](){
+    xtd::concurrent::epoch_domain::guard oGuard(oDomain);
+    oEntered.set_value();
+    oRelease.get_future().wait();
+  });
+  oEntered.get_future().wait();
+  oDomain.retire(new epoch_counted(iCount));
+  epoch_drain(oDomain);
+  ASSERT_EQ(1, iCount);
+  oRelease.set_value();
+  oReader.get();
+  epoch_drain(oDomain);
+  ASSERT_EQ(0, iCount);
+}
+
+TEST(test_epoch_domain, nested_guard){
+  std::atomic<int> iCount(0);
+  xtd::concurrent::epoch_domain oDomain;
+  {
+    xtd::concurrent::epoch_domain::guard oOuter(oDomain);
+    {
+      xtd::concurrent::epoch_domain::guard oInner(oDomain);
+    }
+    oDomain.retire(new epoch_counted(iCount));
+    epoch_drain(oDomain);
+    ASSERT_EQ(1, iCount);
+  }
+  epoch_drain(oDomain);
+  ASSERT_EQ(0, iCount);
+}
+
+TEST(test_epoch_domain, destroy_frees_pending){
+  std::atomic<int> iCount(0);
+  {
+    xtd::concurrent::epoch_domain oDomain;
+    xtd::concurrent::epoch_domain::guard oGuard(oDomain);
+    for (int i = 0; i < 10; ++i){
+      oDomain.retire(new epoch_counted(iCount));
+    }
+    ASSERT_EQ(10, iCount);
+  }
+  ASSERT_EQ(0, iCount);
+}
+
+TEST(test_epoch_domain, concurrent_retire){
+  std::atomic<int> iCount(0);
+  {
+    xtd::concurrent::epoch_domain oDomain;
+    auto retirefn = [&]() -> bool{
+      for (int i = 0; i < 10000; ++i){
+        xtd::concurrent::epoch_domain::guard oGuard(oDomain);
+        oDomain.retire(new epoch_counted(iCount));
+      }
+      return true;
+    };
+    std::vector<std::future<bool>> oThreads;
+    for (int i = 0; i < 8; ++i){
+      oThreads.push_back(std::async(std::launch::async, retirefn));
+    }
+    for (auto & oThread : oThreads){
+      EXPECT_TRUE(oThread.get());
+    }
+    // memory is reclaimed while the threads run, not only when the domain is destroyed
+    EXPECT_LT(oDomain.pending(), 80000);
+    EXPECT_EQ(iCount, static_cast<int>(oDomain.pending()));
+  }
+  ASSERT_EQ(0, iCount);
+}
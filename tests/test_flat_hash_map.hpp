@@ -0,0 +1,188 @@
+/** @file
+xtd::concurrent::flat_hash_map system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+#pragma once
+
+#include <future>
+#include <string>
+#include <vector>
+
+#include <xtd/concurrent/flat_hash_map.hpp>
+
+using flat_hash_map_type = xtd::concurrent::flat_hash_map<uint64_t, uint64_t>;
+
+TEST(test_flat_hash_map, initialization) {
+  flat_hash_map_type oMap;
+  ASSERT_EQ(0, oMap.size());
+}
+
+TEST(test_flat_hash_map, insert){
+  flat_hash_map_type oMap;
+  ASSERT_TRUE(oMap.insert(1, 10));
+  ASSERT_TRUE(oMap.insert(2, 20));
+  ASSERT_FALSE(oMap.insert(1, 11));
+  ASSERT_EQ(2, oMap.size());
+}
+
+TEST(test_flat_hash_map, find){
+  flat_hash_map_type oMap;
+  ASSERT_TRUE(oMap.insert(1, 10));
+  uint64_t iValue = 0;
+  ASSERT_TRUE(oMap.find(1, iValue));
+  ASSERT_EQ(10, iValue);
+  ASSERT_FALSE(oMap.find(2, iValue));
+  ASSERT_TRUE(oMap.exists(1));
+  ASSERT_FALSE(oMap.exists(2));
+}
+
+TEST(test_flat_hash_map, remove) {
+  flat_hash_map_type oMap;
+  ASSERT_TRUE(oMap.insert(1, 10));
+  ASSERT_TRUE(oMap.insert(2, 20));
+  ASSERT_TRUE(oMap.remove(1));
+  ASSERT_FALSE(oMap.remove(1));
+  ASSERT_FALSE(oMap.exists(1));
+  ASSERT_TRUE(oMap.exists(2));
+  ASSERT_EQ(1, oMap.size());
+}
+
+TEST(test_flat_hash_map, insert_or_assign_update) {
+  flat_hash_map_type oMap;
+  ASSERT_TRUE(oMap.insert_or_assign(1, 10));
+  ASSERT_FALSE(oMap.insert_or_assign(1, 11));
+  ASSERT_TRUE(oMap.update(1, [](uint64_t& iValue){ iValue *= 2; }));
+  ASSERT_FALSE(oMap.update(2, [](uint64_t& iValue){ iValue *= 2; }));
+  uint64_t iValue = 0;
+  ASSERT_TRUE(oMap.find(1, iValue));
+  ASSERT_EQ(22, iValue);
+}
+
+TEST(test_flat_hash_map, growth) {
+  flat_hash_map_type oMap;
+  for (uint64_t i = 0; i < 100000; ++i){
+    ASSERT_TRUE(oMap.insert(i, i * 2));
+  }
+  ASSERT_EQ(100000, oMap.size());
+  for (uint64_t i = 0; i < 100000; ++i){
+    uint64_t iValue = 0;
+    ASSERT_TRUE(oMap.find(i, iValue));
+    ASSERT_EQ(i * 2, iValue);
+  }
+  for (uint64_t i = 0; i < 100000; i += 2){
+    ASSERT_TRUE(oMap.remove(i));
+  }
+  for (uint64_t i = 0; i < 100000; ++i){
+    ASSERT_EQ(1 == (i & 1), oMap.exists(i));
+  }
+}
+
+TEST(test_flat_hash_map, tombstone_churn) {
+  flat_hash_map_type oMap(64);
+  for (uint64_t i = 0; i < 100000; ++i){
+    ASSERT_TRUE(oMap.insert(i, uint64_t(i)));
+    ASSERT_TRUE(oMap.remove(i));
+  }
+  ASSERT_EQ(0, oMap.size());
+  ASSERT_FALSE(oMap.exists(99999));
+}
+
+TEST(test_flat_hash_map, string_keys) {
+  xtd::concurrent::flat_hash_map<std::string, std::string> oMap;
+  for (int i = 0; i < 1000; ++i){
+    ASSERT_TRUE(oMap.insert(std::to_string(i), std::string(i % 50, 'x')));
+  }
+  std::string sValue;
+  ASSERT_TRUE(oMap.find("42", sValue));
+  ASSERT_EQ(std::string(42, 'x'), sValue);
+  ASSERT_TRUE(oMap.remove("42"));
+  ASSERT_FALSE(oMap.exists("42"));
+}
+
+TEST(test_flat_hash_map, concurrent_insert_remove) {
+  flat_hash_map_type oMap;
+  auto insertfn = [&](uint64_t iStart) -> bool{
+    for (uint64_t i = iStart; i < 200000; i += 4){
+      if (!oMap.insert(i * 0x9E3779B97F4A7C15ULL, uint64_t(i))) return false;
+    }
+    return true;
+  };
+  std::vector<std::future<bool>> oThreads;
+  for (uint64_t i = 0; i < 4; ++i){
+    oThreads.push_back(std::async(std::launch::async, insertfn, i));
+  }
+  for (auto & oThread : oThreads){
+    EXPECT_TRUE(oThread.get());
+  }
+  oThreads.clear();
+  ASSERT_EQ(200000, oMap.size());
+  auto removefn = [&](uint64_t iStart) -> bool{
+    for (uint64_t i = iStart; i < 200000; i += 4){
+      uint64_t iValue = 0;
+      if (!oMap.find(i * 0x9E3779B97F4A7C15ULL, iValue) || i != iValue) return false;
+      if (!oMap.remove(i * 0x9E3779B97F4A7C15ULL)) return false;
+    }
+    return true;
+  };
+  for (uint64_t i = 0; i < 4; ++i){
+    oThreads.push_back(std::async(std::launch::async, removefn, i));
+  }
+  for (auto & oThread : oThreads){
+    EXPECT_TRUE(oThread.get());
+  }
+  ASSERT_EQ(0, oMap.size());
+}
+
+TEST(test_flat_hash_map, concurrent_readers_during_growth) {
+  flat_hash_map_type oMap;
+  for (uint64_t i = 0; i < 1000; ++i){
+    ASSERT_TRUE(oMap.insert(i, uint64_t(i)));
+  }
+  std::atomic<bool> bDone(false);
+  auto readfn = [&]() -> bool{
+    while (!bDone){
+      for (uint64_t i = 0; i < 1000; ++i){
+        uint64_t iValue = 0;
+        if (!oMap.find(i, iValue) || i != iValue) return false;
+      }
+    }
+    return true;
+  };
+  std::vector<std::future<bool>> oThreads;
+  for (int i = 0; i < 4; ++i){
+    oThreads.push_back(std::async(std::launch::async, readfn));
+  }
+  for (uint64_t i = 1000; i < 200000; ++i){
+    ASSERT_TRUE(oMap.insert(i, uint64_t(i)));
+  }
+  bDone = true;
+  for (auto & oThread : oThreads){
+    EXPECT_TRUE(oThread.get());
+  }
+}
+
+TEST(test_flat_hash_map, concurrent_counters) {
+  xtd::concurrent::flat_hash_map<uint32_t, uint64_t> oMap;
+  auto countfn = [&]() -> bool{
+    for (uint32_t i = 0; i < 20000; ++i){
+      auto Key = i % 500;
+      if (!oMap.update(Key, [](uint64_t& iValue){ ++iValue; })){
+        oMap.insert(Key, 0);
+        if (!oMap.update(Key, [](uint64_t& iValue){ ++iValue; })) return false;
+      }
+    }
+    return true;
+  };
+  std::vector<std::future<bool>> oThreads;
+  for (int i = 0; i < 8; ++i){
+    oThreads.push_back(std::async(std::launch::async, countfn));
+  }
+  for (auto & oThread : oThreads){
+    EXPECT_TRUE(oThread.get());
+  }
+  for (uint32_t i = 0; i < 500; ++i){
+    uint64_t iValue = 0;
+    ASSERT_TRUE(oMap.find(i, iValue));
+    ASSERT_EQ(8 * 40, iValue);
+  }
+}
@@ -1,123 +1,543 @@
-/** @file
-xtd::concurrent::hash_map system and unit tests
-@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
-*/
-#include <xtd/concurrent/hash_map.hpp>
-
-using hash_map_type = xtd::concurrent::hash_map<uint16_t, std::string>;
-
-TEST(test_hash_map, initialization) {
-  hash_map_type oMap;
-}
-
-TEST(test_hash_map, insert){
-  hash_map_type oMap;
-  ASSERT_TRUE(oMap.insert(1, "Hello!") );
-  ASSERT_TRUE(oMap.insert(2, "Hello!") );
-  ASSERT_TRUE(oMap.insert(3, "Hello!") );
-  ASSERT_FALSE(oMap.insert(1, "Hello!") );
-  ASSERT_FALSE(oMap.insert(2, "Hello!") );
-  ASSERT_FALSE(oMap.insert(3, "Hello!") );
-}
-
-TEST(test_hash_map, remove) {
-  hash_map_type oMap;
-  ASSERT_TRUE(oMap.insert(1, "Hello!") );
-  ASSERT_TRUE(oMap.insert(4, "Hello!") );
-  ASSERT_TRUE(oMap.insert(7, "Hello!") );
-  ASSERT_TRUE(oMap.remove(1));
-  ASSERT_TRUE(oMap.remove(4) );
-  ASSERT_FALSE(oMap.remove(8) );
-}
-
-
-TEST(test_hash_map, exists) {
-  hash_map_type oMap;
-  oMap.insert(0x1234, "0x1234");
-  oMap.insert(0x4321, "0x4321");
-  ASSERT_TRUE(oMap.exists(0x1234) );
-  ASSERT_FALSE(oMap.exists(0x7890) );
-  ASSERT_TRUE(oMap.exists(0x4321) );
-}
-
-TEST(test_hash_map_iterator, initialization){
-  hash_map_type oMap;
-  {
-    auto oIt = oMap.begin();
-    auto oEnd = oMap.end();
-    auto oBack = oMap.back();
-  }
-  {
-    hash_map_type::iterator_type oEnd;
-  }
-}
-
-TEST(test_hash_map_iterator, comparison){
-  hash_map_type oMap;
-  oMap.insert(0x1234, "0x1234");
-  oMap.insert(0x4321, "0x4321");
-  {
-    auto o1 = oMap.begin();
-    auto o2 = oMap.begin();
-    ASSERT_EQ(o1, o2);
-    ASSERT_EQ(o1, oMap.begin());
-  }
-  {
-    auto o1 = oMap.back();
-    auto o2 = oMap.back();
-    ASSERT_EQ(o1, o2);
-    ASSERT_EQ(o1, oMap.back());
-  }
-  {
-    auto o1 = oMap.end();
-    auto o2 = oMap.end();
-    ASSERT_EQ(o1, o2);
-    ASSERT_EQ(o1, oMap.end());
-  }
-  {
-    ASSERT_NE(oMap.begin(), oMap.end());
-    ASSERT_NE(oMap.begin(), oMap.back());
-    ASSERT_NE(oMap.back(), oMap.end());
-  }
-}
-
-TEST(test_hash_map_iterator, range_for){
-  hash_map_type oMap;
-  ASSERT_TRUE(oMap.insert(0x0001, "0x0001"));
-  ASSERT_TRUE(oMap.insert(0x0010, "0x0010"));
-  ASSERT_TRUE(oMap.insert(0x0100, "0x0100"));
-  ASSERT_TRUE(oMap.insert(0x1000, "0x1000"));
-  int i = 0;
-  for (auto oItem = oMap.begin(); oMap.end() != oItem; ++oItem){
-    ++i;
-  }
-  ASSERT_EQ(i, 4);
-}
-TEST(test_hash_map_iterator, inc_dec){
-  hash_map_type oMap;
-  ASSERT_TRUE(oMap.insert(0x0001, "0x0001"));
-  ASSERT_TRUE(oMap.insert(0x0010, "0x0010"));
-  ASSERT_TRUE(oMap.insert(0x0100, "0x0100"));
-  ASSERT_TRUE(oMap.insert(0x1000, "0x1000"));
-
-  auto o1 = oMap.begin();
-  auto o2 = o1;
-  ++o1;
-  o2++;
-  ASSERT_EQ(o1, o2);
-  ++o1;
-  o2++;
-  ASSERT_EQ(o1, o2);
-  ++o1;
-  o2++;
-  ASSERT_EQ(o1, o2);
-  ASSERT_EQ(o1, oMap.back());
-  --o1;
-  o2--;
-  ASSERT_EQ(o1, o2);
-  --o1;
-  o2--;
-  --o1;
-  o2--;
-  ASSERT_EQ(o1, o2);
-}
+/** @file
+xtd::concurrent::hash_map system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+#include <future>
+#include <string>
+#include <vector>
+
+#include <xtd/concurrent/hash_map.hpp>
+
+using hash_map_type = xtd::concurrent::hash_map<uint16_t, std::string>;
+
+TEST(test_hash_map, initialization) {
+  hash_map_type oMap;
+}
+
+TEST(test_hash_map, insert){
+  hash_map_type oMap;
+  ASSERT_TRUE(oMap.insert(1, "Hello!") );
+  ASSERT_TRUE(oMap.insert(2, "Hello!") );
+  ASSERT_TRUE(oMap.insert(3, "Hello!") );
+  ASSERT_FALSE(oMap.insert(1, "Hello!") );
+  ASSERT_FALSE(oMap.insert(2, "Hello!") );
+  ASSERT_FALSE(oMap.insert(3, "Hello!") );
+}
+
+TEST(test_hash_map, remove) {
+  hash_map_type oMap;
+  ASSERT_TRUE(oMap.insert(1, "Hello!") );
+  ASSERT_TRUE(oMap.insert(4, "Hello!") );
+  ASSERT_TRUE(oMap.insert(7, "Hello!") );
+  ASSERT_TRUE(oMap.remove(1));
+  ASSERT_TRUE(oMap.remove(4) );
+  ASSERT_FALSE(oMap.remove(8) );
+}
+
+
+TEST(test_hash_map, exists) {
+  hash_map_type oMap;
+  oMap.insert(0x1234, "0x1234");
+  oMap.insert(0x4321, "0x4321");
+  ASSERT_TRUE(oMap.exists(0x1234) );
+  ASSERT_FALSE(oMap.exists(0x7890) );
+  ASSERT_TRUE(oMap.exists(0x4321) );
+}
+
+TEST(test_hash_map, find) {
+  hash_map_type oMap;
+  ASSERT_TRUE(oMap.insert(1, "Hello!"));
+  xtd::concurrent::epoch_domain::guard oGuard;
+  auto pValue = oMap.find(1);
+  ASSERT_NE(nullptr, pValue);
+  ASSERT_EQ(std::string("Hello!"), *pValue);
+  ASSERT_TRUE(oMap.remove(1));
+  ASSERT_EQ(std::string("Hello!"), *pValue);
+  ASSERT_EQ(nullptr, oMap.find(1));
+}
+
+TEST(test_hash_map, concurrent_churn) {
+  hash_map_type oMap;
+  auto churnfn = [&](uint16_t iStart) -> bool{
+    for (int iPass = 0; iPass < 20; ++iPass){
+      for (uint32_t i = iStart; i < 0x1000; i += 8){
+        oMap.insert(static_cast<uint16_t>(i), "Hello!");
+        xtd::concurrent::epoch_domain::guard oGuard;
+        // neighbouring keys are removed by other threads while they are read
+        if (auto pValue = oMap.find(static_cast<uint16_t>(i ^ 1))){
+          if (std::string("Hello!") != *pValue) return false;
+        }
+        oMap.remove(static_cast<uint16_t>(i));
+      }
+    }
+    return true;
+  };
+  std::vector<std::future<bool>> oThreads;
+  for (uint16_t i = 0; i < 8; ++i){
+    oThreads.push_back(std::async(std::launch::async, churnfn, i));
+  }
+  for (auto & oThread : oThreads){
+    EXPECT_TRUE(oThread.get());
+  }
+}
+
+namespace{
+  /// forces every key into the same list
+  struct colliding_hasher{
+    uint8_t operator()(const std::string&) const{ return 0; }
+  };
+
+  struct composite_key{
+    uint32_t _id;
+    std::string _name;
+    bool operator==(const composite_key& rhs) const{ return _id == rhs._id && _name == rhs._name; }
+  };
+
+  struct composite_hasher{
+    uint64_t operator()(const composite_key& Key) const{
+      return (uint64_t(Key._id) << 32) ^ std::hash<std::string>()(Key._name);
+    }
+  };
+}
+
+TEST(test_hash_map, string_keys) {
+  xtd::concurrent::hash_map<std::string, int> oMap;
+  for (int i = 0; i < 1000; ++i){
+    ASSERT_TRUE(oMap.insert(std::to_string(i), int(i)));
+  }
+  ASSERT_FALSE(oMap.insert("10", 10));
+  for (int i = 0; i < 1000; ++i){
+    ASSERT_EQ(i, *oMap.find(std::to_string(i)));
+  }
+  ASSERT_FALSE(oMap.exists("1000"));
+  ASSERT_TRUE(oMap.remove("10"));
+  ASSERT_FALSE(oMap.exists("10"));
+  ASSERT_EQ(0, oMap["new"]);
+}
+
+TEST(test_hash_map, collisions) {
+  xtd::concurrent::hash_map<std::string, int, colliding_hasher> oMap;
+  ASSERT_TRUE(oMap.insert("a", 1));
+  ASSERT_TRUE(oMap.insert("b", 2));
+  ASSERT_TRUE(oMap.insert("c", 3));
+  ASSERT_FALSE(oMap.insert("b", 4));
+  ASSERT_EQ(2, *oMap.find("b"));
+  ASSERT_TRUE(oMap.remove("b"));
+  ASSERT_FALSE(oMap.exists("b"));
+  ASSERT_EQ(1, *oMap.find("a"));
+  ASSERT_EQ(3, *oMap.find("c"));
+  int i = 0;
+  for (auto oItem = oMap.begin(); oMap.end() != oItem; ++oItem){
+    ASSERT_TRUE("a" == oItem.key() || "c" == oItem.key());
+    ++i;
+  }
+  ASSERT_EQ(2, i);
+  auto oBack = oMap.back();
+  --oBack;
+  ASSERT_EQ(oMap.begin(), oBack);
+}
+
+TEST(test_hash_map, composite_keys) {
+  xtd::concurrent::hash_map<composite_key, std::string, composite_hasher> oMap;
+  ASSERT_TRUE(oMap.insert(composite_key{ 1, "one" }, "1 one"));
+  ASSERT_TRUE(oMap.insert(composite_key{ 1, "uno" }, "1 uno"));
+  ASSERT_TRUE(oMap.insert(composite_key{ 2, "one" }, "2 one"));
+  ASSERT_EQ(std::string("1 uno"), *oMap.find(composite_key{ 1, "uno" }));
+  ASSERT_FALSE(oMap.exists(composite_key{ 2, "uno" }));
+}
+
+TEST(test_hash_map, concurrent_collisions) {
+  xtd::concurrent::hash_map<std::string, int, colliding_hasher> oMap;
+  auto churnfn = [&](int iStart) -> bool{
+    for (int iPass = 0; iPass < 10; ++iPass){
+      for (int i = iStart; i < 256; i += 4){
+        if (!oMap.insert(std::to_string(i), int(i))) return false;
+      }
+      for (int i = iStart; i < 256; i += 4){
+        xtd::concurrent::epoch_domain::guard oGuard;
+        auto pValue = oMap.find(std::to_string(i));
+        if (!pValue || i != *pValue) return false;
+        if (!oMap.remove(std::to_string(i))) return false;
+      }
+    }
+    return true;
+  };
+  std::vector<std::future<bool>> oThreads;
+  for (int i = 0; i < 4; ++i){
+    oThreads.push_back(std::async(std::launch::async, churnfn, i));
+  }
+  for (auto & oThread : oThreads){
+    EXPECT_TRUE(oThread.get());
+  }
+  ASSERT_EQ(oMap.end(), oMap.begin());
+}
+
+TEST(test_hash_map, insert_or_assign) {
+  hash_map_type oMap;
+  ASSERT_TRUE(oMap.insert_or_assign(1, "one"));
+  ASSERT_FALSE(oMap.insert_or_assign(1, "uno"));
+  ASSERT_EQ(std::string("uno"), *oMap.find(1));
+  ASSERT_TRUE(oMap.remove(1));
+  ASSERT_TRUE(oMap.insert_or_assign(1, "one"));
+}
+
+TEST(test_hash_map, try_emplace) {
+  hash_map_type oMap;
+  ASSERT_TRUE(oMap.try_emplace(1, 3, 'x'));
+  ASSERT_FALSE(oMap.try_emplace(1, 3, 'y'));
+  ASSERT_EQ(std::string("xxx"), *oMap.find(1));
+}
+
+TEST(test_hash_map, compute_if_absent) {
+  hash_map_type oMap;
+  int iCalls = 0;
+  auto oFactory = [&](){ ++iCalls; return std::string("made"); };
+  ASSERT_EQ(std::string("made"), oMap.compute_if_absent(1, oFactory));
+  ASSERT_EQ(std::string("made"), oMap.compute_if_absent(1, oFactory));
+  ASSERT_EQ(1, iCalls);
+}
+
+TEST(test_hash_map, update) {
+  hash_map_type oMap;
+  ASSERT_FALSE(oMap.update(1, [](std::string& sValue){ sValue += "!"; }));
+  ASSERT_TRUE(oMap.insert(1, "Hello"));
+  ASSERT_TRUE(oMap.update(1, [](std::string& sValue){ sValue += "!"; }));
+  ASSERT_EQ(std::string("Hello!"), *oMap.find(1));
+}
+
+TEST(test_hash_map, concurrent_counters) {
+  xtd::concurrent::hash_map<uint32_t, uint64_t> oMap;
+  auto countfn = [&]() -> bool{
+    for (uint32_t i = 0; i < 10000; ++i){
+      auto Key = i % 100;
+      oMap.compute_if_absent(Key, [](){ return uint64_t(0); });
+      if (!oMap.update(Key, [](uint64_t& iValue){ ++iValue; })) return false;
+    }
+    return true;
+  };
+  std::vector<std::future<bool>> oThreads;
+  for (int i = 0; i < 8; ++i){
+    oThreads.push_back(std::async(std::launch::async, countfn));
+  }
+  for (auto & oThread : oThreads){
+    EXPECT_TRUE(oThread.get());
+  }
+  for (uint32_t i = 0; i < 100; ++i){
+    uint64_t iValue = 0;
+    ASSERT_TRUE(oMap.update(i, [&](uint64_t& iCount){ iValue = iCount; }));
+    ASSERT_EQ(800, iValue);
+  }
+}
+
+TEST(test_hash_map, concurrent_insert_or_assign) {
+  xtd::concurrent::hash_map<uint32_t, uint64_t> oMap;
+  auto assignfn = [&](uint64_t iThread) -> bool{
+    for (uint32_t i = 0; i < 10000; ++i){
+      oMap.insert_or_assign(i % 64, uint64_t(iThread));
+      if (0 == i % 7){
+        oMap.remove(i % 64);
+      }
+    }
+    return true;
+  };
+  std::vector<std::future<bool>> oThreads;
+  for (uint64_t i = 0; i < 8; ++i){
+    oThreads.push_back(std::async(std::launch::async, assignfn, i));
+  }
+  for (auto & oThread : oThreads){
+    EXPECT_TRUE(oThread.get());
+  }
+  for (uint32_t i = 0; i < 64; ++i){
+    uint64_t iValue = 0;
+    if (oMap.update(i, [&](uint64_t& iCount){ iValue = iCount; })){
+      ASSERT_LT(iValue, 8);
+    }
+  }
+}
+
+TEST(test_hash_map_iterator, initialization){
+  hash_map_type oMap;
+  {
+    auto oIt = oMap.begin();
+    auto oEnd = oMap.end();
+    auto oBack = oMap.back();
+  }
+  {
+    hash_map_type::iterator_type oEnd;
+  }
+}
+
+TEST(test_hash_map_iterator, comparison){
+  hash_map_type oMap;
+  oMap.insert(0x1234, "0x1234");
+  oMap.insert(0x4321, "0x4321");
+  {
+    auto o1 = oMap.begin();
+    auto o2 = oMap.begin();
+    ASSERT_EQ(o1, o2);
+    ASSERT_EQ(o1, oMap.begin());
+  }
+  {
+    auto o1 = oMap.back();
+    auto o2 = oMap.back();
+    ASSERT_EQ(o1, o2);
+    ASSERT_EQ(o1, oMap.back());
+  }
+  {
+    auto o1 = oMap.end();
+    auto o2 = oMap.end();
+    ASSERT_EQ(o1, o2);
+    ASSERT_EQ(o1, oMap.end());
+  }
+  {
+    ASSERT_NE(oMap.begin(), oMap.end());
+    ASSERT_NE(oMap.begin(), oMap.back());
+    ASSERT_NE(oMap.back(), oMap.end());
+  }
+}
+
+TEST(test_hash_map_iterator, range_for){
+  hash_map_type oMap;
+  ASSERT_TRUE(oMap.insert(0x0001, "0x0001"));
+  ASSERT_TRUE(oMap.insert(0x0010, "0x0010"));
+  ASSERT_TRUE(oMap.insert(0x0100, "0x0100"));
+  ASSERT_TRUE(oMap.insert(0x1000, "0x1000"));
+  int i = 0;
+  for (auto oItem = oMap.begin(); oMap.end() != oItem; ++oItem){
+    ++i;
+  }
+  ASSERT_EQ(i, 4);
+}
+TEST(test_hash_map_iterator, inc_dec){
+  hash_map_type oMap;
+  ASSERT_TRUE(oMap.insert(0x0001, "0x0001"));
+  ASSERT_TRUE(oMap.insert(0x0010, "0x0010"));
+  ASSERT_TRUE(oMap.insert(0x0100, "0x0100"));
+  ASSERT_TRUE(oMap.insert(0x1000, "0x1000"));
+
+  auto o1 = oMap.begin();
+  auto o2 = o1;
+  ++o1;
+  o2++;
+  ASSERT_EQ(o1, o2);
+  ++o1;
+  o2++;
+  ASSERT_EQ(o1, o2);
+  ++o1;
+  o2++;
+  ASSERT_EQ(o1, o2);
+  ASSERT_EQ(o1, oMap.back());
+  --o1;
+  o2--;
+  ASSERT_EQ(o1, o2);
+  --o1;
+  o2--;
+  --o1;
+  o2--;
+  ASSERT_EQ(o1, o2);
+}
+
+TEST(test_hash_map_iterator, concurrent_writers){
+  hash_map_type oMap;
+  // even keys stay in the map for the whole traversal while odd keys churn
+  for (uint32_t i = 0; i < 0x1000; i += 2){
+    ASSERT_TRUE(oMap.insert(static_cast<uint16_t>(i), "Hello!"));
+  }
+  std::atomic<bool> bStop(false);
+  auto churnfn = [&](uint16_t iStart){
+    while (!bStop){
+      for (uint32_t i = iStart; i < 0x1000; i += 8){
+        oMap.insert(static_cast<uint16_t>(i), "Hello!");
+        oMap.remove(static_cast<uint16_t>(i));
+      }
+    }
+  };
+  std::vector<std::future<void>> oThreads;
+  for (uint16_t i = 1; i < 8; i += 2){
+    oThreads.push_back(std::async(std::launch::async, churnfn, i));
+  }
+  for (int iPass = 0; iPass < 20; ++iPass){
+    size_t iEven = 0;
+    for (auto oItem = oMap.begin(); oMap.end() != oItem; ++oItem){
+      ASSERT_EQ(std::string("Hello!"), *oItem);
+      if (!(oItem.key() & 1)) ++iEven;
+    }
+    ASSERT_EQ(0x800, iEven);
+  }
+  bStop = true;
+  for (auto & oThread : oThreads){
+    oThread.get();
+  }
+}
+
+TEST(test_hash_map, for_each){
+  hash_map_type oMap;
+  for (uint32_t i = 0; i < 0x1000; ++i){
+    ASSERT_TRUE(oMap.insert(static_cast<uint16_t>(i), "Hello!"));
+  }
+  size_t iCount = 0;
+  // removing the visited item is allowed
+  oMap.for_each([&](const uint16_t& Key, std::string& sValue){
+    ++iCount;
+    ASSERT_EQ(std::string("Hello!"), sValue);
+    if (Key & 1) oMap.remove(Key);
+  });
+  ASSERT_EQ(0x1000, iCount);
+  iCount = 0;
+  oMap.for_each([&](const uint16_t& Key, std::string&){
+    ++iCount;
+    ASSERT_FALSE(Key & 1);
+  });
+  ASSERT_EQ(0x800, iCount);
+}
+
+TEST(test_hash_map, parallel_for_each){
+  xtd::concurrent::hash_map<uint32_t, uint32_t> oMap;
+  for (uint32_t i = 0; i < 100000; ++i){
+    ASSERT_TRUE(oMap.insert(i, uint32_t(i)));
+  }
+  std::atomic<uint64_t> iCount(0), iSum(0);
+  oMap.parallel_for_each([&](const uint32_t& Key, uint32_t& Value){
+    ++iCount;
+    iSum += Value;
+    if (Key % 3) oMap.remove(Key);
+  }, 4);
+  ASSERT_EQ(100000, iCount.load());
+  ASSERT_EQ(uint64_t(99999) * 100000 / 2, iSum.load());
+  iCount = 0;
+  oMap.parallel_for_each([&](const uint32_t& Key, uint32_t&){
+    if (0 == Key % 3) ++iCount;
+  });
+  ASSERT_EQ(33334, iCount.load());
+}
+
+TEST(test_hash_map, insert_bulk){
+  hash_map_type oMap;
+  ASSERT_TRUE(oMap.insert(7, "existing"));
+  std::vector<std::pair<uint16_t, std::string>> oItems;
+  for (uint32_t i = 0; i < 0x1000; ++i){
+    oItems.emplace_back(static_cast<uint16_t>(i), "Hello!");
+  }
+  ASSERT_EQ(0xfff, oMap.insert_bulk(std::make_move_iterator(oItems.begin()), std::make_move_iterator(oItems.end())));
+  xtd::concurrent::epoch_domain::guard oGuard;
+  ASSERT_EQ(std::string("existing"), *oMap.find(7));
+  ASSERT_EQ(std::string("Hello!"), *oMap.find(0xfff));
+  ASSERT_TRUE(oItems[0].second.empty());
+  // arena entries are removed and replaced like any other
+  ASSERT_TRUE(oMap.remove(0x123));
+  ASSERT_FALSE(oMap.exists(0x123));
+  ASSERT_TRUE(oMap.insert(0x123, "again"));
+  ASSERT_EQ(std::string("again"), *oMap.find(0x123));
+}
+
+TEST(test_hash_map, build_from){
+  std::vector<std::pair<uint64_t, uint64_t>> oItems;
+  for (uint64_t i = 0; i < 200000; ++i){
+    oItems.emplace_back(i * 0x9E3779B97F4A7C15ULL, i);
+  }
+  oItems.emplace_back(oItems[5]);
+  for (size_t iThreads : { 1, 3, 16 }){
+    xtd::concurrent::hash_map<uint64_t, uint64_t> oMap;
+    ASSERT_EQ(200000, oMap.build_from(oItems, iThreads));
+    size_t iCount = 0;
+    oMap.for_each([&](const uint64_t& Key, uint64_t& Value){
+      ++iCount;
+      ASSERT_EQ(Key, Value * 0x9E3779B97F4A7C15ULL);
+    });
+    ASSERT_EQ(200000, iCount);
+    for (uint64_t i = 0; i < 200000; i += 2){
+      ASSERT_TRUE(oMap.remove(i * 0x9E3779B97F4A7C15ULL));
+    }
+    // removed arena entries may outlive the map in the epoch domain
+  }
+}
+
+TEST(test_hash_map, concurrent_build_from){
+  xtd::concurrent::hash_map<uint32_t, uint32_t> oMap;
+  std::vector<std::pair<uint32_t, uint32_t>> oItems;
+  for (uint32_t i = 0; i < 100000; i += 2){
+    oItems.emplace_back(i, i);
+  }
+  // odd keys churn while the even keys are loaded
+  auto churnfn = [&](uint32_t iStart) -> bool{
+    for (uint32_t i = iStart; i < 100000; i += 8){
+      if (!oMap.insert(i, uint32_t(i))) return false;
+      if (!oMap.remove(i)) return false;
+    }
+    return true;
+  };
+  std::vector<std::future<bool>> oThreads;
+  for (uint32_t i = 1; i < 8; i += 2){
+    oThreads.push_back(std::async(std::launch::async, churnfn, i));
+  }
+  ASSERT_EQ(50000, oMap.build_from(oItems, 4));
+  for (auto & oThread : oThreads){
+    EXPECT_TRUE(oThread.get());
+  }
+  for (uint32_t i = 0; i < 100000; ++i){
+    ASSERT_EQ(0 == (i & 1), oMap.exists(i));
+  }
+}
+
+TEST(test_hash_map, stats){
+  hash_map_type oMap;
+  auto oStats = oMap.stats();
+  ASSERT_EQ(0, oStats.entries);
+  ASSERT_EQ(1, oStats.trie_nodes);
+  ASSERT_EQ(4, oStats.occupancy.size());
+  ASSERT_EQ(1, oStats.occupancy[0][0]);
+  ASSERT_TRUE(oMap.insert(0x0001, "Hello!"));
+  ASSERT_TRUE(oMap.insert(0x0011, "Hello!"));
+  ASSERT_TRUE(oMap.insert(0x0002, "Hello!"));
+  oStats = oMap.stats();
+  ASSERT_EQ(3, oStats.entries);
+  ASSERT_EQ(1, oStats.longest_list);
+  // the root uses buckets 1 and 2 and the keys in bucket 1 split on the second nibble
+  ASSERT_EQ(1, oStats.occupancy[0][2]);
+  ASSERT_EQ(1, oStats.occupancy[1][2]);
+  ASSERT_EQ(1, oStats.occupancy[1][1]);
+  ASSERT_EQ(3, oStats.occupancy[3][1]);
+  ASSERT_EQ(1 + 2 + 3 + 3, oStats.trie_nodes);
+  ASSERT_LT(0, oStats.trie_bytes);
+  ASSERT_LE(3 * (sizeof(uint16_t) + sizeof(std::string)), oStats.entry_bytes);
+  ASSERT_EQ(0, oStats.arena_bytes);
+  std::vector<std::pair<uint16_t, std::string>> oItems{ { 0x100, "bulk" } };
+  oMap.insert_bulk(oItems.begin(), oItems.end());
+  ASSERT_LT(0, oMap.stats().arena_bytes);
+}
+
+TEST(test_hash_map, stats_collisions){
+  xtd::concurrent::hash_map<std::string, int, colliding_hasher> oMap;
+  for (int i = 0; i < 10; ++i){
+    ASSERT_TRUE(oMap.insert(std::to_string(i), int(i)));
+  }
+  ASSERT_TRUE(oMap.remove("5"));
+  auto oStats = oMap.stats();
+  ASSERT_EQ(9, oStats.entries);
+  ASSERT_EQ(9, oStats.longest_list);
+  ASSERT_EQ(2, oStats.trie_nodes);
+  ASSERT_EQ(1, oStats.occupancy[1][1]);
+}
+
+TEST(test_hash_map, concurrent_stats){
+  xtd::concurrent::hash_map<uint32_t, uint32_t> oMap;
+  std::atomic<bool> bStop(false);
+  std::vector<std::future<void>> oThreads;
+  for (uint32_t i = 0; i < 4; ++i){
+    oThreads.push_back(std::async(std::launch::async, [&, i](){
+      while (!bStop){
+        for (uint32_t x = 0; x < 64; ++x){
+          oMap.insert(x, uint32_t(i));
+          oMap.remove(x);
+        }
+      }
+    }));
+  }
+  for (int i = 0; i < 100; ++i){
+    ASSERT_GE(64, oMap.stats().entries);
+  }
+  bStop = true;
+  for (auto & oThread : oThreads){
+    oThread.get();
+  }
+}
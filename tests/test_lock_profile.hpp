@@ -0,0 +1,96 @@
+/** @file
+xtd::concurrent::lock_profile system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+#pragma once
+
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+#include <xtd/concurrent/lock_profile.hpp>
+#include <xtd/concurrent/recursive_spin_lock.hpp>
+#include <xtd/concurrent/rw_lock.hpp>
+#include <xtd/concurrent/spin_lock.hpp>
+
+using profiled_spin_lock = xtd::concurrent::spin_lock_base<xtd::concurrent::yield_wait_policy, xtd::concurrent::lock_profile>;
+
+TEST(test_lock_profile, call_sites){
+  profiled_spin_lock oLock;
+  for (int i = 0; i < 3; ++i){
+    profiled_spin_lock::scope_locker oLocker(oLock); int iFirstLine = __LINE__;
+    (void)iFirstLine;
+  }
+  oLock.lock(); int iSecondLine = __LINE__;
+  oLock.unlock();
+  ASSERT_TRUE(oLock.try_lock());
+  oLock.unlock();
+
+  auto oStats = oLock.profile().stats();
+  ASSERT_EQ(5, oStats.totals.acquisitions);
+  ASSERT_EQ(0, oStats.totals.contended);
+  ASSERT_EQ(3, oStats.sites.size());
+  size_t iMatched = 0;
+  for (auto & oSite : oStats.sites){
+    EXPECT_NE(std::string::npos, oSite.file.find("test_lock_profile.hpp"));
+    if (iSecondLine == oSite.line){
+      EXPECT_EQ(1, oSite.counters.acquisitions);
+      ++iMatched;
+    } else if (3 == oSite.counters.acquisitions){
+      ++iMatched;
+    }
+  }
+  ASSERT_EQ(2, iMatched);
+}
+
+TEST(test_lock_profile, wait_and_hold){
+  profiled_spin_lock oLock;
+  oLock.profile().name("test lock");
+  oLock.lock();
+  std::thread oWaiter([&](){
+    profiled_spin_lock::scope_locker oLocker(oLock);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  oLock.unlock();
+  oWaiter.join();
+
+  auto oStats = oLock.profile().stats();
+  ASSERT_EQ(2, oStats.totals.acquisitions);
+  ASSERT_EQ(1, oStats.totals.contended);
+  ASSERT_LT(0, oStats.totals.spins);
+  ASSERT_LE(10000000, oStats.totals.max_wait_ns);
+  ASSERT_LE(10000000, oStats.totals.max_hold_ns);
+
+  std::stringstream oReport;
+  xtd::concurrent::lock_profile::report_all(oReport);
+  ASSERT_NE(std::string::npos, oReport.str().find("test lock: acquisitions 2 contended 1"));
+  oLock.profile().reset();
+  ASSERT_EQ(0, oLock.profile().stats().totals.acquisitions);
+}
+
+TEST(test_lock_profile, rw_lock){
+  using lock_type = xtd::concurrent::rw_lock_base<xtd::concurrent::null_wait_policy, xtd::concurrent::lock_profile>;
+  lock_type rw;
+  {
+    lock_type::scope_read oRead(rw);
+    lock_type::scope_read oRead2(rw);
+  }
+  {
+    lock_type::scope_write oWrite(rw);
+  }
+  auto oStats = rw.profile().stats();
+  ASSERT_EQ(3, oStats.totals.acquisitions);
+  ASSERT_EQ(3, oStats.sites.size());
+}
+
+TEST(test_lock_profile, recursive_spin_lock){
+  using lock_type = xtd::concurrent::recursive_spin_lock_base<xtd::concurrent::null_wait_policy, xtd::concurrent::lock_profile>;
+  lock_type oLock;
+  {
+    lock_type::scope_locker oOuter(oLock);
+    lock_type::scope_locker oInner(oLock);
+  }
+  auto oStats = oLock.profile().stats();
+  ASSERT_EQ(2, oStats.totals.acquisitions);
+  ASSERT_EQ(2, oStats.sites.size());
+}
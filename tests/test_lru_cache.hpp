@@ -5,6 +5,12 @@ lru cache system and unit tests
 
 #include <xtd/lru_cache.hpp>
 
+#include <algorithm>
+#include <list>
+#include <random>
+#include <stdexcept>
+#include <string>
+
 TEST(test_lru_cache, loads_on_miss) {
   int loads = 0;
   auto loader = [&](const int& k) { ++loads; return k * 10; };
@@ -35,3 +41,279 @@ TEST(test_lru_cache, evicts_oldest) {
   ASSERT_EQ(10, cache[1]);
   ASSERT_EQ(4, loads);
 }
+
+TEST(test_lru_cache, hit_refreshes_recency) {
+  int loads = 0;
+  auto loader = [&](const int& k) { ++loads; return k * 10; };
+  xtd::lru_cache<int, int, 2, decltype(loader)> cache(loader);
+  cache[1];
+  cache[2];
+  cache[1];
+  cache[3];
+  ASSERT_EQ(3, loads);
+  ASSERT_NE(nullptr, cache.find(1));
+  ASSERT_EQ(nullptr, cache.find(2));
+  ASSERT_EQ(2U, cache.size());
+}
+
+TEST(test_lru_cache, find_emplace_erase) {
+  auto loader = [](const int& k) { return k * 10; };
+  xtd::lru_cache<int, int, 3, decltype(loader)> cache(loader);
+  ASSERT_EQ(nullptr, cache.find(1));
+  ASSERT_TRUE(cache.empty());
+  ASSERT_EQ(5, cache.emplace(1, 5));
+  ASSERT_EQ(5, cache[1]);
+  ASSERT_EQ(6, cache.emplace(1, 6));
+  ASSERT_EQ(1U, cache.size());
+  ASSERT_TRUE(cache.erase(1));
+  ASSERT_FALSE(cache.erase(1));
+  ASSERT_EQ(10, cache[1]);
+  cache.clear();
+  ASSERT_TRUE(cache.empty());
+  ASSERT_EQ(nullptr, cache.find(1));
+}
+
+TEST(test_lru_cache, failed_load_keeps_entries) {
+  auto loader = [](const int& k) { if (k < 0) throw std::runtime_error("bad key"); return k; };
+  xtd::lru_cache<int, int, 2, decltype(loader)> cache(loader);
+  cache[1];
+  cache[2];
+  ASSERT_THROW(cache[-1], std::runtime_error);
+  ASSERT_EQ(2U, cache.size());
+  ASSERT_NE(nullptr, cache.find(1));
+  ASSERT_NE(nullptr, cache.find(2));
+}
+
+namespace {
+  struct lru_counted {
+    static int copies;
+    int value;
+    explicit lru_counted(int v) : value(v) {}
+    lru_counted(const lru_counted& src) : value(src.value) { ++copies; }
+    lru_counted(lru_counted&& src) : value(src.value) { ++copies; }
+    lru_counted& operator=(const lru_counted&) = delete;
+  };
+  int lru_counted::copies = 0;
+}
+
+TEST(test_lru_cache, values_are_not_copied) {
+  auto loader = [](const int& k) { return lru_counted(k); };
+  xtd::lru_cache<int, lru_counted, 16, decltype(loader)> cache(loader);
+  lru_counted::copies = 0;
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(i % 40, cache[i % 40].value);
+  }
+  ASSERT_EQ(0, lru_counted::copies);
+}
+
+TEST(test_lru_cache, matches_reference_model) {
+  auto loader = [](const int& k) { return k; };
+  xtd::lru_cache<int, int, 64, decltype(loader)> cache(loader);
+  std::list<int> model;
+  std::mt19937 random(9);
+  for (int i = 0; i < 20000; ++i) {
+    int key = static_cast<int>(random() % 128);
+    auto found = std::find(model.begin(), model.end(), key);
+    bool cached = (model.end() != found);
+    ASSERT_EQ(cached, nullptr != cache.find(key));
+    if (cached) {
+      model.erase(found);
+    } else {
+      ASSERT_EQ(key, cache[key]);
+      if (model.size() == 64) model.pop_back();
+    }
+    model.push_front(key);
+    ASSERT_EQ(model.size(), cache.size());
+  }
+}
+
+TEST(test_lru_cache, clock_gives_second_chance) {
+  auto loader = [](const int& k) { return k; };
+  xtd::lru_cache<int, int, 3, decltype(loader), std::hash<int>, xtd::clock_policy> cache(loader);
+  cache[1];
+  cache[2];
+  cache[3];
+  cache[1];
+  cache[4];
+  ASSERT_NE(nullptr, cache.find(1));
+  ASSERT_EQ(nullptr, cache.find(2));
+  ASSERT_NE(nullptr, cache.find(3));
+  ASSERT_NE(nullptr, cache.find(4));
+}
+
+namespace {
+  /// reads hot keys twice then scans many keys once while still reading the hot keys and returns how many hot reads hit
+  template <typename _policy_t>
+  int hot_hits_during_scan() {
+    auto loader = [](const int& k) { return k; };
+    xtd::lru_cache<int, int, 100, decltype(loader), std::hash<int>, _policy_t> cache(loader);
+    for (int pass = 0; pass < 2; ++pass) {
+      for (int i = 0; i < 50; ++i) cache[i];
+    }
+    int ret = 0;
+    for (int i = 0; i < 10000; ++i) {
+      cache[1000 + i];
+      if (0 == i % 4) {
+        ret += (nullptr != cache.find(i / 4 % 50));
+        cache[i / 4 % 50];
+      }
+    }
+    return ret;
+  }
+
+  /// random loads, hits and erases checked against the cached values, including across a move
+  template <typename _policy_t>
+  void exercise_policy() {
+    auto loader = [](const int& k) { return k * 3; };
+    using cache_type = xtd::lru_cache<int, int, 32, decltype(loader), std::hash<int>, _policy_t>;
+    cache_type first(loader);
+    std::mt19937 random(11);
+    for (int i = 0; i < 5000; ++i) {
+      int key = static_cast<int>(random() % 100);
+      if (0 == random() % 10) {
+        first.erase(key);
+      } else {
+        ASSERT_EQ(key * 3, first[key]);
+      }
+      ASSERT_LE(first.size(), 32U);
+    }
+    cache_type second(std::move(first));
+    ASSERT_TRUE(first.empty());
+    for (int i = 0; i < 5000; ++i) {
+      int key = static_cast<int>(random() % 100);
+      ASSERT_EQ(key * 3, second[key]);
+      ASSERT_LE(second.size(), 32U);
+    }
+    ASSERT_EQ(32U, second.size());
+    second.clear();
+    ASSERT_TRUE(second.empty());
+    ASSERT_EQ(6, second[2]);
+  }
+}
+
+TEST(test_lru_cache, policies_are_consistent) {
+  exercise_policy<xtd::lru_policy>();
+  exercise_policy<xtd::clock_policy>();
+  exercise_policy<xtd::slru_policy>();
+  exercise_policy<xtd::tinylfu_policy>();
+}
+
+TEST(test_lru_cache, scan_resistance) {
+  // only the hot reads before the scan pushes the first pass out hit
+  ASSERT_GT(50, hot_hits_during_scan<xtd::lru_policy>());
+  ASSERT_GT(50, hot_hits_during_scan<xtd::clock_policy>());
+  ASSERT_EQ(2500, hot_hits_during_scan<xtd::slru_policy>());
+  ASSERT_LT(2400, hot_hits_during_scan<xtd::tinylfu_policy>());
+}
+
+TEST(test_lru_cache, stats) {
+  auto loader = [](const int& k) { if (k < 0) throw std::runtime_error("bad key"); return k; };
+  xtd::lru_cache<int, int, 2, decltype(loader)> cache(loader);
+  cache[1];
+  cache[1];
+  cache[2];
+  cache[3];
+  ASSERT_EQ(nullptr, cache.find(1));
+  ASSERT_THROW(cache[-1], std::runtime_error);
+  auto& stats = cache.stats();
+  ASSERT_EQ(1U, stats.hits);
+  ASSERT_EQ(5U, stats.misses);
+  ASSERT_EQ(3U, stats.loads);
+  ASSERT_EQ(1U, stats.load_failures);
+  ASSERT_EQ(1U, stats.evictions);
+  ASSERT_DOUBLE_EQ(1.0 / 6, stats.hit_ratio());
+}
+
+TEST(test_lru_cache, runtime_capacity) {
+  auto loader = [](const int& k) { return k; };
+  xtd::lru_cache<int, int, 64, decltype(loader)> cache(loader, 3);
+  ASSERT_EQ(3U, cache.capacity());
+  for (int i = 0; i < 10; ++i) cache[i];
+  ASSERT_EQ(3U, cache.size());
+  ASSERT_EQ(3U, cache.weight());
+  ASSERT_NE(nullptr, cache.find(9));
+  ASSERT_EQ(nullptr, cache.find(6));
+}
+
+namespace {
+  struct string_weigher {
+    size_t operator()(const int&, const std::string& value) const { return value.size(); }
+  };
+}
+
+TEST(test_lru_cache, weighted_capacity) {
+  auto loader = [](const int& k) { return std::string(static_cast<size_t>(k), 'x'); };
+  xtd::lru_cache<int, std::string, 1, decltype(loader), std::hash<int>, xtd::lru_policy, string_weigher> cache(loader, 10);
+  cache[4];
+  cache[5];
+  ASSERT_EQ(9U, cache.weight());
+  cache[3];
+  ASSERT_EQ(nullptr, cache.find(4));
+  ASSERT_EQ(8U, cache.weight());
+  // a value heavier than the capacity displaces everything else but is kept
+  ASSERT_EQ(12U, cache[12].size());
+  ASSERT_EQ(1U, cache.size());
+  ASSERT_EQ(12U, cache.weight());
+  cache[2];
+  ASSERT_EQ(nullptr, cache.find(12));
+  ASSERT_EQ(2U, cache.weight());
+  ASSERT_TRUE(cache.erase(2));
+  ASSERT_EQ(0U, cache.weight());
+}
+
+TEST(test_lru_cache, resize_evicts_incrementally) {
+  auto loader = [](const int& k) { return k; };
+  using cache_type = xtd::lru_cache<int, int, 100, decltype(loader)>;
+  cache_type cache(loader);
+  for (int i = 0; i < 100; ++i) cache[i];
+  ASSERT_FALSE(cache.resize(10, 5));
+  ASSERT_EQ(95U, cache.size());
+  // the oldest values go first
+  ASSERT_EQ(nullptr, cache.find(4));
+  ASSERT_NE(nullptr, cache.find(5));
+  cache[1000];
+  ASSERT_EQ(95U - cache_type::eviction_batch, cache.size());
+  for (int i = 1001; cache.size() > 10; ++i) cache[i];
+  ASSERT_EQ(10U, cache.size());
+  ASSERT_TRUE(cache.resize(20));
+  for (int i = 0; i < 100; ++i) cache[i];
+  ASSERT_EQ(20U, cache.size());
+  ASSERT_TRUE(cache.resize(5));
+  ASSERT_EQ(5U, cache.size());
+}
+
+namespace {
+  struct key_weigher {
+    size_t operator()(const int& key, const int&) const { return 1 + key % 7; }
+  };
+
+  /// random loads, hits and erases with varying weights checked against the total weight
+  template <typename _policy_t>
+  void exercise_weighted_policy() {
+    auto loader = [](const int& k) { return k; };
+    xtd::lru_cache<int, int, 1, decltype(loader), std::hash<int>, _policy_t, key_weigher> cache(loader, 64);
+    std::mt19937 random(13);
+    for (int i = 0; i < 5000; ++i) {
+      int key = static_cast<int>(random() % 200);
+      if (0 == random() % 10) {
+        cache.erase(key);
+      } else {
+        ASSERT_EQ(key, cache[key]);
+      }
+      if (0 == i % 1000) cache.resize(32 + random() % 64);
+      ASSERT_LE(cache.weight(), cache.capacity());
+    }
+    size_t weight = 0;
+    for (int i = 0; i < 200; ++i) {
+      if (cache.find(i)) weight += key_weigher()(i, i);
+    }
+    ASSERT_EQ(weight, cache.weight());
+  }
+}
+
+TEST(test_lru_cache, weighted_policies) {
+  exercise_weighted_policy<xtd::lru_policy>();
+  exercise_weighted_policy<xtd::clock_policy>();
+  exercise_weighted_policy<xtd::slru_policy>();
+  exercise_weighted_policy<xtd::tinylfu_policy>();
+}
@@ -0,0 +1,65 @@
+/** @file
+xtd::concurrent::mcs_lock system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+
+#include <thread>
+#include <vector>
+
+#include <xtd/concurrent/mcs_lock.hpp>
+
+TEST(test_mcs_lock, try_lock){
+  xtd::concurrent::mcs_lock oLock;
+  EXPECT_TRUE(oLock.try_lock());
+  EXPECT_FALSE(oLock.try_lock());
+  oLock.unlock();
+  EXPECT_TRUE(oLock.try_lock());
+  oLock.unlock();
+  {
+    xtd::concurrent::mcs_lock::scope_locker oLocker(oLock);
+    EXPECT_FALSE(oLock.try_lock());
+  }
+  EXPECT_TRUE(oLock.try_lock());
+}
+
+template <typename _LockT>
+void mcs_lock_contention(){
+  _LockT oLock;
+  size_t iCount = 0;
+  std::vector<std::thread> oThreads;
+  for (int t = 0; t < 8; ++t){
+    oThreads.emplace_back([&](){
+      for (int i = 0; i < 20000; ++i){
+        typename _LockT::scope_locker oLocker(oLock);
+        ++iCount;
+      }
+    });
+  }
+  for (auto & oThread : oThreads){
+    oThread.join();
+  }
+  ASSERT_EQ(8 * 20000, iCount);
+  ASSERT_TRUE(oLock.try_lock());
+}
+
+TEST(test_mcs_lock, contention){
+  mcs_lock_contention<xtd::concurrent::mcs_lock_base<xtd::concurrent::yield_wait_policy>>();
+}
+
+TEST(test_mcs_lock, adaptive_wait_policy){
+  mcs_lock_contention<xtd::concurrent::mcs_lock_base<xtd::concurrent::adaptive_wait_policy>>();
+}
+
+TEST(test_mcs_lock, nested){
+  xtd::concurrent::mcs_lock oOuter;
+  xtd::concurrent::mcs_lock oInner;
+  // a thread holds a node per lock so locks may be released in any order
+  oOuter.lock();
+  oInner.lock();
+  oOuter.unlock();
+  EXPECT_TRUE(oOuter.try_lock());
+  oInner.unlock();
+  oOuter.unlock();
+  EXPECT_TRUE(oInner.try_lock());
+  oInner.unlock();
+}
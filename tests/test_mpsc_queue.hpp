@@ -0,0 +1,113 @@
+/** @file
+xtd::concurrent::mpsc_queue system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+#pragma once
+
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <xtd/concurrent/mpsc_queue.hpp>
+
+TEST(test_mpsc_queue, initialization){
+  xtd::concurrent::mpsc_queue<int> oQueue;
+  ASSERT_TRUE(oQueue.empty());
+  int x;
+  ASSERT_FALSE(oQueue.try_pop(x));
+}
+
+TEST(test_mpsc_queue, fifo){
+  xtd::concurrent::mpsc_queue<std::string> oQueue;
+  for (int i = 0; i < 1000; i++){
+    oQueue.push(std::to_string(i));
+  }
+  ASSERT_FALSE(oQueue.empty());
+  std::string sValue;
+  for (int i = 0; i < 500; i++){
+    ASSERT_TRUE(oQueue.try_pop(sValue));
+    ASSERT_EQ(std::to_string(i), sValue);
+  }
+  for (int i = 500; i < 1000; i++){
+    ASSERT_EQ(std::to_string(i), oQueue.pop());
+  }
+  ASSERT_FALSE(oQueue.try_pop(sValue));
+  ASSERT_TRUE(oQueue.empty());
+}
+
+TEST(test_mpsc_queue, recycles_nodes){
+  xtd::concurrent::mpsc_queue<int> oQueue;
+  int x = 0;
+  for (int iPass = 0; iPass < 100; ++iPass){
+    for (int i = 0; i < 500; i++){
+      oQueue.push(i);
+    }
+    while (oQueue.try_pop(x)){}
+  }
+  // 500 nodes, the stub and the nodes parked in the thread cache fit the first four chunks
+  ASSERT_GE(64 + 128 + 256 + 512, oQueue.capacity());
+}
+
+TEST(test_mpsc_queue, move_only){
+  xtd::concurrent::mpsc_queue<std::unique_ptr<int>> oQueue;
+  oQueue.push(std::unique_ptr<int>(new int(5)));
+  oQueue.emplace(new int(6));
+  ASSERT_EQ(5, *oQueue.pop());
+  std::unique_ptr<int> pValue;
+  ASSERT_TRUE(oQueue.try_pop(pValue));
+  ASSERT_EQ(6, *pValue);
+  // items left in the queue are destroyed with it
+  oQueue.emplace(new int(7));
+}
+
+TEST(test_mpsc_queue, pop_all){
+  xtd::concurrent::mpsc_queue<int> oQueue;
+  for (int i = 0; i < 100; i++){
+    oQueue.push(i);
+  }
+  std::vector<int> oOut;
+  ASSERT_EQ(100, oQueue.pop_all(std::back_inserter(oOut)));
+  ASSERT_EQ(0, oQueue.pop_all(std::back_inserter(oOut)));
+  for (int i = 0; i < 100; i++){
+    ASSERT_EQ(i, oOut[i]);
+  }
+}
+
+TEST(test_mpsc_queue, concurrent_producers){
+  static const int iThreads = 4;
+  static const int iItems = 50000;
+  xtd::concurrent::mpsc_queue<int, xtd::concurrent::yield_wait_policy> oQueue;
+  std::vector<std::future<void>> oProducers;
+  for (int t = 0; t < iThreads; ++t){
+    oProducers.push_back(std::async(std::launch::async, [&, t](){
+      for (int i = 0; i < iItems; ++i){
+        oQueue.push(t * iItems + i);
+      }
+    }));
+  }
+  long long iSum = 0;
+  int iLast[iThreads] = { -1, -1, -1, -1 };
+  std::vector<int> oBatch;
+  for (int iPopped = 0; iPopped < iThreads * iItems;){
+    oBatch.clear();
+    if (!oQueue.pop_all(std::back_inserter(oBatch))){
+      oBatch.push_back(oQueue.pop());
+    }
+    for (auto iValue : oBatch){
+      // items of a single producer are popped in the order they were pushed
+      auto & iPrevious = iLast[iValue / iItems];
+      ASSERT_LT(iPrevious, iValue);
+      iPrevious = iValue;
+      iSum += iValue;
+    }
+    iPopped += static_cast<int>(oBatch.size());
+  }
+  for (auto & oProducer : oProducers){
+    oProducer.get();
+  }
+  long long iTotal = static_cast<long long>(iThreads) * iItems;
+  ASSERT_EQ(iTotal * (iTotal - 1) / 2, iSum);
+  ASSERT_TRUE(oQueue.empty());
+}
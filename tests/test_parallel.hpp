@@ -0,0 +1,137 @@
+/** @file
+xtd::parallel system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+
+#pragma once
+
+#include <xtd/parallel.hpp>
+#include <xtd/btree.hpp>
+#include <xtd/mapped_vector.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+  inline xtd::filesystem::path parallel_temp_path() {
+    static int32_t n = 0;
+    return xtd::filesystem::temp_directory_path() /= xtd::string::format("parallel_test_", ++n).c_str();
+  }
+}
+
+TEST(test_parallel, for_each){
+  xtd::concurrent::thread_pool oPool(4);
+  std::vector<int> oItems(100000, 1);
+  xtd::parallel::for_each(oItems.begin(), oItems.end(), [](int& i){ i *= 2; }, 0, oPool);
+  EXPECT_EQ(std::vector<int>(100000, 2), oItems);
+
+  std::atomic<size_t> iCalls(0);
+  xtd::parallel::for_each(oItems.begin(), oItems.end(), [&](int){ ++iCalls; }, 7, oPool);
+  EXPECT_EQ(oItems.size(), iCalls.load());
+
+  EXPECT_THROW(xtd::parallel::for_each(oItems.begin(), oItems.end(), [](int){ throw std::runtime_error("thrown"); }, 100, oPool), std::runtime_error);
+}
+
+TEST(test_parallel, transform_reduce){
+  xtd::concurrent::thread_pool oPool(4);
+  std::vector<uint64_t> oItems(100000);
+  std::iota(oItems.begin(), oItems.end(), 1);
+  auto iSum = xtd::parallel::transform_reduce(oItems.begin(), oItems.end(), uint64_t(0), std::plus<uint64_t>(), [](uint64_t i){ return i * i; }, 0, oPool);
+  EXPECT_EQ(std::accumulate(oItems.begin(), oItems.end(), uint64_t(0), [](uint64_t a, uint64_t i){ return a + i * i; }), iSum);
+  EXPECT_EQ(42U, xtd::parallel::transform_reduce(oItems.begin(), oItems.begin(), uint64_t(42), std::plus<uint64_t>(), [](uint64_t i){ return i; }, 0, oPool));
+
+  // combined in range order so associative but not commutative reductions work
+  std::vector<std::string> oWords{ "a", "b", "c", "d", "e", "f", "g", "h", "i", "j" };
+  auto sJoined = xtd::parallel::transform_reduce(oWords.begin(), oWords.end(), std::string(">"), std::plus<std::string>(), [](const std::string& s){ return s; }, 1, oPool);
+  EXPECT_EQ(">abcdefghij", sJoined);
+}
+
+TEST(test_parallel, sort){
+  xtd::concurrent::thread_pool oPool(4);
+  std::mt19937 oRandom(7);
+  std::vector<uint32_t> oItems(200000);
+  for (auto & i : oItems){
+    i = oRandom();
+  }
+  auto oExpected = oItems;
+  std::sort(oExpected.begin(), oExpected.end());
+  xtd::parallel::sort(oItems.begin(), oItems.end(), std::less<uint32_t>(), 0, oPool);
+  EXPECT_EQ(oExpected, oItems);
+
+  // many duplicates and a descending order
+  for (auto & i : oItems){
+    i = oRandom() % 4;
+  }
+  oExpected = oItems;
+  std::sort(oExpected.begin(), oExpected.end(), std::greater<uint32_t>());
+  xtd::parallel::sort(oItems.begin(), oItems.end(), std::greater<uint32_t>(), 100, oPool);
+  EXPECT_EQ(oExpected, oItems);
+}
+
+TEST(test_parallel, mapped_vector){
+  auto oPath = parallel_temp_path();
+  {
+    xtd::concurrent::thread_pool oPool(4);
+    xtd::mapped_vector<uint64_t> oItems(oPath);
+    std::mt19937 oRandom(11);
+    for (size_t i = 0; i < 2000; ++i){
+      oItems.push_back(oRandom() % 1000);
+    }
+    std::vector<uint64_t> oExpected;
+    for (auto oItem = oItems.begin(); oItem != oItems.end(); ++oItem){
+      oExpected.push_back(*oItem);
+    }
+    EXPECT_EQ(oExpected.size(), static_cast<size_t>(oItems.end() - oItems.begin()));
+
+    xtd::parallel::for_each(oItems.begin(), oItems.end(), [](uint64_t& i){ ++i; }, 64, oPool);
+    auto iSum = xtd::parallel::transform_reduce(oItems.begin(), oItems.end(), uint64_t(0), std::plus<uint64_t>(), [](uint64_t i){ return i; }, 64, oPool);
+    EXPECT_EQ(std::accumulate(oExpected.begin(), oExpected.end(), uint64_t(0)) + oExpected.size(), iSum);
+
+    xtd::parallel::sort(oItems.begin(), oItems.end(), std::less<uint64_t>(), 64, oPool);
+    std::sort(oExpected.begin(), oExpected.end());
+    auto oItem = oItems.begin();
+    for (size_t i = 0; i < oExpected.size(); ++i, ++oItem){
+      ASSERT_EQ(1 + oExpected[i], *oItem);
+    }
+  }
+  xtd::filesystem::remove(oPath);
+}
+
+TEST(test_parallel, btree){
+  auto oPath = parallel_temp_path();
+  xtd::filesystem::remove(oPath);
+  {
+    xtd::concurrent::thread_pool oPool(4);
+    xtd::btree<uint32_t, uint64_t, 8> oTree(oPath);
+    for (uint32_t i = 0; i < 5000; ++i){
+      oTree.insert(i, 3 * i);
+    }
+    std::atomic<uint64_t> iSum(0);
+    std::atomic<size_t> iCount(0);
+    xtd::parallel::for_each(oTree, [&](uint32_t iKey, uint64_t iValue){
+      EXPECT_EQ(3U * iKey, iValue);
+      iSum += iValue;
+      ++iCount;
+    }, 100, oPool);
+    EXPECT_EQ(5000U, iCount.load());
+    EXPECT_EQ(3U * 4999 * 5000 / 2, iSum.load());
+
+    auto iTotal = xtd::parallel::transform_reduce(oTree, uint64_t(0), std::plus<uint64_t>(), [](uint32_t, uint64_t iValue){ return iValue; }, 0, oPool);
+    EXPECT_EQ(iSum.load(), iTotal);
+
+    // records are combined in key order
+    auto oKeys = xtd::parallel::transform_reduce(oTree, std::vector<uint32_t>(), [](std::vector<uint32_t> a, std::vector<uint32_t> b){
+      a.insert(a.end(), b.begin(), b.end());
+      return a;
+    }, [](uint32_t iKey, uint64_t){ return std::vector<uint32_t>(1, iKey); }, 50, oPool);
+    ASSERT_EQ(5000U, oKeys.size());
+    EXPECT_TRUE(std::is_sorted(oKeys.begin(), oKeys.end()));
+  }
+  xtd::filesystem::remove(oPath);
+}
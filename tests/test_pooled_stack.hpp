@@ -0,0 +1,160 @@
+/** @file
+xtd::concurrent::pooled_stack system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+#pragma once
+
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <xtd/concurrent/pooled_stack.hpp>
+
+TEST(test_pooled_stack, initialization){
+  xtd::concurrent::pooled_stack<int> oStack;
+  ASSERT_TRUE(oStack.empty());
+  ASSERT_EQ(0, oStack.capacity());
+}
+
+TEST(test_pooled_stack, push_pop){
+  xtd::concurrent::pooled_stack<std::string> oStack;
+  for (int i = 0; i < 1000; i++){
+    oStack.push(std::to_string(i));
+  }
+  ASSERT_FALSE(oStack.empty());
+  std::string sValue;
+  for (int i = 999; i >= 0; i--){
+    ASSERT_TRUE(oStack.try_pop(sValue));
+    ASSERT_EQ(std::to_string(i), sValue);
+  }
+  ASSERT_FALSE(oStack.try_pop(sValue));
+  ASSERT_TRUE(oStack.empty());
+}
+
+TEST(test_pooled_stack, recycles_nodes){
+  xtd::concurrent::pooled_stack<int> oStack;
+  int x = 0;
+  for (int iPass = 0; iPass < 100; ++iPass){
+    for (int i = 0; i < 500; i++){
+      oStack.push(i);
+    }
+    while (oStack.try_pop(x)){}
+  }
+  // 500 nodes plus the nodes parked in the thread cache fit the first four chunks
+  ASSERT_GE(64 + 128 + 256 + 512, oStack.capacity());
+}
+
+TEST(test_pooled_stack, move_only){
+  xtd::concurrent::pooled_stack<std::unique_ptr<int>> oStack;
+  oStack.push(std::unique_ptr<int>(new int(5)));
+  oStack.emplace(new int(6));
+  std::unique_ptr<int> pValue;
+  ASSERT_TRUE(oStack.try_pop(pValue));
+  ASSERT_EQ(6, *pValue);
+  ASSERT_EQ(5, *oStack.pop());
+}
+
+TEST(test_pooled_stack, push_range_pop_all){
+  xtd::concurrent::pooled_stack<int> oStack;
+  std::vector<int> oValues{ 1, 2, 3, 4, 5 };
+  oStack.push(0);
+  oStack.push_range(oValues.begin(), oValues.end());
+  oStack.push_range(oValues.end(), oValues.end());
+  ASSERT_EQ(5, oStack.pop());
+  std::vector<int> oAll;
+  ASSERT_EQ(5, oStack.pop_all(std::back_inserter(oAll)));
+  ASSERT_EQ(std::vector<int>({ 4, 3, 2, 1, 0 }), oAll);
+  ASSERT_TRUE(oStack.empty());
+  ASSERT_EQ(0, oStack.pop_all(std::back_inserter(oAll)));
+}
+
+TEST(test_pooled_stack, destroys_values){
+  auto pShared = std::make_shared<int>(1);
+  {
+    xtd::concurrent::pooled_stack<std::shared_ptr<int>> oStack;
+    for (int i = 0; i < 100; i++){
+      oStack.push(pShared);
+    }
+    std::shared_ptr<int> pValue;
+    ASSERT_TRUE(oStack.try_pop(pValue));
+    pValue.reset();
+    ASSERT_EQ(100, pShared.use_count());
+  }
+  ASSERT_EQ(1, pShared.use_count());
+}
+
+TEST(test_pooled_stack, thread_exit_returns_nodes){
+  xtd::concurrent::pooled_stack<int> oStack;
+  // each thread leaves nodes in its cache when it exits
+  for (int iThread = 0; iThread < 50; ++iThread){
+    std::thread([&](){
+      int x;
+      for (int i = 0; i < 40; i++){
+        oStack.push(i);
+      }
+      while (oStack.try_pop(x)){}
+    }).join();
+  }
+  ASSERT_GE(64 + 128, oStack.capacity());
+}
+
+TEST(test_pooled_stack, outlives_threads){
+  std::promise<void> oStart;
+  std::promise<void> oDestroyed;
+  auto oFuture = oStart.get_future().share();
+  std::thread oThread;
+  {
+    auto pStack = std::make_shared<xtd::concurrent::pooled_stack<int>>();
+    oThread = std::thread([pStack, oFuture, &oDestroyed]() mutable{
+      pStack->push(1);
+      pStack->pop();
+      pStack.reset();
+      oFuture.wait();
+      oDestroyed.set_value();
+    });
+  }
+  // the thread exits after the stack is destroyed and must not touch it
+  oStart.set_value();
+  oDestroyed.get_future().wait();
+  oThread.join();
+}
+
+TEST(test_pooled_stack, concurrent_churn){
+  xtd::concurrent::pooled_stack<std::string> oStack;
+  std::atomic<int> iPopped(0);
+  auto churnfn = [&]() -> bool{
+    std::string sValue;
+    std::vector<std::string> oBatch(3, "Hello!");
+    std::vector<std::string> oAll;
+    for (int i = 0; i < 20000; i++){
+      oStack.push("Hello!");
+      if (oStack.try_pop(sValue)){
+        if ("Hello!" != sValue) return false;
+        ++iPopped;
+      }
+      if (0 == i % 100){
+        oStack.push_range(oBatch.begin(), oBatch.end());
+        oAll.clear();
+        iPopped += static_cast<int>(oStack.pop_all(std::back_inserter(oAll)));
+        for (auto & sItem : oAll){
+          if ("Hello!" != sItem) return false;
+        }
+      }
+    }
+    return true;
+  };
+  std::vector<std::future<bool>> oThreads;
+  for (int i = 0; i < 8; ++i){
+    oThreads.push_back(std::async(std::launch::async, churnfn));
+  }
+  for (auto & oThread : oThreads){
+    EXPECT_TRUE(oThread.get());
+  }
+  std::string sValue;
+  while (oStack.try_pop(sValue)){
+    ++iPopped;
+  }
+  ASSERT_EQ(8 * (20000 + 200 * 3), iPopped);
+}
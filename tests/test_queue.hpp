@@ -0,0 +1,124 @@
+/** @file
+xtd::concurrent::queue system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+#pragma once
+
+#include <algorithm>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <xtd/concurrent/queue.hpp>
+
+TEST(test_queue, initialization){
+  xtd::concurrent::queue<int> oQueue(100);
+  ASSERT_TRUE(oQueue.empty());
+  ASSERT_EQ(128, oQueue.capacity());
+  int x;
+  ASSERT_FALSE(oQueue.try_pop(x));
+}
+
+TEST(test_queue, fifo){
+  xtd::concurrent::queue<std::string> oQueue(16);
+  for (int i = 0; i < 16; i++){
+    ASSERT_TRUE(oQueue.try_push(std::to_string(i)));
+  }
+  ASSERT_FALSE(oQueue.try_push("full"));
+  ASSERT_EQ(16, oQueue.size());
+  std::string sValue;
+  for (int i = 0; i < 16; i++){
+    ASSERT_TRUE(oQueue.try_pop(sValue));
+    ASSERT_EQ(std::to_string(i), sValue);
+  }
+  ASSERT_FALSE(oQueue.try_pop(sValue));
+  // wrap around the ring
+  for (int iLap = 0; iLap < 10; ++iLap){
+    for (int i = 0; i < 10; i++){
+      ASSERT_TRUE(oQueue.try_push(std::to_string(i)));
+    }
+    for (int i = 0; i < 10; i++){
+      ASSERT_EQ(std::to_string(i), oQueue.pop());
+    }
+  }
+  ASSERT_TRUE(oQueue.empty());
+}
+
+TEST(test_queue, move_only){
+  xtd::concurrent::queue<std::unique_ptr<int>> oQueue(4);
+  oQueue.push(std::unique_ptr<int>(new int(5)));
+  ASSERT_TRUE(oQueue.try_emplace(new int(6)));
+  ASSERT_EQ(5, *oQueue.pop());
+  std::unique_ptr<int> pValue;
+  ASSERT_TRUE(oQueue.try_pop(pValue));
+  ASSERT_EQ(6, *pValue);
+  // items left in the queue are destroyed with it
+  oQueue.emplace(new int(7));
+}
+
+TEST(test_queue, push_n_pop_n){
+  xtd::concurrent::queue<std::string> oQueue(8);
+  std::vector<std::string> oItems;
+  for (int i = 0; i < 12; i++){
+    oItems.push_back(std::to_string(i));
+  }
+  ASSERT_EQ(8, oQueue.push_n(oItems.begin(), oItems.size()));
+  ASSERT_EQ(0, oQueue.push_n(oItems.begin() + 8, 4));
+  std::vector<std::string> oOut;
+  ASSERT_EQ(5, oQueue.pop_n(std::back_inserter(oOut), 5));
+  ASSERT_EQ(4, oQueue.push_n(oItems.begin() + 8, 4));
+  ASSERT_EQ(7, oQueue.pop_n(std::back_inserter(oOut), 100));
+  ASSERT_EQ(0, oQueue.pop_n(std::back_inserter(oOut), 100));
+  ASSERT_EQ(12, oOut.size());
+  for (int i = 0; i < 12; i++){
+    ASSERT_EQ(std::to_string(i), oOut[i]);
+  }
+}
+
+TEST(test_queue, concurrent_producers_consumers){
+  static const int iThreads = 4;
+  static const int iItems = 50000;
+  xtd::concurrent::queue<int, xtd::concurrent::yield_wait_policy> oQueue(64);
+  std::vector<std::future<long long>> oConsumers;
+  std::vector<std::future<void>> oProducers;
+  for (int t = 0; t < iThreads; ++t){
+    oProducers.push_back(std::async(std::launch::async, [&, t](){
+      for (int i = 0; i < iItems; ++i){
+        if (i % 2){
+          oQueue.push(t * iItems + i);
+        } else{
+          int iBatch[1] = { t * iItems + i };
+          while (!oQueue.push_n(iBatch, 1)){
+            std::this_thread::yield();
+          }
+        }
+      }
+    }));
+    oConsumers.push_back(std::async(std::launch::async, [&, t](){
+      long long iSum = 0;
+      int iLast[iThreads];
+      std::fill(iLast, iLast + iThreads, -1);
+      for (int i = 0; i < iItems; ++i){
+        auto iValue = oQueue.pop();
+        // items of a single producer are popped in the order they were pushed
+        auto & iPrevious = iLast[iValue / iItems];
+        EXPECT_LT(iPrevious, iValue);
+        iPrevious = iValue;
+        iSum += iValue;
+      }
+      return iSum;
+    }));
+  }
+  for (auto & oProducer : oProducers){
+    oProducer.get();
+  }
+  long long iSum = 0;
+  for (auto & oConsumer : oConsumers){
+    iSum += oConsumer.get();
+  }
+  long long iTotal = static_cast<long long>(iThreads) * iItems;
+  ASSERT_EQ(iTotal * (iTotal - 1) / 2, iSum);
+  ASSERT_TRUE(oQueue.empty());
+}
@@ -0,0 +1,148 @@
+/** @file
+xtd::concurrent::radix_map system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+#pragma once
+
+#include <future>
+#include <random>
+#include <vector>
+
+#include <xtd/concurrent/radix_map.hpp>
+
+using radix_map_type = xtd::concurrent::radix_map<uint64_t, std::string>;
+
+TEST(test_radix_map, initialization) {
+  radix_map_type oMap;
+}
+
+TEST(test_radix_map, insert){
+  radix_map_type oMap;
+  ASSERT_TRUE(oMap.insert(1, "Hello!"));
+  ASSERT_TRUE(oMap.insert(2, "Hello!"));
+  ASSERT_TRUE(oMap.insert(3, "Hello!"));
+  ASSERT_FALSE(oMap.insert(1, "Hello!"));
+  ASSERT_FALSE(oMap.insert(2, "Hello!"));
+  ASSERT_FALSE(oMap.insert(3, "Hello!"));
+}
+
+TEST(test_radix_map, remove) {
+  radix_map_type oMap;
+  ASSERT_TRUE(oMap.insert(1, "Hello!"));
+  ASSERT_TRUE(oMap.insert(4, "Hello!"));
+  ASSERT_TRUE(oMap.insert(7, "Hello!"));
+  ASSERT_TRUE(oMap.remove(1));
+  ASSERT_TRUE(oMap.remove(4));
+  ASSERT_FALSE(oMap.remove(4));
+  ASSERT_FALSE(oMap.remove(8));
+  ASSERT_TRUE(oMap.exists(7));
+  ASSERT_TRUE(oMap.insert(4, "Hello!"));
+  ASSERT_TRUE(oMap.exists(4));
+}
+
+TEST(test_radix_map, exists) {
+  radix_map_type oMap;
+  oMap.insert(0x1234, "0x1234");
+  oMap.insert(0x4321, "0x4321");
+  oMap.insert(0x1234567800000000ULL, "high");
+  oMap.insert(0x1234567900000000ULL, "prefix split");
+  ASSERT_TRUE(oMap.exists(0x1234));
+  ASSERT_FALSE(oMap.exists(0x7890));
+  ASSERT_TRUE(oMap.exists(0x4321));
+  ASSERT_TRUE(oMap.exists(0x1234567800000000ULL));
+  ASSERT_TRUE(oMap.exists(0x1234567900000000ULL));
+  ASSERT_FALSE(oMap.exists(0x1234567A00000000ULL));
+  ASSERT_EQ(std::string("prefix split"), oMap[0x1234567900000000ULL]);
+}
+
+TEST(test_radix_map, node_growth) {
+  xtd::concurrent::radix_map<uint32_t, uint32_t> oMap;
+  // dense keys fill the low byte of each leaf level so inner nodes pass through all four sizes
+  for (uint32_t i = 0; i < 0x10000; i += 3){
+    ASSERT_TRUE(oMap.insert(i, uint32_t(i)));
+  }
+  for (uint32_t i = 0; i < 0x10000; ++i){
+    ASSERT_EQ(0 == i % 3, oMap.exists(i));
+  }
+  for (uint32_t i = 0; i < 0x10000; i += 3){
+    ASSERT_EQ(i, oMap[i]);
+  }
+}
+
+TEST(test_radix_map, random_keys) {
+  radix_map_type oMap;
+  std::mt19937_64 oRandom(42);
+  std::vector<uint64_t> oKeys;
+  for (int i = 0; i < 10000; ++i){
+    oKeys.push_back(oRandom());
+    ASSERT_TRUE(oMap.insert(oKeys.back(), std::to_string(oKeys.back())));
+  }
+  for (auto Key : oKeys){
+    ASSERT_EQ(std::to_string(Key), oMap[Key]);
+  }
+  for (size_t i = 0; i < oKeys.size(); i += 2){
+    ASSERT_TRUE(oMap.remove(oKeys[i]));
+  }
+  for (size_t i = 0; i < oKeys.size(); ++i){
+    ASSERT_EQ(1 == i % 2, oMap.exists(oKeys[i]));
+  }
+}
+
+TEST(test_radix_map, concurrent_insert_remove) {
+  xtd::concurrent::radix_map<uint64_t, uint64_t> oMap;
+  auto insertfn = [&](uint64_t iStart) -> bool{
+    for (uint64_t i = iStart; i < 40000; i += 4){
+      if (!oMap.insert(i * 0x9E3779B97F4A7C15ULL, uint64_t(i))) return false;
+    }
+    return true;
+  };
+  auto t1 = std::async(std::launch::async, insertfn, 0);
+  auto t2 = std::async(std::launch::async, insertfn, 1);
+  auto t3 = std::async(std::launch::async, insertfn, 2);
+  auto t4 = std::async(std::launch::async, insertfn, 3);
+  EXPECT_TRUE(t1.get() && t2.get() && t3.get() && t4.get());
+  for (uint64_t i = 0; i < 40000; ++i){
+    ASSERT_TRUE(oMap.exists(i * 0x9E3779B97F4A7C15ULL));
+  }
+  auto removefn = [&](uint64_t iStart) -> bool{
+    for (uint64_t i = iStart; i < 40000; i += 4){
+      if (!oMap.remove(i * 0x9E3779B97F4A7C15ULL)) return false;
+    }
+    return true;
+  };
+  auto t5 = std::async(std::launch::async, removefn, 0);
+  auto t6 = std::async(std::launch::async, removefn, 1);
+  auto t7 = std::async(std::launch::async, removefn, 2);
+  auto t8 = std::async(std::launch::async, removefn, 3);
+  EXPECT_TRUE(t5.get() && t6.get() && t7.get() && t8.get());
+  for (uint64_t i = 0; i < 40000; ++i){
+    ASSERT_FALSE(oMap.exists(i * 0x9E3779B97F4A7C15ULL));
+  }
+}
+
+TEST(test_radix_map, concurrent_churn) {
+  xtd::concurrent::radix_map<uint64_t, std::string> oMap;
+  auto churnfn = [&](uint64_t iStart) -> bool{
+    for (int iPass = 0; iPass < 10; ++iPass){
+      for (uint64_t i = iStart; i < 4096; i += 8){
+        oMap.insert(i * 0x9E3779B97F4A7C15ULL, "Hello!");
+        xtd::concurrent::epoch_domain::guard oGuard;
+        if (auto pValue = oMap.find((i ^ 1) * 0x9E3779B97F4A7C15ULL)){
+          if (std::string("Hello!") != *pValue) return false;
+        }
+        oMap.remove(i * 0x9E3779B97F4A7C15ULL);
+      }
+    }
+    return true;
+  };
+  std::vector<std::future<bool>> oThreads;
+  for (uint64_t i = 0; i < 8; ++i){
+    oThreads.push_back(std::async(std::launch::async, churnfn, i));
+  }
+  for (auto & oThread : oThreads){
+    EXPECT_TRUE(oThread.get());
+  }
+  for (uint64_t i = 0; i < 4096; ++i){
+    ASSERT_FALSE(oMap.exists(i * 0x9E3779B97F4A7C15ULL));
+  }
+}
@@ -3,6 +3,10 @@ xtd::concurrent::read_write_lock system and unit tests
 @copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
 */
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include <xtd/concurrent/rw_lock.hpp>
 
 TEST(test_rw_lock, initialization){
@@ -90,3 +94,32 @@ TEST(test_rw_lock, scope_write) {
   }
   ASSERT_TRUE(rw.try_lock_write());
 }
+
+TEST(test_rw_lock, adaptive_wait_policy){
+  xtd::concurrent::rw_lock_base<xtd::concurrent::adaptive_wait_policy> rw;
+  size_t iValue = 0;
+  std::atomic<bool> bTorn(false);
+  std::vector<std::thread> oThreads;
+  for (int t = 0; t < 8; ++t){
+    oThreads.emplace_back([&, t](){
+      for (int i = 0; i < 5000; ++i){
+        if (t % 2){
+          decltype(rw)::scope_write oLock(rw);
+          // a reader observing the odd value would have overlapped a writer
+          ++iValue;
+          ++iValue;
+        } else{
+          decltype(rw)::scope_read oLock(rw);
+          if (iValue % 2) bTorn = true;
+        }
+      }
+    });
+  }
+  for (auto & oThread : oThreads){
+    oThread.join();
+  }
+  ASSERT_FALSE(bTorn);
+  ASSERT_EQ(4 * 5000 * 2, iValue);
+  ASSERT_EQ(0, rw.readers());
+  ASSERT_TRUE(rw.try_lock_write());
+}
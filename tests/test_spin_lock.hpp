@@ -3,6 +3,10 @@ xtd::concurrent::spin_lock system and unit tests
 @copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
 */
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include <xtd/concurrent/spin_lock.hpp>
 
 TEST(test_spin_lock, initialization){
@@ -27,3 +31,40 @@ TEST(test_spin_lock, try_lock){
   oLock.unlock();
   EXPECT_TRUE(oLock.try_lock());
 }
+
+TEST(test_spin_lock, adaptive_wait_policy){
+  xtd::concurrent::spin_lock_base<xtd::concurrent::adaptive_wait_policy> oLock;
+  size_t iCount = 0;
+  std::vector<std::thread> oThreads;
+  // more threads than cores so waiters park while the holder is descheduled
+  for (int t = 0; t < 8; ++t){
+    oThreads.emplace_back([&](){
+      for (int i = 0; i < 20000; ++i){
+        decltype(oLock)::scope_locker oLocker(oLock);
+        ++iCount;
+      }
+    });
+  }
+  for (auto & oThread : oThreads){
+    oThread.join();
+  }
+  ASSERT_EQ(8 * 20000, iCount);
+  ASSERT_TRUE(oLock.try_lock());
+}
+
+TEST(test_spin_lock, adaptive_wait_policy_parks){
+  xtd::concurrent::adaptive_wait_policy oPolicy;
+  std::atomic<uint32_t> iWord(1);
+  std::thread oWaiter([&](){
+    while (1 == iWord.load()){
+      oPolicy.wait(iWord, 1);
+    }
+  });
+  while (!oPolicy.parked()){
+    std::this_thread::yield();
+  }
+  iWord.store(0);
+  oPolicy.notify(iWord, false);
+  oWaiter.join();
+  ASSERT_EQ(0, oPolicy.parked());
+}
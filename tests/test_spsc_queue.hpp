@@ -0,0 +1,99 @@
+/** @file
+xtd::concurrent::spsc_queue system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+#pragma once
+
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <xtd/concurrent/spsc_queue.hpp>
+
+TEST(test_spsc_queue, initialization){
+  xtd::concurrent::spsc_queue<int, 8> oQueue;
+  ASSERT_TRUE(oQueue.empty());
+  ASSERT_EQ(8, oQueue.capacity);
+  int x;
+  ASSERT_FALSE(oQueue.try_pop(x));
+}
+
+TEST(test_spsc_queue, fifo){
+  xtd::concurrent::spsc_queue<std::string, 16> oQueue;
+  for (int iLap = 0; iLap < 10; ++iLap){
+    for (int i = 0; i < 16; i++){
+      ASSERT_TRUE(oQueue.try_push(std::to_string(i)));
+    }
+    ASSERT_FALSE(oQueue.try_push("full"));
+    ASSERT_EQ(16, oQueue.size());
+    std::string sValue;
+    for (int i = 0; i < 8; i++){
+      ASSERT_TRUE(oQueue.try_pop(sValue));
+      ASSERT_EQ(std::to_string(i), sValue);
+    }
+    for (int i = 8; i < 16; i++){
+      ASSERT_EQ(std::to_string(i), oQueue.pop());
+    }
+    ASSERT_FALSE(oQueue.try_pop(sValue));
+  }
+}
+
+TEST(test_spsc_queue, commit_batch){
+  xtd::concurrent::spsc_queue<std::unique_ptr<int>, 8> oQueue;
+  for (int i = 0; i < 8; i++){
+    ASSERT_TRUE(oQueue.try_stage(new int(i)));
+  }
+  ASSERT_FALSE(oQueue.try_stage(std::unique_ptr<int>(new int(8))));
+  // staged items are not visible until they are committed
+  ASSERT_TRUE(oQueue.empty());
+  std::unique_ptr<int> pValue;
+  ASSERT_FALSE(oQueue.try_pop(pValue));
+  ASSERT_EQ(8, oQueue.commit_batch());
+  ASSERT_EQ(0, oQueue.commit_batch());
+  ASSERT_EQ(8, oQueue.size());
+
+  int iExpected = 0;
+  ASSERT_EQ(5, oQueue.consume([&](std::unique_ptr<int>& pItem){ EXPECT_EQ(iExpected++, *pItem); }, 5));
+  ASSERT_EQ(3, oQueue.consume([&](std::unique_ptr<int>& pItem){ EXPECT_EQ(iExpected++, *pItem); }));
+  ASSERT_EQ(0, oQueue.consume([&](std::unique_ptr<int>&){}));
+  // uncommitted items are destroyed with the queue
+  ASSERT_TRUE(oQueue.try_stage(new int(9)));
+}
+
+TEST(test_spsc_queue, consume_throws){
+  xtd::concurrent::spsc_queue<int, 8> oQueue;
+  for (int i = 0; i < 4; i++){
+    oQueue.push(i);
+  }
+  ASSERT_THROW(oQueue.consume([](int& i){ if (2 == i) throw std::runtime_error("consume"); }), std::runtime_error);
+  ASSERT_EQ(2, oQueue.size());
+  ASSERT_EQ(2, oQueue.pop());
+}
+
+TEST(test_spsc_queue, producer_consumer){
+  static const int iItems = 200000;
+  xtd::concurrent::spsc_queue<int, 64, xtd::concurrent::yield_wait_policy> oQueue;
+  auto oProducer = std::async(std::launch::async, [&](){
+    for (int i = 0; i < iItems;){
+      // alternate single pushes with batches
+      if (i % 3){
+        oQueue.push(i++);
+        continue;
+      }
+      for (; i < iItems && oQueue.try_stage(i); ++i){}
+      oQueue.commit_batch();
+      std::this_thread::yield();
+    }
+  });
+  int iExpected = 0;
+  while (iExpected < iItems){
+    if (!oQueue.consume([&](int& iValue){ EXPECT_EQ(iExpected++, iValue); })){
+      ASSERT_EQ(iExpected++, oQueue.pop());
+    }
+  }
+  oProducer.get();
+  ASSERT_TRUE(oQueue.empty());
+}
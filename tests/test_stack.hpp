@@ -5,6 +5,8 @@ xtd::concurrent::stack system and unit tests
 #pragma once
 
 #include <future>
+#include <string>
+#include <vector>
 
 #include <xtd/concurrent/stack.hpp>
 
@@ -58,3 +60,105 @@ TEST(test_stack, concurrent_push_pop){
   auto t8 = std::async(std::launch::async, popfn);
   EXPECT_TRUE(t5.get() && t6.get() && t7.get() && t8.get());
 }
+
+TEST(test_stack, concurrent_churn){
+  xtd::concurrent::stack<std::string> oStack;
+  std::atomic<int> iPopped(0);
+  auto churnfn = [&]() -> bool{
+    std::string sValue;
+    for (int i = 0; i < 20000; i++){
+      oStack.push("Hello!");
+      // popped nodes are retired so a racing pop never reads freed memory
+      if (oStack.try_pop(sValue)){
+        if ("Hello!" != sValue) return false;
+        ++iPopped;
+      }
+    }
+    return true;
+  };
+  std::vector<std::future<bool>> oThreads;
+  for (int i = 0; i < 8; ++i){
+    oThreads.push_back(std::async(std::launch::async, churnfn));
+  }
+  for (auto & oThread : oThreads){
+    EXPECT_TRUE(oThread.get());
+  }
+  std::string sValue;
+  while (oStack.try_pop(sValue)){
+    ++iPopped;
+  }
+  ASSERT_EQ(8 * 20000, iPopped);
+}
+
+TEST(test_stack, stats){
+  xtd::concurrent::stack<int> oStack;
+  for (int i = 0; i < 100; i++){
+    oStack.push(i);
+  }
+  int x = 0;
+  ASSERT_TRUE(oStack.try_pop(x));
+  auto oStats = oStack.stats();
+  ASSERT_EQ(99, oStats.nodes);
+  ASSERT_LE(99 * sizeof(int), oStats.bytes);
+  ASSERT_EQ(0, oStats.push_retries);
+  ASSERT_EQ(0, oStats.pop_retries);
+}
+
+TEST(test_stack, concurrent_stats){
+  xtd::concurrent::stack<int> oStack;
+  std::vector<std::future<void>> oThreads;
+  for (int i = 0; i < 4; ++i){
+    oThreads.push_back(std::async(std::launch::async, [&](){
+      int x;
+      for (int i = 0; i < 20000; i++){
+        oStack.push(i);
+        oStack.try_pop(x);
+      }
+    }));
+  }
+  // reading while other threads push and pop is safe
+  for (int i = 0; i < 100; ++i){
+    ASSERT_GE(4, oStack.stats().nodes);
+  }
+  for (auto & oThread : oThreads){
+    oThread.get();
+  }
+}
+
+TEST(test_stack, elimination_array){
+  int x = 0;
+  xtd::concurrent::elimination_array<1, 16> oArray;
+  ASSERT_EQ(nullptr, oArray.take());
+  // nothing takes the offer so it is withdrawn
+  ASSERT_FALSE(oArray.offer(&x));
+  ASSERT_EQ(nullptr, oArray.take());
+}
+
+TEST(test_stack, concurrent_elimination){
+  xtd::concurrent::stack<std::string, xtd::concurrent::null_wait_policy, xtd::concurrent::elimination_array<>> oStack;
+  std::atomic<int> iPopped(0);
+  auto churnfn = [&]() -> bool{
+    std::string sValue;
+    for (int i = 0; i < 20000; i++){
+      oStack.push("Hello!");
+      if (oStack.try_pop(sValue)){
+        if ("Hello!" != sValue) return false;
+        ++iPopped;
+      }
+    }
+    return true;
+  };
+  std::vector<std::future<bool>> oThreads;
+  for (int i = 0; i < 8; ++i){
+    oThreads.push_back(std::async(std::launch::async, churnfn));
+  }
+  for (auto & oThread : oThreads){
+    EXPECT_TRUE(oThread.get());
+  }
+  std::string sValue;
+  while (oStack.try_pop(sValue)){
+    ++iPopped;
+  }
+  ASSERT_EQ(8 * 20000, iPopped);
+  ASSERT_GE(oStack.stats().push_retries, oStack.stats().eliminations);
+}
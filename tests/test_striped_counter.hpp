@@ -0,0 +1,47 @@
+/** @file
+xtd::concurrent::striped_counter system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+#pragma once
+
+#include <future>
+#include <vector>
+
+#include <xtd/concurrent/striped_counter.hpp>
+
+TEST(test_striped_counter, initialization){
+  xtd::concurrent::striped_counter<3> oCounter;
+  for (size_t i = 0; i < 3; ++i){
+    ASSERT_EQ(0, oCounter.get(i));
+  }
+}
+
+TEST(test_striped_counter, add_reset){
+  xtd::concurrent::striped_counter<2> oCounter;
+  oCounter.add(0);
+  oCounter.add(0, 10);
+  oCounter.add(1, 5);
+  ASSERT_EQ(11, oCounter.get(0));
+  ASSERT_EQ(5, oCounter.get(1));
+  oCounter.reset();
+  ASSERT_EQ(0, oCounter.get(0));
+  ASSERT_EQ(0, oCounter.get(1));
+}
+
+TEST(test_striped_counter, concurrent_add){
+  xtd::concurrent::striped_counter<2, 4> oCounter;
+  std::vector<std::future<void>> oThreads;
+  for (int i = 0; i < 8; ++i){
+    oThreads.push_back(std::async(std::launch::async, [&](){
+      for (int x = 0; x < 10000; ++x){
+        oCounter.add(0);
+        oCounter.add(1, 2);
+      }
+    }));
+  }
+  for (auto & oThread : oThreads){
+    oThread.get();
+  }
+  ASSERT_EQ(80000, oCounter.get(0));
+  ASSERT_EQ(160000, oCounter.get(1));
+}
@@ -0,0 +1,137 @@
+/** @file
+xtd::concurrent::thread_pool system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <xtd/concurrent/thread_pool.hpp>
+
+TEST(test_thread_pool, work_deque){
+  using namespace xtd::concurrent::_::thread_pool;
+  deque oDeque;
+  std::vector<std::unique_ptr<task>> oTasks;
+  for (int i = 0; i < 1000; ++i){
+    oTasks.emplace_back(make_task([](){}));
+    oDeque.push(oTasks.back().get());
+  }
+  EXPECT_EQ(1000U, oDeque.size());
+  // the owner takes the newest and thieves steal the oldest
+  EXPECT_EQ(oTasks.back().get(), oDeque.take());
+  EXPECT_EQ(oTasks.front().get(), oDeque.steal());
+  size_t iCount = 2;
+  while (oDeque.take()){
+    ++iCount;
+  }
+  EXPECT_EQ(1000U, iCount);
+  EXPECT_EQ(nullptr, oDeque.steal());
+}
+
+TEST(test_thread_pool, concurrent_steal){
+  using namespace xtd::concurrent::_::thread_pool;
+  deque oDeque;
+  std::vector<std::unique_ptr<task>> oTasks;
+  for (int i = 0; i < 20000; ++i){
+    oTasks.emplace_back(make_task([](){}));
+  }
+  std::atomic<size_t> iStolen(0);
+  std::atomic<bool> bDone(false);
+  std::vector<std::thread> oThieves;
+  for (int t = 0; t < 3; ++t){
+    oThieves.emplace_back([&](){
+      while (!bDone.load() || oDeque.size()){
+        if (oDeque.steal()){
+          ++iStolen;
+        }
+      }
+    });
+  }
+  size_t iTaken = 0;
+  for (size_t i = 0; i < oTasks.size(); ++i){
+    oDeque.push(oTasks[i].get());
+    if (0 == i % 3 && oDeque.take()){
+      ++iTaken;
+    }
+  }
+  while (oDeque.take()){
+    ++iTaken;
+  }
+  bDone = true;
+  for (auto & oThread : oThieves){
+    oThread.join();
+  }
+  EXPECT_EQ(oTasks.size(), iTaken + iStolen.load());
+}
+
+TEST(test_thread_pool, submit){
+  xtd::concurrent::thread_pool oPool(4);
+  EXPECT_EQ(4U, oPool.size());
+  EXPECT_EQ(oPool.size(), oPool.worker_index());
+  auto oSum = oPool.submit([](int a, int b){ return a + b; }, 2, 3);
+  EXPECT_EQ(5, oSum.get());
+  auto oIndex = oPool.submit([&oPool](){ return oPool.worker_index(); });
+  EXPECT_LT(oIndex.get(), oPool.size());
+  auto oThrows = oPool.submit([](){ throw std::runtime_error("thrown"); });
+  EXPECT_THROW(oThrows.get(), std::runtime_error);
+}
+
+TEST(test_thread_pool, destructor_runs_tasks){
+  std::atomic<int> iCount(0);
+  {
+    xtd::concurrent::thread_pool oPool(2);
+    for (int i = 0; i < 1000; ++i){
+      oPool.post([&iCount](){ ++iCount; });
+    }
+  }
+  EXPECT_EQ(1000, iCount.load());
+}
+
+TEST(test_thread_pool, task_group){
+  xtd::concurrent::thread_pool oPool(4);
+  std::atomic<int> iCount(0);
+  xtd::concurrent::task_group oGroup(oPool);
+  for (int i = 0; i < 1000; ++i){
+    oGroup.run([&iCount](){ ++iCount; });
+  }
+  oGroup.wait();
+  EXPECT_EQ(1000, iCount.load());
+
+  oGroup.run([](){ throw std::runtime_error("thrown"); });
+  EXPECT_THROW(oGroup.wait(), std::runtime_error);
+  EXPECT_NO_THROW(oGroup.wait());
+}
+
+namespace{
+  size_t thread_pool_fib(xtd::concurrent::thread_pool& oPool, size_t n){
+    if (n < 12){
+      return (n < 2 ? n : thread_pool_fib(oPool, n - 1) + thread_pool_fib(oPool, n - 2));
+    }
+    size_t a = 0;
+    xtd::concurrent::task_group oGroup(oPool);
+    oGroup.run([&](){ a = thread_pool_fib(oPool, n - 1); });
+    auto b = thread_pool_fib(oPool, n - 2);
+    oGroup.wait();
+    return a + b;
+  }
+}
+
+TEST(test_thread_pool, nested_groups){
+  // groups waited on inside tasks must not exhaust the workers
+  xtd::concurrent::thread_pool oPool(2);
+  EXPECT_EQ(6765U, oPool.submit([&oPool](){ return thread_pool_fib(oPool, 20); }).get());
+}
+
+TEST(test_thread_pool, pinned){
+  xtd::concurrent::thread_pool oPool(2, true);
+  EXPECT_EQ(42, oPool.submit([](){ return 42; }).get());
+}
+
+TEST(test_thread_pool, global){
+  auto & oPool = xtd::concurrent::thread_pool::global();
+  EXPECT_EQ(&oPool, &xtd::concurrent::thread_pool::global());
+  EXPECT_LE(1U, oPool.size());
+  EXPECT_EQ(7, oPool.submit([](){ return 7; }).get());
+}
@@ -0,0 +1,74 @@
+/** @file
+xtd::concurrent::ticket_lock system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+
+#include <thread>
+#include <vector>
+
+#include <xtd/concurrent/ticket_lock.hpp>
+
+TEST(test_ticket_lock, try_lock){
+  xtd::concurrent::ticket_lock oLock;
+  EXPECT_TRUE(oLock.try_lock());
+  EXPECT_FALSE(oLock.try_lock());
+  oLock.unlock();
+  EXPECT_TRUE(oLock.try_lock());
+  oLock.unlock();
+  {
+    xtd::concurrent::ticket_lock::scope_locker oLocker(oLock);
+    EXPECT_FALSE(oLock.try_lock());
+  }
+  EXPECT_TRUE(oLock.try_lock());
+}
+
+template <typename _LockT>
+void ticket_lock_contention(){
+  _LockT oLock;
+  size_t iCount = 0;
+  std::vector<std::thread> oThreads;
+  for (int t = 0; t < 8; ++t){
+    oThreads.emplace_back([&](){
+      for (int i = 0; i < 20000; ++i){
+        typename _LockT::scope_locker oLocker(oLock);
+        ++iCount;
+      }
+    });
+  }
+  for (auto & oThread : oThreads){
+    oThread.join();
+  }
+  ASSERT_EQ(8 * 20000, iCount);
+  ASSERT_TRUE(oLock.try_lock());
+}
+
+TEST(test_ticket_lock, contention){
+  ticket_lock_contention<xtd::concurrent::ticket_lock_base<xtd::concurrent::yield_wait_policy>>();
+}
+
+TEST(test_ticket_lock, adaptive_wait_policy){
+  ticket_lock_contention<xtd::concurrent::ticket_lock_base<xtd::concurrent::adaptive_wait_policy>>();
+}
+
+TEST(test_ticket_lock, arrival_order){
+  xtd::concurrent::ticket_lock_base<xtd::concurrent::yield_wait_policy> oLock;
+  std::vector<int> oOrder;
+  oLock.lock();
+  std::vector<std::thread> oThreads;
+  for (int t = 0; t < 4; ++t){
+    oThreads.emplace_back([&, t](){
+      oLock.lock();
+      oOrder.push_back(t);
+      oLock.unlock();
+    });
+    // queue each thread behind the last before starting the next
+    while (oLock.queued() < static_cast<uint32_t>(t + 2)){
+      std::this_thread::yield();
+    }
+  }
+  oLock.unlock();
+  for (auto & oThread : oThreads){
+    oThread.join();
+  }
+  ASSERT_EQ((std::vector<int>{ 0, 1, 2, 3 }), oOrder);
+}
@@ -0,0 +1,178 @@
+/** @file
+xtd::concurrent::timer_wheel system and unit tests
+@copyright David Mott (c) 2016. Distributed under the Boost Software License Version 1.0. See LICENSE.md or http://boost.org/LICENSE_1_0.txt for details.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <xtd/concurrent/timer_wheel.hpp>
+
+namespace{
+  using timer_clock = xtd::concurrent::timer_wheel::clock;
+}
+
+TEST(test_timer_wheel, schedule){
+  auto oStart = timer_clock::now();
+  xtd::concurrent::timer_wheel oWheel(std::chrono::milliseconds(1), nullptr, oStart);
+  int iFired = 0;
+  auto iTimer = oWheel.schedule_at(oStart + std::chrono::milliseconds(5), [&](){ ++iFired; });
+  EXPECT_NE(xtd::concurrent::timer_wheel::invalid_timer, iTimer);
+  EXPECT_EQ(1U, oWheel.size());
+  EXPECT_EQ(0U, oWheel.advance(oStart + std::chrono::milliseconds(4)));
+  EXPECT_EQ(0, iFired);
+  EXPECT_EQ(1U, oWheel.advance(oStart + std::chrono::milliseconds(5)));
+  EXPECT_EQ(1, iFired);
+  EXPECT_EQ(0U, oWheel.size());
+  EXPECT_FALSE(oWheel.cancel(iTimer));
+
+  // partial ticks round up
+  oWheel.schedule_at(oStart + std::chrono::microseconds(7500), [&](){ ++iFired; });
+  EXPECT_EQ(0U, oWheel.advance(oStart + std::chrono::milliseconds(7)));
+  EXPECT_EQ(1U, oWheel.advance(oStart + std::chrono::milliseconds(8)));
+}
+
+TEST(test_timer_wheel, cancel_reschedule){
+  auto oStart = timer_clock::now();
+  xtd::concurrent::timer_wheel oWheel(std::chrono::milliseconds(1), nullptr, oStart);
+  int iFired = 0;
+  auto iFirst = oWheel.schedule_at(oStart + std::chrono::milliseconds(10), [&](){ iFired += 1; });
+  auto iSecond = oWheel.schedule_at(oStart + std::chrono::milliseconds(10), [&](){ iFired += 10; });
+  EXPECT_TRUE(oWheel.cancel(iFirst));
+  EXPECT_FALSE(oWheel.cancel(iFirst));
+  // the node is reused but the old id stays invalid
+  auto iThird = oWheel.schedule_at(oStart + std::chrono::milliseconds(10), [&](){ iFired += 100; });
+  EXPECT_NE(iFirst, iThird);
+  EXPECT_FALSE(oWheel.cancel(iFirst));
+  EXPECT_TRUE(oWheel.reschedule(iSecond, std::chrono::hours(1)));
+  EXPECT_EQ(1U, oWheel.advance(oStart + std::chrono::milliseconds(10)));
+  EXPECT_EQ(100, iFired);
+  EXPECT_EQ(1U, oWheel.size());
+  EXPECT_TRUE(oWheel.cancel(iSecond));
+  EXPECT_EQ(0U, oWheel.size());
+}
+
+TEST(test_timer_wheel, cascade){
+  auto oStart = timer_clock::now();
+  auto oTick = std::chrono::milliseconds(1);
+  xtd::concurrent::timer_wheel_base<3> oWheel(oTick, nullptr, oStart);
+  std::mt19937 oRandom(3);
+  std::vector<uint64_t> oExpiry(5000);
+  std::set<size_t> oFired;
+  for (size_t i = 0; i < oExpiry.size(); ++i){
+    oExpiry[i] = 1 + oRandom() % (1 << 20);
+    oWheel.schedule_at(oStart + oTick * oExpiry[i], [&oFired, i](){ oFired.insert(i); });
+  }
+  // each timer expires in the advance that passes its tick
+  uint64_t iPrevious = 0;
+  for (uint64_t iNow = 997; iPrevious < (1 << 20); iNow += 997){
+    oFired.clear();
+    oWheel.advance(oStart + oTick * iNow);
+    for (size_t i = 0; i < oExpiry.size(); ++i){
+      ASSERT_EQ(oExpiry[i] > iPrevious && oExpiry[i] <= iNow, oFired.count(i) > 0) << i << " " << oExpiry[i];
+    }
+    iPrevious = iNow;
+  }
+  EXPECT_EQ(0U, oWheel.size());
+}
+
+TEST(test_timer_wheel, beyond_range){
+  auto oStart = timer_clock::now();
+  auto oTick = std::chrono::milliseconds(1);
+  xtd::concurrent::timer_wheel_base<1> oWheel(oTick, nullptr, oStart);
+  int iFired = 0;
+  oWheel.schedule_at(oStart + oTick * 1000, [&](){ ++iFired; });
+  for (int i = 1; i < 1000; ++i){
+    oWheel.advance(oStart + oTick * i);
+  }
+  EXPECT_EQ(0, iFired);
+  oWheel.advance(oStart + oTick * 1000);
+  EXPECT_EQ(1, iFired);
+}
+
+TEST(test_timer_wheel, time_until_next){
+  auto oStart = timer_clock::now();
+  auto oTick = std::chrono::milliseconds(1);
+  xtd::concurrent::timer_wheel oWheel(oTick, nullptr, oStart);
+  EXPECT_EQ(timer_clock::duration::max(), oWheel.time_until_next(oStart));
+  auto iFar = oWheel.schedule_at(oStart + oTick * 1000, [](){});
+  // a lower bound: the level 1 slot is re-inserted at tick 768
+  EXPECT_EQ(timer_clock::duration(oTick * 768), oWheel.time_until_next(oStart));
+  oWheel.schedule_at(oStart + oTick * 10, [](){});
+  EXPECT_EQ(timer_clock::duration(oTick * 10), oWheel.time_until_next(oStart));
+  EXPECT_EQ(timer_clock::duration(oTick * 4), oWheel.time_until_next(oStart + oTick * 6));
+  EXPECT_EQ(timer_clock::duration::zero(), oWheel.time_until_next(oStart + oTick * 11));
+  oWheel.advance(oStart + oTick * 800);
+  EXPECT_EQ(timer_clock::duration(oTick * 200), oWheel.time_until_next(oStart + oTick * 800));
+  EXPECT_TRUE(oWheel.cancel(iFar));
+  EXPECT_EQ(timer_clock::duration::max(), oWheel.time_until_next(oStart));
+}
+
+TEST(test_timer_wheel, callbacks){
+  auto oStart = timer_clock::now();
+  auto oTick = std::chrono::milliseconds(1);
+  xtd::concurrent::timer_wheel oWheel(oTick, nullptr, oStart);
+  int iFired = 0;
+  // callbacks may schedule timers
+  oWheel.schedule_at(oStart + oTick, [&](){
+    ++iFired;
+    oWheel.schedule_at(oStart + oTick * 2, [&](){ ++iFired; });
+  });
+  oWheel.schedule_at(oStart + oTick, [](){ throw std::runtime_error("thrown"); });
+  EXPECT_THROW(oWheel.advance(oStart + oTick), std::runtime_error);
+  EXPECT_EQ(1, iFired);
+  EXPECT_EQ(1U, oWheel.advance(oStart + oTick * 2));
+  EXPECT_EQ(2, iFired);
+}
+
+TEST(test_timer_wheel, executor){
+  xtd::concurrent::thread_pool oPool(2);
+  auto oStart = timer_clock::now();
+  auto oTick = std::chrono::milliseconds(1);
+  xtd::concurrent::timer_wheel oWheel(oTick, &oPool, oStart);
+  std::promise<std::thread::id> oPromise;
+  oWheel.schedule_at(oStart + oTick, [&](){ oPromise.set_value(std::this_thread::get_id()); });
+  EXPECT_EQ(1U, oWheel.advance(oStart + oTick));
+  auto oFuture = oPromise.get_future();
+  ASSERT_EQ(std::future_status::ready, oFuture.wait_for(std::chrono::seconds(30)));
+  EXPECT_NE(std::this_thread::get_id(), oFuture.get());
+}
+
+TEST(test_timer_wheel, concurrent){
+  xtd::concurrent::timer_wheel oWheel(std::chrono::microseconds(100));
+  std::atomic<size_t> iFired(0);
+  std::atomic<size_t> iCancelled(0);
+  std::atomic<bool> bDone(false);
+  std::thread oDriver([&](){
+    while (!bDone.load()){
+      oWheel.advance();
+      std::this_thread::yield();
+    }
+  });
+  std::vector<std::thread> oThreads;
+  for (int t = 0; t < 4; ++t){
+    oThreads.emplace_back([&, t](){
+      for (int i = 0; i < 2000; ++i){
+        auto iTimer = oWheel.schedule(std::chrono::microseconds(100 * (i % 50)), [&](){ ++iFired; });
+        if (0 == (i + t) % 3 && oWheel.cancel(iTimer)){
+          ++iCancelled;
+        }
+      }
+    });
+  }
+  for (auto & oThread : oThreads){
+    oThread.join();
+  }
+  while (oWheel.size()){
+    std::this_thread::yield();
+  }
+  bDone = true;
+  oDriver.join();
+  EXPECT_EQ(8000U, iFired.load() + iCancelled.load());
+}
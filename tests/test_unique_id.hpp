@@ -29,3 +29,18 @@ TEST(test_unique_id, assign){
 TEST(test_unique_id, nullid){
   ASSERT_NO_THROW(xtd::unique_id::nullid());
 }
+
+TEST(test_unique_id, equality){
+  xtd::unique_id id1;
+  xtd::unique_id id2(id1);
+  xtd::unique_id id3;
+  ASSERT_TRUE(id1 == id2);
+  ASSERT_FALSE(id1 != id2);
+  ASSERT_TRUE(id1 != id3);
+}
+
+TEST(test_unique_id, hash){
+  xtd::unique_id id1;
+  xtd::unique_id id2(id1);
+  ASSERT_EQ(std::hash<xtd::unique_id>()(id1), std::hash<xtd::unique_id>()(id2));
+}
@@ -32,10 +32,42 @@ main system and unit test entry point
   #include "test_callback.hpp"
 #endif
 
+#if (ON==TEST_CONCURRENT_EPOCH_DOMAIN)
+  #include "test_epoch_domain.hpp"
+#endif
+
+#if (ON==TEST_CONCURRENT_FLAT_HASH_MAP)
+  #include "test_flat_hash_map.hpp"
+#endif
+
 #if (ON==TEST_CONCURRENT_HASH_MAP)
   #include "test_hash_map.hpp"
 #endif
 
+#if (ON==TEST_CONCURRENT_LRU_CACHE)
+  #include "test_concurrent_lru_cache.hpp"
+#endif
+
+#if (ON==TEST_CONCURRENT_MPSC_QUEUE)
+  #include "test_mpsc_queue.hpp"
+#endif
+
+#if (ON==TEST_CONCURRENT_POOLED_STACK)
+  #include "test_pooled_stack.hpp"
+#endif
+
+#if (ON==TEST_CONCURRENT_QUEUE)
+  #include "test_queue.hpp"
+#endif
+
+#if (ON==TEST_CONCURRENT_RADIX_MAP)
+  #include "test_radix_map.hpp"
+#endif
+
+#if (ON==TEST_CONCURRENT_SPSC_QUEUE)
+  #include "test_spsc_queue.hpp"
+#endif
+
 #if (ON==TEST_CONCURRENT_STACK)
   #include "test_concurrent_stack.hpp"
 #endif
@@ -44,6 +76,10 @@ main system and unit test entry point
   #include "test_debug_help.hpp"
 #endif
 
+#if (ON==TEST_DISTRIBUTED_RW_LOCK)
+  #include "test_distributed_rw_lock.hpp"
+#endif
+
 #if (ON==TEST_DYNAMIC_LIBRARY)
   #include "test_dynamic_library.hpp"
 #endif
@@ -60,6 +96,10 @@ main system and unit test entry point
   #include "test_executable.hpp"
 #endif
 
+#if (ON==TEST_LOCK_PROFILE)
+  #include "test_lock_profile.hpp"
+#endif
+
 #if (ON==TEST_LOGGING)
   #include "test_logging.hpp"
 #endif
@@ -80,6 +120,10 @@ main system and unit test entry point
   #include "test_mapped_vector.hpp"
 #endif
 
+#if (ON==TEST_PARALLEL)
+  #include "test_parallel.hpp"
+#endif
+
 #if (ON==TEST_PARSE)
   #include "test_parse.hpp"
 #endif
@@ -124,6 +168,10 @@ main system and unit test entry point
   #include "test_rfc7233.hpp"
 #endif
 
+#if (ON==TEST_MCS_LOCK)
+  #include "test_mcs_lock.hpp"
+#endif
+
 #if (ON==TEST_PATH)
   #include "test_path.hpp"
 #endif
@@ -164,10 +212,26 @@ main system and unit test entry point
   #include "test_stack.hpp"
 #endif
 
+#if (ON==TEST_STRIPED_COUNTER)
+  #include "test_striped_counter.hpp"
+#endif
+
 #if (ON==TEST_STRING)
   #include "test_string.hpp"
 #endif
 
+#if (ON==TEST_THREAD_POOL)
+  #include "test_thread_pool.hpp"
+#endif
+
+#if (ON==TEST_TICKET_LOCK)
+  #include "test_ticket_lock.hpp"
+#endif
+
+#if (ON==TEST_TIMER_WHEEL)
+  #include "test_timer_wheel.hpp"
+#endif
+
 #if (ON==TEST_UNIQUE_ID)
   #include "test_unique_id.hpp"
 #endif